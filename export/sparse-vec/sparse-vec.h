@@ -96,8 +96,12 @@ int GMRFLib_idxval_uniq(GMRFLib_idxval_tp * hold);
 double GMRFLib_ddot_idx_mkl(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
 double GMRFLib_ddot(int n, double *__restrict x, double *__restrict y);
 double GMRFLib_ddot_idx(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
+double GMRFLib_ddot_idx_generic(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
 double GMRFLib_dsum(int n, double *x);
 double GMRFLib_dsum_idx(int n, double *__restrict a, int *__restrict idx);
+double GMRFLib_dsum_idx_generic(int n, double *__restrict a, int *__restrict idx);
+int GMRFLib_dot_init(void);
+const char *GMRFLib_dot_kernel(void);
 
 double GMRFLib_dot_product_group(GMRFLib_idxval_tp * __restrict ELM_, double *__restrict ARR_);
 double GMRFLib_dot_product_group_mkl(GMRFLib_idxval_tp * __restrict ELM_, double *__restrict ARR_);
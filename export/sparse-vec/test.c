@@ -18,6 +18,9 @@ int main(int argc, char **argv)
 		exit(0);
 	}
 
+	GMRFLib_dot_init();
+	printf("Use dot-kernel [%s]\n", GMRFLib_dot_kernel());
+
 	GMRFLib_sparse_vec_tp *sparse_vec = NULL;
 
 	SEED(n);
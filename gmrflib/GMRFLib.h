@@ -102,10 +102,15 @@ void daxpby_(int *n, double *a, double *x, int *incx, double *b, double *y, int
 #include "GMRFLib/fsort.h"
 #include "GMRFLib/error-handler.h"
 #include "GMRFLib/utils.h"
+#include "GMRFLib/arena.h"
 #include "GMRFLib/idxval.h"
 #include "GMRFLib/lapack-interface.h"
 #include "GMRFLib/dot.h"
+#include "GMRFLib/tune.h"
 #include "GMRFLib/timer.h"
+#include "GMRFLib/profile.h"
+#include "GMRFLib/bench.h"
+#include "GMRFLib/memacct.h"
 #include "GMRFLib/io.h"
 #include "GMRFLib/taucs.h"
 #include "GMRFLib/random.h"
@@ -120,8 +125,11 @@ void daxpby_(int *n, double *a, double *x, int *incx, double *b, double *y, int
 #include "GMRFLib/fmesher-io.h"
 #include "GMRFLib/interpol.h"
 #include "GMRFLib/density.h"
+#include "GMRFLib/density-pool.h"
 #include "GMRFLib/globals.h"
 #include "GMRFLib/hash.h"
+#include "GMRFLib/smap.h"
+#include "GMRFLib/config-stream.h"
 #include "GMRFLib/optimize.h"
 #include "GMRFLib/blockupdate.h"
 #include "GMRFLib/distributions.h"
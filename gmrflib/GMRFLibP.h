@@ -384,7 +384,7 @@ typedef enum {
 	size_t calloc_len_ = (size_t)((n_) + calloc_m_ * calloc_mem_align_ * calloc_l1_cacheline_); \
 	size_t calloc_offset_ = 0;					\
 	size_t calloc_m_count_ = 0;					\
-	double *calloc_work_ = Calloc(IMAX(1, calloc_len_), double);	\
+	double *calloc_work_ = aCalloc(IMAX(1, calloc_len_), double);	\
 	assert(calloc_work_)
 
 #define iCalloc_init(n_, m_)						\
@@ -394,7 +394,7 @@ typedef enum {
 	size_t icalloc_len_ = (size_t)((n_) + icalloc_m_ * icalloc_mem_align_ * icalloc_l1_cacheline_); \
 	size_t icalloc_offset_ = 0;					\
 	size_t icalloc_m_count_ = 0;					\
-	int *icalloc_work_ = Calloc(IMAX(1, icalloc_len_), int); \
+	int *icalloc_work_ = aCalloc(IMAX(1, icalloc_len_), int); \
 	assert(icalloc_work_)
 
 #define Calloc_get(_n)							\
@@ -417,14 +417,17 @@ typedef enum {
 	if (!(icalloc_offset_ <= icalloc_len_)) { P(icalloc_offset_); P(icalloc_len_); }; assert(icalloc_offset_ <= icalloc_len_); \
 	if (!(icalloc_m_count_ <= icalloc_m_)) { P(icalloc_m_); P(icalloc_m_count_); }; assert(icalloc_m_count_ <= icalloc_m_)
 
-#define Calloc_free()   if (1) { Calloc_check(); Free(calloc_work_);}
-#define iCalloc_free()  if (1) { iCalloc_check(); Free(icalloc_work_); }
+#define Calloc_free()   if (1) { Calloc_check(); aFree(calloc_work_);}
+#define iCalloc_free()  if (1) { iCalloc_check(); aFree(icalloc_work_); }
 
 #define GMRFLib_ALLOC_SAFE_SIZE(n_, type_) ((size_t)(n_) < PTRDIFF_MAX ? (size_t)(n_) : (size_t)1)
-#if 0
+// with -DGMRFLib_MEMORY_ACCOUNTING the allocations are accounted per subsystem, see memacct.c
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
 #define Calloc(n, type)         (type *)GMRFLib_calloc(GMRFLib_ALLOC_SAFE_SIZE(n, type), sizeof(type), __FILE__, __GMRFLib_FuncName, __LINE__)
 #define Malloc(n, type)         (type *)GMRFLib_malloc(GMRFLib_ALLOC_SAFE_SIZE((n) * sizeof(type), char), __FILE__, __GMRFLib_FuncName, __LINE__)
-#define Realloc(ptr, n, type)   (type *)GMRFLib_realloc((void *)ptr, GMRFLib_ALLOC_SAFE_SIZE((n)*sizeof(type), char), __FILE__, __GMRFLib_FuncName, __LINE__)
+#define Realloc(ptr, n, type)   ((ptr) ? \
+				 (type *)GMRFLib_realloc((void *)ptr, GMRFLib_ALLOC_SAFE_SIZE((n)*sizeof(type), char), __FILE__, __GMRFLib_FuncName, __LINE__) : \
+				 (type *)GMRFLib_calloc(GMRFLib_ALLOC_SAFE_SIZE(n, type), sizeof(type), __FILE__, __GMRFLib_FuncName, __LINE__))
 #define Free(ptr)               if (ptr) {GMRFLib_free((void *)(ptr), __FILE__, __GMRFLib_FuncName, __LINE__); ptr=NULL;}
 #define Memcpy(dest, src, n)    GMRFLib_memcpy(dest, src, n)
 #else
@@ -438,6 +441,9 @@ typedef enum {
 #define Memcpy(dest, src, n)    memcpy((void *) (dest), (void *) (src), GMRFLib_ALLOC_SAFE_SIZE(n, char))
 #endif
 #define Memset(dest, value, n)  memset((void *) (dest), (int) (value), (size_t) (n))
+// zeroed workspace from the per-thread arena, see arena.c. must be released in the same thread, preferably in reverse order
+#define aCalloc(n, type)        (type *)GMRFLib_arena_calloc(GMRFLib_ALLOC_SAFE_SIZE(n, type), sizeof(type), __FILE__, __GMRFLib_FuncName, __LINE__)
+#define aFree(ptr)              if (ptr) {GMRFLib_arena_free((void *)(ptr)); ptr=NULL;}
 
 #define ABS(x) fabs(x)
 #define FIXME( msg) if (1) { printf("\n{%1d}[%s:%1d] %s: FIXME [%s]\n",  omp_get_thread_num(), __FILE__, __LINE__, __GMRFLib_FuncName,(msg?msg:""));	}
@@ -534,14 +540,14 @@ typedef enum {
 		int len_work__ = GMRFLib_align(IMAX(1, len_work_), sizeof(double)); \
 		int n_work__ = IMAX(1, n_work_);			\
 		nt__ = (tmax__ < 0 ? -tmax__ : IMAX(1, IMIN(nt__, tmax__))); \
-		double * work__ = Calloc(len_work__ * n_work__ * nt__, double);	\
+		double * work__ = aCalloc(len_work__ * n_work__ * nt__, double); \
 		if (nt__ > 1) {						\
 			_Pragma("omp parallel for num_threads(nt__) schedule(static)") \
 				CODE_BLOCK;				\
 		} else {						\
 			CODE_BLOCK;					\
 		}							\
-		Free(work__);						\
+		aFree(work__);						\
         }
 
 #define RUN_CODE_BLOCK_DYNAMIC(thread_max_, n_work_, len_work_)		\
@@ -553,14 +559,14 @@ typedef enum {
 		int len_work__ = IMAX(1, len_work_ + l1_cacheline);	\
 		int n_work__ = IMAX(1, n_work_);			\
 		nt__ = (tmax__ < 0 ? -tmax__ : IMAX(1, IMIN(nt__, tmax__))); \
-		double * work__ = Calloc(len_work__ * n_work__ * nt__, double);	\
+		double * work__ = aCalloc(len_work__ * n_work__ * nt__, double); \
 		if (nt__ > 1) {						\
 			_Pragma("omp parallel for num_threads(nt__) schedule(dynamic)") \
 				CODE_BLOCK;				\
 		} else {						\
 			CODE_BLOCK;					\
 		}							\
-		Free(work__);						\
+		aFree(work__);						\
         }
 
 #define CODE_BLOCK_WORK_TP_PTR() work_t__[omp_get_thread_num()]
@@ -575,14 +581,14 @@ typedef enum {
 		work_tp_ ** work_t__ = Calloc(tmax__, work_tp_ *);	\
 		for (int i_ = 0; i_ < tmax__; i_++) work_t__[i_] = Calloc(1, work_tp_); \
 		nt__ = (tmax__ < 0 ? -tmax__ : IMAX(1, IMIN(nt__, tmax__))); \
-		double * work__ = Calloc(len_work__ * n_work__ * nt__, double);	\
+		double * work__ = aCalloc(len_work__ * n_work__ * nt__, double); \
 		if (nt__ > 1) {						\
 			_Pragma("omp parallel for num_threads(nt__) schedule(static)") \
 				CODE_BLOCK;				\
 		} else {						\
 			CODE_BLOCK;					\
 		}							\
-		Free(work__);						\
+		aFree(work__);						\
 		for (int i_ = 0; i_ < tmax__; i_++) {			\
 			CODE_BLOCK_WORK_TP_FREE(work_t__[i_]);	\
 		}							\
@@ -603,7 +603,7 @@ int GMRFLib_ai_marginal_hidden(int thread_id, GMRFLib_density_tp **density, GMRF
 			for (j = 0; j < ai_store->nidx; j++) {
 				i = ai_store->correction_idx[j];
 				j_idx = store_Qinv->mapping[i];
-				cov = map_id_ptr(store_Qinv->Qinv[IMIN(i_idx, j_idx)], IMAX(i_idx, j_idx));
+				cov = smap_id_ptr(store_Qinv->Qinv[IMIN(i_idx, j_idx)], IMAX(i_idx, j_idx));
 				if (cov) {
 					corr = *cov * inv_stdev / ai_store->stdev[i];
 					corr_term = 1.0 - SQR(corr);
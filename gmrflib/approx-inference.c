@@ -188,6 +188,9 @@ int GMRFLib_default_ai_param(GMRFLib_ai_param_tp **ai_par)
 
 	(*ai_par)->hessian_correct_skewness_only = 0;
 
+	(*ai_par)->hessian_known = NULL;
+	(*ai_par)->hessian_known_tol = 0.1;
+
 	return GMRFLib_SUCCESS;
 }
 
@@ -245,6 +248,7 @@ int GMRFLib_print_ai_param(FILE *fp, GMRFLib_ai_param_tp *ai_par)
 	fprintf(fp, "\t\tOptimise: try to be smart: %s\n", (ai_par->optimise_smart ? "Yes" : "No"));
 	fprintf(fp, "\t\tOptimise: use directions: %s\n", (ai_par->optimise_use_directions ? "Yes" : "No"));
 	fprintf(fp, "\t\tMode known: %s\n", (ai_par->mode_known ? "Yes" : "No"));
+	fprintf(fp, "\t\tHessian known: %s (tol = %.4g)\n", (ai_par->hessian_known ? "Yes" : "No"), ai_par->hessian_known_tol);
 	fprintf(fp, "\t\tparallel linesearch [%1d]\n", ai_par->parallel_linesearch);
 
 	gsl_matrix *m = ai_par->optimise_use_directions_m;
@@ -487,7 +491,11 @@ int GMRFLib_ai_marginal_hyperparam(int thread_id,
 
 	n = graph->n;
 	Free(ai_store->correction_term);
-	Free(ai_store->correction_idx);
+	if (GMRFLib_shared_unref(ai_store->correction_idx)) {
+		Free(ai_store->correction_idx);
+	} else {
+		ai_store->correction_idx = NULL;
+	}
 	Free(ai_store->derivative3);
 	Free(ai_store->derivative4);
 	Free(ai_store->aa);
@@ -575,9 +583,13 @@ int GMRFLib_free_ai_store(GMRFLib_ai_store_tp *ai_store)
 		Free(ai_store->bb);
 		Free(ai_store->cc);
 		Free(ai_store->stdev);
-		GMRFLib_idx_free(ai_store->d_idx);
+		if (GMRFLib_shared_unref(ai_store->d_idx)) {
+			GMRFLib_idx_free(ai_store->d_idx);
+		}
 		Free(ai_store->correction_term);
-		Free(ai_store->correction_idx);
+		if (GMRFLib_shared_unref(ai_store->correction_idx)) {
+			Free(ai_store->correction_idx);
+		}
 		Free(ai_store->derivative3);
 		Free(ai_store->derivative4);
 		Free(ai_store);
@@ -754,6 +766,7 @@ int GMRFLib_init_GMRF_approximation_store__intern(int thread_id,
 	ccoof = Calloc(Npred, double);
 
 	for (iter = 0; iter < itmax; iter++) {
+		GMRFLib_PROFILE_NEXT(GMRFLib_PROFILE_NEWTON, "newton-iteration");
 
 		if (0) {
 			for (int i = 0; i < n; i++) {
@@ -831,7 +844,9 @@ int GMRFLib_init_GMRF_approximation_store__intern(int thread_id,
 			cc[idx] += ccoof[idx];				\
 		}
 
+		GMRFLib_PROFILE_BEGIN(GMRFLib_PROFILE_LIKELIHOOD, "likelihood-2order");
 		RUN_CODE_BLOCK(GMRFLib_openmp->max_threads_inner, 0, 0);
+		GMRFLib_PROFILE_END("likelihood-2order");
 #undef CODE_BLOCK
 
 		double *bb_use = NULL, *cc_use = NULL;
@@ -965,6 +980,7 @@ int GMRFLib_init_GMRF_approximation_store__intern(int thread_id,
 
 		err_previous = err;
 	}
+	GMRFLib_PROFILE_END("newton-iteration");
 
 	Free(ccoof);
 	Free(bcoof);
@@ -1129,16 +1145,16 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 	    NULL, *stdev_corr_pos = NULL, *stdev_corr_neg = NULL, f, w, w_origo, tref, tu, *weights = NULL, *adj_weights =
 	    NULL, *hyper_z = NULL, *hyper_ldens = NULL, **userfunc_values = NULL, *inverse_hessian = NULL, *timer,
 	    **cpo_theta = NULL, **po_theta = NULL, **po2_theta = NULL, **po3_theta = NULL, **pit_theta = NULL, ***deviance_theta =
-	    NULL, **failure_theta = NULL;
+	    NULL, **failure_theta = NULL, *theta_initial = NULL;
 
 	GMRFLib_gcpo_elm_tp ***gcpo_theta = NULL;
 	gsl_matrix *H = NULL, *eigen_vectors = NULL;
 	gsl_eigen_symmv_workspace *work = NULL;
 	gsl_vector *eigen_values = NULL;
 	gsl_vector *sqrt_eigen_values = NULL;
-	GMRFLib_density_tp ***dens = NULL;
-	GMRFLib_density_tp ***lpred = NULL;
-	GMRFLib_density_tp ***dens_transform = NULL;
+	GMRFLib_density_pool_tp **dens = NULL;		       /* one pool for each configuration */
+	GMRFLib_density_pool_tp **lpred = NULL;		       /* one pool for each configuration */
+	GMRFLib_density_pool_tp **dens_transform = NULL;	       /* one pool for each node */
 	GMRFLib_density_tp ***lin_dens = NULL;
 	GMRFLib_ai_store_tp **ais = NULL;
 	double **lin_cross = NULL;
@@ -1244,19 +1260,15 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 		userfunc_values = Calloc(dens_max, double *);
 	}
 
-	dens = Calloc(graph->n, GMRFLib_density_tp **);
-	dens_transform = Calloc(graph->n, GMRFLib_density_tp **);
+	dens = Calloc(dens_max, GMRFLib_density_pool_tp *);    /* storage for the marginals */
+	dens_transform = Calloc(graph->n, GMRFLib_density_pool_tp *);
 	for (int j = 0; j < graph->n; j++) {
-		dens[j] = Calloc(dens_max, GMRFLib_density_tp *);	/* storage for the marginals */
 		if (tfunc && tfunc[j]) {
-			dens_transform[j] = Calloc(dens_max, GMRFLib_density_tp *);
+			GMRFLib_density_pool_create(&dens_transform[j], dens_max);
 		}
 	}
 
-	lpred = Calloc(preopt->mnpred, GMRFLib_density_tp **);
-	for (int j = 0; j < preopt->mnpred; j++) {
-		lpred[j] = Calloc(dens_max, GMRFLib_density_tp *);	/* storage for the marginals */
-	}
+	lpred = Calloc(dens_max, GMRFLib_density_pool_tp *);   /* storage for the marginals */
 
 	if (gcpo) {
 		gcpo_theta = Calloc(dens_max, GMRFLib_gcpo_elm_tp **);
@@ -1328,6 +1340,12 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 		theta_mode = Calloc(nhyper, double);
 		z = Calloc(nhyper, double);
 
+		// keep the initial values, as we need them to decide if a known Hessian can be reused
+		theta_initial = Calloc(nhyper, double);
+		for (int i = 0; i < nhyper; i++) {
+			theta_initial[i] = hyperparam[i][0][0];
+		}
+
 		/*
 		 * if not set to be known, then optimise 
 		 */
@@ -1458,6 +1476,26 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 
 		hessian = Calloc(ISQR(nhyper), double);
 
+		/*
+		 * if the Hessian is known from a previous fit, and the mode has not moved much from the initial values, then we can
+		 * reuse it. the distance is measured in the metric of the known Hessian, so its in units of (approximate) stdev's
+		 */
+		double hessian_known_dist = GSL_POSINF;
+		if (ai_par->hessian_known) {
+			hessian_known_dist = 0.0;
+			for (int i = 0; i < nhyper; i++) {
+				for (int j = 0; j < nhyper; j++) {
+					hessian_known_dist += (theta_mode[i] - theta_initial[i]) * ai_par->hessian_known[i + nhyper * j] *
+					    (theta_mode[j] - theta_initial[j]);
+				}
+			}
+			hessian_known_dist = sqrt(DMAX(0.0, hessian_known_dist));
+			if (ai_par->fp_log) {
+				fprintf(ai_par->fp_log, "Distance from initial values to the mode using the known Hessian = %.4g (tol = %.4g)\n",
+					hessian_known_dist, ai_par->hessian_known_tol);
+			}
+		}
+
 		if (ai_par->fixed_mode) {
 			if (ai_par->fp_log) {
 				fprintf(ai_par->fp_log, "fixed_mode=1 so, artificially, Hessian=diag(1)\n");
@@ -1465,6 +1503,11 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 			for (int i = 0; i < nhyper; i++) {
 				hessian[i + nhyper * i] = 1.0;
 			}
+		} else if (hessian_known_dist < ai_par->hessian_known_tol) {
+			if (ai_par->fp_log) {
+				fprintf(ai_par->fp_log, "Reuse the known Hessian\n");
+			}
+			Memcpy(hessian, ai_par->hessian_known, ISQR(nhyper) * sizeof(double));
 		} else {
 			if (!(ai_par->optimise_smart) || !smart_success) {
 
@@ -1947,301 +1990,313 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 		place_save = GMRFLib_openmp->place;
 		GMRFLib_openmp_implement_strategy_special(outer, inner);
 	}
+	// with autotuning, the experiments are done in chunks while the (outer x inner) splits are measured
+	for (int k_first = 0, k_last = 0; k_first < design->nexperiments; k_first = k_last) {
+		k_last = GMRFLib_openmp_autotune_next(GMRFLib_OPENMP_PLACES_INTEGRATE_HYPERPAR, k_first, design->nexperiments);
+		nt = IMAX(1, IMIN(k_last - k_first, GMRFLib_openmp->max_threads_outer));
+		double tref_chunk = GMRFLib_timer();
 #pragma omp parallel for private(log_dens, dens_count, tref, tu, ierr) num_threads(nt)
-	for (int k = 0; k < design->nexperiments; k++) {
-		int thread_id = omp_get_thread_num();
+		for (int k = k_first; k < k_last; k++) {
+			int thread_id = omp_get_thread_num();
 
-		double *z_local, *theta_local, log_dens_orig;
-		GMRFLib_ai_store_tp *ai_store_id = NULL;
-		GMRFLib_tabulate_Qfunc_tp *tabQfunc = NULL;
-		double *bnew = NULL;
+			double *z_local, *theta_local, log_dens_orig;
+			GMRFLib_ai_store_tp *ai_store_id = NULL;
+			GMRFLib_tabulate_Qfunc_tp *tabQfunc = NULL;
+			double *bnew = NULL;
 
-		dens_count = k;
+			dens_count = k;
 
-		if (GMRFLib_OPENMP_IN_PARALLEL_ONEPLUS_THREAD()) {
-			if (!ais[thread_id]) {
-				ais[thread_id] = GMRFLib_duplicate_ai_store(ai_store, GMRFLib_FALSE, GMRFLib_TRUE, GMRFLib_FALSE);
+			if (GMRFLib_OPENMP_IN_PARALLEL_ONEPLUS_THREAD()) {
+				if (!ais[thread_id]) {
+					ais[thread_id] = GMRFLib_duplicate_ai_store(ai_store, GMRFLib_FALSE, GMRFLib_TRUE, GMRFLib_FALSE);
+				}
+				ai_store_id = ais[thread_id];
+			} else {
+				ai_store_id = ai_store;		       /* the common one */
 			}
-			ai_store_id = ais[thread_id];
-		} else {
-			ai_store_id = ai_store;		       /* the common one */
-		}
-		assert(ai_store_id);
+			assert(ai_store_id);
 
-		z_local = Calloc(nhyper, double);
-		theta_local = Calloc(nhyper, double);
-
-		if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_CCD || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_GRID) {
-			for (int i = 0; i < nhyper; i++) {
-				z_local[i] = f * design->experiment[k][i]
-				    * (design->experiment[k][i] > 0.0 ? stdev_corr_pos[i] : stdev_corr_neg[i]);
-			}
-		} else if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_STD) {
-			for (int i = 0; i < nhyper; i++) {
-				z_local[i] = design->experiment[k][i]
-				    * (design->experiment[k][i] > 0.0 ? stdev_corr_pos[i] : stdev_corr_neg[i]);
-			}
-		} else if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
-			for (int i = 0; i < nhyper; i++) {
-				z_local[i] = design->experiment[k][i];
-			}
-		} else {
-			// nothing
-		}
+			z_local = Calloc(nhyper, double);
+			theta_local = Calloc(nhyper, double);
 
-		if ((nhyper > 0 || GMRFLib_OPENMP_IN_PARALLEL_ONEPLUS_THREAD()) && !ai_par->fixed_mode) {
-			if (design->std_scale) {
-				// convert to theta_local
-				GMRFLib_ai_z2theta(theta_local, nhyper, theta_mode, z_local, sqrt_eigen_values, eigen_vectors);
+			if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_CCD || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_GRID) {
+				for (int i = 0; i < nhyper; i++) {
+					z_local[i] = f * design->experiment[k][i]
+					    * (design->experiment[k][i] > 0.0 ? stdev_corr_pos[i] : stdev_corr_neg[i]);
+				}
+			} else if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_STD) {
+				for (int i = 0; i < nhyper; i++) {
+					z_local[i] = design->experiment[k][i]
+					    * (design->experiment[k][i] > 0.0 ? stdev_corr_pos[i] : stdev_corr_neg[i]);
+				}
+			} else if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
+				for (int i = 0; i < nhyper; i++) {
+					z_local[i] = design->experiment[k][i];
+				}
 			} else {
-				// theta_local is, by request, the same as z_local
-				Memcpy(theta_local, z_local, nhyper * sizeof(double));
+				// nothing
 			}
 
-			GMRFLib_opt_f_intern(thread_id, theta_local, &log_dens, &ierr, ai_store_id, &tabQfunc, &bnew);
-			log_dens *= -1.0;
-			log_dens_orig = log_dens;
+			if ((nhyper > 0 || GMRFLib_OPENMP_IN_PARALLEL_ONEPLUS_THREAD()) && !ai_par->fixed_mode) {
+				if (design->std_scale) {
+					// convert to theta_local
+					GMRFLib_ai_z2theta(theta_local, nhyper, theta_mode, z_local, sqrt_eigen_values, eigen_vectors);
+				} else {
+					// theta_local is, by request, the same as z_local
+					Memcpy(theta_local, z_local, nhyper * sizeof(double));
+				}
 
-			// make sure z_local's are aligned with theta_local's, for later usage.
-			GMRFLib_ai_theta2z(z_local, nhyper, theta_mode, theta_local, sqrt_eigen_values, eigen_vectors);
-		} else {
-			log_dens = log_dens_orig = log_dens_mode;
-		}
+				GMRFLib_opt_f_intern(thread_id, theta_local, &log_dens, &ierr, ai_store_id, &tabQfunc, &bnew);
+				log_dens *= -1.0;
+				log_dens_orig = log_dens;
 
-		/*
-		 * correct the log_dens due to the integration weights which is special for the CCD
-		 * integration and the deterministic integration points
-		 * 
-		 */
-		if (ISNAN(design->int_weight[k]) || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_CCD) {
-			// integration weights are undefined. use these for the CCD design (as it _IS_
-			// the CCD design in this case
-			if (nhyper > 1) {
-				/*
-				 * the weight formula is only valid for nhyper > 1. 
-				 */
-				int origo = 1;
+				// make sure z_local's are aligned with theta_local's, for later usage.
+				GMRFLib_ai_theta2z(z_local, nhyper, theta_mode, theta_local, sqrt_eigen_values, eigen_vectors);
+			} else {
+				log_dens = log_dens_orig = log_dens_mode;
+			}
 
-				for (int i = 0; i < nhyper; i++) {
-					origo = (origo && ISZERO(z_local[i]));
-				}
-				if (origo) {
-					if (ISZERO(w_origo)) {
-						log_dens += -DBL_MAX;
+			/*
+			 * correct the log_dens due to the integration weights which is special for the CCD
+			 * integration and the deterministic integration points
+			 * 
+			 */
+			if (ISNAN(design->int_weight[k]) || ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_CCD) {
+				// integration weights are undefined. use these for the CCD design (as it _IS_
+				// the CCD design in this case
+				if (nhyper > 1) {
+					/*
+					 * the weight formula is only valid for nhyper > 1. 
+					 */
+					int origo = 1;
+
+					for (int i = 0; i < nhyper; i++) {
+						origo = (origo && ISZERO(z_local[i]));
+					}
+					if (origo) {
+						if (ISZERO(w_origo)) {
+							log_dens += -DBL_MAX;
+						} else {
+							log_dens += log(w_origo);
+						}
 					} else {
-						log_dens += log(w_origo);
+						log_dens += log(w);
 					}
-				} else {
-					log_dens += log(w);
 				}
-			}
-		} else {
-			// integration weights are _given_. this is the deterministic integration points (which includes the _GRID)
-			if (ai_par->int_strategy != GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
-				log_dens += log(design->int_weight[k]);
 			} else {
-				// we do that later
+				// integration weights are _given_. this is the deterministic integration points (which includes the _GRID)
+				if (ai_par->int_strategy != GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
+					log_dens += log(design->int_weight[k]);
+				} else {
+					// we do that later
+				}
 			}
-		}
 
-		for (int i = 0; i < nhyper; i++) {
-			hyper_z[dens_count * nhyper + i] = z_local[i];
-		}
-		if (nhyper) {
-			hyper_ldens[dens_count] = log_dens_orig - log_dens_mode;
-		}
+			for (int i = 0; i < nhyper; i++) {
+				hyper_z[dens_count * nhyper + i] = z_local[i];
+			}
+			if (nhyper) {
+				hyper_ldens[dens_count] = log_dens_orig - log_dens_mode;
+			}
 
-		if (nhyper > 0) {
-			if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
-				// In this case, the int_weights INCLUDE the log_dens
-				weights[dens_count] = log(design->int_weight[k]);
+			if (nhyper > 0) {
+				if (ai_par->int_strategy == GMRFLib_AI_INT_STRATEGY_USER_EXPERT) {
+					// In this case, the int_weights INCLUDE the log_dens
+					weights[dens_count] = log(design->int_weight[k]);
+				} else {
+					weights[dens_count] = log_dens;
+				}
 			} else {
-				weights[dens_count] = log_dens;
+				weights[dens_count] = 1.0;
 			}
-		} else {
-			weights[dens_count] = 1.0;
-		}
-		izs[dens_count] = Calloc(nhyper, double);
+			izs[dens_count] = Calloc(nhyper, double);
 
-		for (int i = 0; i < nhyper; i++) {
-			izs[dens_count][i] = z_local[i];
-		}
+			for (int i = 0; i < nhyper; i++) {
+				izs[dens_count][i] = z_local[i];
+			}
 
-		tref = GMRFLib_timer();
-		GMRFLib_ai_add_Qinv_to_ai_store(ai_store_id);  /* add Qinv if its not there already */
+			tref = GMRFLib_timer();
+			GMRFLib_ai_add_Qinv_to_ai_store(ai_store_id);  /* add Qinv if its not there already */
 
+			GMRFLib_density_pool_create(&dens[dens_count], graph->n);
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_inner)
-		for (int i = 0; i < graph->n; i++) {
-			GMRFLib_density_create_normal(&dens[i][dens_count], 0.0, 1.0, ai_store_id->mode[i], ai_store_id->stdev[i], 0);
-			if (tfunc && tfunc[i]) {
-				GMRFLib_transform_density(&dens_transform[i][dens_count], dens[i][dens_count], tfunc[i]);
+			for (int i = 0; i < graph->n; i++) {
+				GMRFLib_density_pool_set_normal(dens[dens_count], i, 0.0, 1.0, ai_store_id->mode[i], ai_store_id->stdev[i]);
+				if (tfunc && tfunc[i]) {
+					GMRFLib_density_tp *dt = NULL, view;
+					GMRFLib_transform_density(&dt, GMRFLib_density_pool_view(&view, dens[dens_count], i), tfunc[i]);
+					GMRFLib_density_pool_set(dens_transform[i], dens_count, dt);
+				}
 			}
-		}
 
-		if (ai_par->vb_enable && (ai_par->vb_strategy == GMRFLib_AI_VB_MEAN || ai_par->vb_strategy == GMRFLib_AI_VB_VARIANCE)) {
-			GMRFLib_ai_vb_correct_mean_preopt(thread_id, dens, dens_count,
-							  c, d, prior_mean, ai_par, ai_store_id, graph,
-							  (tabQfunc ? tabQfunc->Qfunc : Qfunc), (tabQfunc ? tabQfunc->Qfunc_arg : Qfunc_arg),
-							  loglFunc, loglFunc_arg, preopt, d_idx);
-		}
+			if (ai_par->vb_enable && (ai_par->vb_strategy == GMRFLib_AI_VB_MEAN || ai_par->vb_strategy == GMRFLib_AI_VB_VARIANCE)) {
+				GMRFLib_ai_vb_correct_mean_preopt(thread_id, dens[dens_count],
+								  c, d, prior_mean, ai_par, ai_store_id, graph,
+								  (tabQfunc ? tabQfunc->Qfunc : Qfunc), (tabQfunc ? tabQfunc->Qfunc_arg : Qfunc_arg),
+								  loglFunc, loglFunc_arg, preopt, d_idx);
+			}
 
-		double *c_corrected = NULL;
-		if (ai_par->vb_enable && (ai_par->vb_strategy == GMRFLib_AI_VB_VARIANCE)) {
-			c_corrected = Calloc(graph->n, double);
-			GMRFLib_ai_vb_correct_variance_preopt(thread_id, dens, dens_count,
-							      c, d, ai_par, ai_store_id, graph,
-							      (tabQfunc ? tabQfunc->Qfunc : Qfunc), (tabQfunc ? tabQfunc->Qfunc_arg : Qfunc_arg),
-							      loglFunc, loglFunc_arg, preopt, c_corrected, d_idx);
-		}
+			double *c_corrected = NULL;
+			if (ai_par->vb_enable && (ai_par->vb_strategy == GMRFLib_AI_VB_VARIANCE)) {
+				c_corrected = Calloc(graph->n, double);
+				GMRFLib_ai_vb_correct_variance_preopt(thread_id, dens[dens_count],
+								      c, d, ai_par, ai_store_id, graph,
+								      (tabQfunc ? tabQfunc->Qfunc : Qfunc), (tabQfunc ? tabQfunc->Qfunc_arg : Qfunc_arg),
+								      loglFunc, loglFunc_arg, preopt, c_corrected, d_idx);
+			}
 
-		double *mean_corrected = Calloc(graph->n, double);
-		double *lpred_mean = Calloc(preopt->mnpred, double);
-		double *lpred_mode = Calloc(preopt->mnpred, double);
-		double *lpred_variance = Calloc(preopt->mnpred, double);
+			double *mean_corrected = Calloc(graph->n, double);
+			double *lpred_mean = Calloc(preopt->mnpred, double);
+			double *lpred_mode = Calloc(preopt->mnpred, double);
+			double *lpred_variance = Calloc(preopt->mnpred, double);
 
-		for (int i = 0; i < graph->n; i++) {
-			mean_corrected[i] = dens[i][dens_count]->user_mean;
-		}
-		GMRFLib_preopt_predictor_moments(lpred_mean, lpred_variance, preopt, ai_store_id->problem, mean_corrected);
-		GMRFLib_preopt_predictor_moments(lpred_mode, NULL, preopt, ai_store_id->problem, NULL);
+			for (int i = 0; i < graph->n; i++) {
+				mean_corrected[i] = GMRFLib_density_pool_user_mean(dens[dens_count], i);
+			}
+			GMRFLib_preopt_predictor_moments(lpred_mean, lpred_variance, preopt, ai_store_id->problem, mean_corrected);
+			GMRFLib_preopt_predictor_moments(lpred_mode, NULL, preopt, ai_store_id->problem, NULL);
 
+			GMRFLib_density_pool_create(&lpred[dens_count], preopt->mnpred);
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_inner)
-		for (int i = 0; i < preopt->mnpred; i++) {
-			GMRFLib_density_create_normal(&lpred[i][dens_count], 0.0, 1.0, lpred_mean[i], sqrt(lpred_variance[i]), 0);
-		}
+			for (int i = 0; i < preopt->mnpred; i++) {
+				GMRFLib_density_pool_set_normal(lpred[dens_count], i, 0.0, 1.0, lpred_mean[i], sqrt(lpred_variance[i]));
+			}
 
-		double *gcpodens_moments = NULL;
-		if (gcpo) {
-			if (misc_output->configs_preopt) {
-				gcpodens_moments = Calloc(3 * preopt->Npred, double);
-				GMRFLib_fill(3 * preopt->Npred, NAN, gcpodens_moments);
+			double *gcpodens_moments = NULL;
+			if (gcpo) {
+				if (misc_output->configs_preopt) {
+					gcpodens_moments = Calloc(3 * preopt->Npred, double);
+					GMRFLib_fill(3 * preopt->Npred, NAN, gcpodens_moments);
+				}
+				gcpo_theta[dens_count] = GMRFLib_gcpo(thread_id, ai_store_id, lpred_mean, lpred_mode, lpred_variance, preopt, gcpo_groups,
+								      d, loglFunc, loglFunc_arg, ai_par, gcpo_param, gcpodens_moments, d_idx);
 			}
-			gcpo_theta[dens_count] = GMRFLib_gcpo(thread_id, ai_store_id, lpred_mean, lpred_mode, lpred_variance, preopt, gcpo_groups,
-							      d, loglFunc, loglFunc_arg, ai_par, gcpo_param, gcpodens_moments, d_idx);
-		}
 
-		if (GMRFLib_ai_INLA_userfunc0) {
-			userfunc_values[dens_count] = GMRFLib_ai_INLA_userfunc0(thread_id, ai_store_id->problem, theta_local, nhyper);
-		}
+			if (GMRFLib_ai_INLA_userfunc0) {
+				userfunc_values[dens_count] = GMRFLib_ai_INLA_userfunc0(thread_id, ai_store_id->problem, theta_local, nhyper);
+			}
 
-		if (nlin) {
-			GMRFLib_ai_compute_lincomb(&(lin_dens[dens_count]), (lin_cross ? &(lin_cross[dens_count]) : NULL),
-						   nlin, Alin, ai_store_id, mean_corrected, 0);
-		}
+			if (nlin) {
+				GMRFLib_ai_compute_lincomb(&(lin_dens[dens_count]), (lin_cross ? &(lin_cross[dens_count]) : NULL),
+							   nlin, Alin, ai_store_id, mean_corrected, 0);
+			}
 
-		double *cpodens_moments = NULL;
-		if (misc_output->configs_preopt && cpo) {
-			cpodens_moments = Calloc(3 * preopt->Npred, double);
-			GMRFLib_fill(3 * preopt->Npred, NAN, cpodens_moments);
-		}
+			double *cpodens_moments = NULL;
+			if (misc_output->configs_preopt && cpo) {
+				cpodens_moments = Calloc(3 * preopt->Npred, double);
+				GMRFLib_fill(3 * preopt->Npred, NAN, cpodens_moments);
+			}
 
-		if (cpo || dic || po) {
+			if (cpo || dic || po) {
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_inner)
-			for (int ii = 0; ii < d_idx->n; ii++) {
-				int i = d_idx->idx[ii];
-				if (fl[i]) {
-					continue;
-				}
-				GMRFLib_density_tp *cpodens = NULL;
-				if (cpo) {
-					GMRFLib_compute_cpodens(thread_id, &cpodens, lpred[i][dens_count], i, d[i], loglFunc, loglFunc_arg, ai_par);
-					if (cpodens_moments) {
-						if (cpodens) {
-							cpodens_moments[3 * i + 0] = cpodens->user_mean;
-							cpodens_moments[3 * i + 1] = SQR(cpodens->user_stdev);
-							cpodens_moments[3 * i + 2] = cpodens->skewness;
-						} else {
-							cpodens_moments[3 * i + 0] = NAN;
-							cpodens_moments[3 * i + 1] = NAN;
-							cpodens_moments[3 * i + 2] = NAN;
+				for (int ii = 0; ii < d_idx->n; ii++) {
+					int i = d_idx->idx[ii];
+					if (fl[i]) {
+						continue;
+					}
+					GMRFLib_density_tp *cpodens = NULL, lpred_view;
+					GMRFLib_density_pool_view(&lpred_view, lpred[dens_count], i);
+					if (cpo) {
+						GMRFLib_compute_cpodens(thread_id, &cpodens, &lpred_view, i, d[i], loglFunc, loglFunc_arg, ai_par);
+						if (cpodens_moments) {
+							if (cpodens) {
+								cpodens_moments[3 * i + 0] = cpodens->user_mean;
+								cpodens_moments[3 * i + 1] = SQR(cpodens->user_stdev);
+								cpodens_moments[3 * i + 2] = cpodens->skewness;
+							} else {
+								cpodens_moments[3 * i + 0] = NAN;
+								cpodens_moments[3 * i + 1] = NAN;
+								cpodens_moments[3 * i + 2] = NAN;
+							}
 						}
+						failure_theta[i][dens_count] = GMRFLib_ai_cpopit_integrate(thread_id,
+													   &cpo_theta[i][dens_count],
+													   &pit_theta[i][dens_count], i, cpodens,
+													   d[i], loglFunc, loglFunc_arg, lpred_mean);
+						if (cpodens && GMRFLib_getbit(cpodens->flags, DENSITY_FLAGS_FAILURE)) {
+							failure_theta[i][dens_count] = 1.0;
+						}
+						GMRFLib_free_density(cpodens);
 					}
-					failure_theta[i][dens_count] = GMRFLib_ai_cpopit_integrate(thread_id,
-												   &cpo_theta[i][dens_count],
-												   &pit_theta[i][dens_count], i, cpodens,
-												   d[i], loglFunc, loglFunc_arg, lpred_mean);
-					if (cpodens && GMRFLib_getbit(cpodens->flags, DENSITY_FLAGS_FAILURE)) {
-						failure_theta[i][dens_count] = 1.0;
+					if (dic) {
+						deviance_theta[i][dens_count] = GMRFLib_ai_dic_integrate(thread_id, i, &lpred_view, d[i],
+													 loglFunc, loglFunc_arg, lpred_mean);
+					}
+					if (po) {
+						GMRFLib_ai_po_integrate(thread_id, &po_theta[i][dens_count], &po2_theta[i][dens_count],
+									&po3_theta[i][dens_count], i, &lpred_view, d[i], loglFunc, loglFunc_arg,
+									lpred_mean);
 					}
-					GMRFLib_free_density(cpodens);
-				}
-				if (dic) {
-					deviance_theta[i][dens_count] = GMRFLib_ai_dic_integrate(thread_id, i, lpred[i][dens_count], d[i],
-												 loglFunc, loglFunc_arg, lpred_mean);
-				}
-				if (po) {
-					GMRFLib_ai_po_integrate(thread_id, &po_theta[i][dens_count], &po2_theta[i][dens_count],
-								&po3_theta[i][dens_count], i, lpred[i][dens_count], d[i], loglFunc, loglFunc_arg,
-								lpred_mean);
 				}
 			}
-		}
 
-		char **arg_str = NULL;
-		if (misc_output->likelihood_info) {
-			assert(misc_output->configs_preopt);
-			arg_str = Calloc(preopt->Npred, char *);
-			for (int jj = 0; jj < d_idx->n; jj++) {
-				int j = d_idx->idx[jj];
-				double dummy;
-				loglFunc(thread_id, &dummy, &(lpred_mean[j]), 1, j, NULL, NULL, loglFunc_arg, &(arg_str[j]));
+			char **arg_str = NULL;
+			if (misc_output->likelihood_info) {
+				assert(misc_output->configs_preopt);
+				arg_str = Calloc(preopt->Npred, char *);
+				for (int jj = 0; jj < d_idx->n; jj++) {
+					int j = d_idx->idx[jj];
+					double dummy;
+					loglFunc(thread_id, &dummy, &(lpred_mean[j]), 1, j, NULL, NULL, loglFunc_arg, &(arg_str[j]));
+				}
 			}
-		}
 
-		double *ll_info = NULL;
-		if (misc_output->configs_preopt) {
-			ll_info = Calloc(3 * preopt->Npred, double);
-			for (int j = 0; j < preopt->Npred; j++) {
-				int jj = 3 * j;
-				double local_aa;
-				if (d[j]) {
-					GMRFLib_2order_taylor(thread_id, &local_aa, &(ll_info[jj]), &(ll_info[jj + 1]), &(ll_info[jj + 2]), d[j],
-							      lpred_mode[j], j, lpred_mode, loglFunc, loglFunc_arg, &ai_par->step_len,
-							      &ai_par->stencil);
-				} else {
-					ll_info[jj] = ll_info[jj + 1] = ll_info[jj + 2] = NAN;
+			double *ll_info = NULL;
+			if (misc_output->configs_preopt) {
+				ll_info = Calloc(3 * preopt->Npred, double);
+				for (int j = 0; j < preopt->Npred; j++) {
+					int jj = 3 * j;
+					double local_aa;
+					if (d[j]) {
+						GMRFLib_2order_taylor(thread_id, &local_aa, &(ll_info[jj]), &(ll_info[jj + 1]), &(ll_info[jj + 2]), d[j],
+								      lpred_mode[j], j, lpred_mode, loglFunc, loglFunc_arg, &ai_par->step_len,
+								      &ai_par->stencil);
+					} else {
+						ll_info[jj] = ll_info[jj + 1] = ll_info[jj + 2] = NAN;
+					}
 				}
 			}
-		}
 
-		int free_if_not_configs = 1;
-		if (misc_output->configs_preopt) {
-			GMRFLib_ai_store_config_preopt(thread_id, misc_output, nhyper, theta_local, log_dens, log_dens_orig, ai_store_id->problem,
-						       mean_corrected, preopt, Qfunc, Qfunc_arg, cpodens_moments, gcpodens_moments, arg_str,
-						       ll_info, lpred_mean, lpred_variance, c_corrected);
-			free_if_not_configs = 0;
-		}
+			int free_if_not_configs = 1;
+			if (misc_output->configs_preopt) {
+				GMRFLib_ai_store_config_preopt(thread_id, misc_output, nhyper, theta_local, log_dens, log_dens_orig, ai_store_id->problem,
+							       mean_corrected, preopt, Qfunc, Qfunc_arg, cpodens_moments, gcpodens_moments, arg_str,
+							       ll_info, lpred_mean, lpred_variance, c_corrected);
+				free_if_not_configs = 0;
+			}
 
-		tu = GMRFLib_timer() - tref;
-		if (ai_par->fp_log) {
+			tu = GMRFLib_timer() - tref;
+			if (ai_par->fp_log) {
 #pragma omp critical (Name_8a7254c4a570078955ae0e221dd0594e23386e57)
-			{
-				fprintf(ai_par->fp_log, "config %2d/%1d=[", config_count++, design->nexperiments);
-				for (int i = 0; i < nhyper; i++) {
-					fprintf(ai_par->fp_log, " %6.3f", z_local[i]);
+				{
+					fprintf(ai_par->fp_log, "config %2d/%1d=[", config_count++, design->nexperiments);
+					for (int i = 0; i < nhyper; i++) {
+						fprintf(ai_par->fp_log, " %6.3f", z_local[i]);
+					}
+					/*
+					 * we need to use the log_dens_orig as the other one is also included the integration weights. 
+					 */
+					fprintf(ai_par->fp_log, " ] log(rel.dens)= %6.3f, [%1d] accept, compute,",
+						log_dens_orig - log_dens_mode, omp_get_thread_num());
+					fprintf(ai_par->fp_log, " %.2fs\n", tu);
 				}
-				/*
-				 * we need to use the log_dens_orig as the other one is also included the integration weights. 
-				 */
-				fprintf(ai_par->fp_log, " ] log(rel.dens)= %6.3f, [%1d] accept, compute,",
-					log_dens_orig - log_dens_mode, omp_get_thread_num());
-				fprintf(ai_par->fp_log, " %.2fs\n", tu);
 			}
-		}
 
-		GMRFLib_free_tabulate_Qfunc(tabQfunc);
-		Free(bnew);
-		Free(z_local);
-		Free(theta_local);
-		if (free_if_not_configs) {
-			// if configs_preopt, then these vectors are store there hence only Free if we do not have configs=TRUE
-			Free(lpred_mean);
-			Free(lpred_variance);
-			Free(cpodens_moments);
-			Free(gcpodens_moments);
+			GMRFLib_free_tabulate_Qfunc(tabQfunc);
+			Free(bnew);
+			Free(z_local);
+			Free(theta_local);
+			if (free_if_not_configs) {
+				// if configs_preopt, then these vectors are store there hence only Free if we do not have configs=TRUE
+				Free(lpred_mean);
+				Free(lpred_variance);
+				Free(cpodens_moments);
+				Free(gcpodens_moments);
+			}
+			Free(mean_corrected);
+			Free(c_corrected);
 		}
-		Free(mean_corrected);
-		Free(c_corrected);
+		GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_INTEGRATE_HYPERPAR, GMRFLib_timer() - tref_chunk, k_last - k_first);
 	}
 
 	if (place_save) {
@@ -2327,55 +2382,60 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 	// merge the two loops into one larger one for better omp
 	GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_COMBINE, NULL, NULL);
 
+	int ncombine = preopt->mnpred + graph->n;
+	for (int ii_first = 0, ii_last = 0; ii_first < ncombine; ii_first = ii_last) {
+		ii_last = GMRFLib_openmp_autotune_next(GMRFLib_OPENMP_PLACES_COMBINE, ii_first, ncombine);
+		double tref_chunk = GMRFLib_timer();
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
-	for (int ii = 0; ii < preopt->mnpred + graph->n; ii++) {
-		int i;
-		if (ii < preopt->mnpred) {
-			i = ii;
-			GMRFLib_density_tp *dens_combine = NULL;
-			if (GMRFLib_save_memory) {
-				// if skewness is to large then it will switch to the default...
-				GMRFLib_density_combine_x(&dens_combine, lpred[i], probs_combine, GMRFLib_DENSITY_TYPE_SKEWNORMAL);
-			} else {
-				GMRFLib_density_combine(&dens_combine, lpred[i], probs_combine);
-			}
-			(*density)[i] = dens_combine;
-
-			for (int k = 0; k < probs_combine->n; k++) {
-				GMRFLib_free_density(lpred[i][k]);
-				lpred[i][k] = NULL;
-			}
-			Free(lpred[i]);
-		} else {
-			i = ii - preopt->mnpred;
-			GMRFLib_density_tp *dens_combine = NULL;
-			if (GMRFLib_save_memory) {
-				// if skewness is to large then it will switch to the default...
-				GMRFLib_density_combine_x(&dens_combine, dens[i], probs, GMRFLib_DENSITY_TYPE_SKEWNORMAL);
+		for (int ii = ii_first; ii < ii_last; ii++) {
+			int i;
+			if (ii < preopt->mnpred) {
+				i = ii;
+				GMRFLib_density_tp *dens_combine = NULL;
+				if (GMRFLib_save_memory) {
+					// if skewness is to large then it will switch to the default...
+					GMRFLib_density_pool_combine(&dens_combine, lpred, i, probs_combine, GMRFLib_DENSITY_TYPE_SKEWNORMAL);
+				} else {
+					GMRFLib_density_pool_combine(&dens_combine, lpred, i, probs_combine, GMRFLib_DENSITY_TYPE_AUTO);
+				}
+				(*density)[i] = dens_combine;
 			} else {
-				GMRFLib_density_combine(&dens_combine, dens[i], probs);
-			}
-			(*density)[ii] = dens_combine;	       /* yes, its 'ii' */
-
-			for (int k = 0; k < probs_combine->n; k++) {
-				GMRFLib_free_density(dens[i][k]);
-				dens[i][k] = NULL;
-			}
-			Free(dens[i]);
-
-			if (tfunc && tfunc[i]) {
-				GMRFLib_density_tp *dens_c = NULL;
-				GMRFLib_density_combine(&dens_c, dens_transform[i], probs_combine);
-				(*density_transform)[i] = dens_c;
+				i = ii - preopt->mnpred;
+				GMRFLib_density_tp *dens_combine = NULL;
+				if (GMRFLib_save_memory) {
+					// if skewness is to large then it will switch to the default...
+					GMRFLib_density_pool_combine(&dens_combine, dens, i, probs, GMRFLib_DENSITY_TYPE_SKEWNORMAL);
+				} else {
+					GMRFLib_density_pool_combine(&dens_combine, dens, i, probs, GMRFLib_DENSITY_TYPE_AUTO);
+				}
+				(*density)[ii] = dens_combine;	       /* yes, its 'ii' */
+
+				if (tfunc && tfunc[i]) {
+					GMRFLib_density_tp *dens_c = NULL;
+					GMRFLib_density_tp **dt = Calloc(dens_max, GMRFLib_density_tp *);
+					GMRFLib_density_tp *dt_views = Calloc(dens_max, GMRFLib_density_tp);
+					for (int kk = 0; kk < probs_combine->n; kk++) {
+						int k = probs_combine->idx[kk];
+						dt[k] = GMRFLib_density_pool_view(&dt_views[k], dens_transform[i], k);
+					}
+					GMRFLib_density_combine(&dens_c, dt, probs_combine);
+					(*density_transform)[i] = dens_c;
+					Free(dt);
+					Free(dt_views);
 
-				for (int k = 0; k < probs_combine->n; k++) {
-					GMRFLib_free_density(dens_transform[i][k]);
-					dens_transform[i][k] = NULL;
+					GMRFLib_density_pool_free(dens_transform[i]);
+					dens_transform[i] = NULL;
 				}
-				Free(dens_transform[i]);
 			}
 		}
+		GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_COMBINE, GMRFLib_timer() - tref_chunk, ii_last - ii_first);
 	}
+	for (int k = 0; k < dens_max; k++) {
+		GMRFLib_density_pool_free(lpred[k]);
+		GMRFLib_density_pool_free(dens[k]);
+		dens[k] = NULL;
+	}
+	Free(lpred);
 
 	if (ai_par->fp_log) {
 		GMRFLib_printMem(ai_par->fp_log);
@@ -2383,21 +2443,20 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 	GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_DEFAULT, NULL, NULL);
 
 	if (dlin && nlin) {
-		GMRFLib_density_tp **dtmp, *dcombine;
-
 		assert(lin_dens);
-		dtmp = Calloc(dens_max, GMRFLib_density_tp *);
+#pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
 		for (int j = 0; j < nlin; j++) {
 			/*
 			 * I need to do this as the storage is wrong.... 
 			 */
+			GMRFLib_density_tp **dtmp = Calloc(dens_max, GMRFLib_density_tp *), *dcombine = NULL;
 			for (int k = 0; k < dens_max; k++) {
 				dtmp[k] = lin_dens[k][j];
 			}
 			GMRFLib_density_combine(&dcombine, dtmp, probs_combine);
 			(*dlin)[j] = dcombine;
+			Free(dtmp);
 		}
-		Free(dtmp);
 
 		if (misc_output && misc_output->compute_corr_lin) {
 			double *ptmp;
@@ -3018,6 +3077,7 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 	Free(stdev_corr_pos);
 	Free(hessian);
 	Free(inverse_hessian);
+	Free(theta_initial);
 	if (H) {
 		gsl_matrix_free(H);
 	}
@@ -3102,23 +3162,15 @@ int GMRFLib_ai_INLA_experimental(GMRFLib_density_tp ***density,
 	Free(hyper_z);
 	Free(hyper_ldens);
 
-	for (int i = 0; i < graph->n; i++) {
-		if (dens[i]) {
-			for (int j = 0; j < dens_max; j++) {
-				GMRFLib_free_density(dens[i][j]);
-			}
-			Free(dens[i]);
-		}
+	for (int k = 0; k < dens_max; k++) {
+		GMRFLib_density_pool_free(dens[k]);
 	}
 	Free(dens);
 
 	if (tfunc) {
 		for (int i = 0; i < graph->n; i++) {
 			if (tfunc[i]) {
-				for (int j = 0; j < dens_max; j++) {
-					GMRFLib_free_density(dens_transform[i][j]);
-				}
-				Free(dens_transform[i]);
+				GMRFLib_density_pool_free(dens_transform[i]);
 			}
 		}
 	}
@@ -4405,9 +4457,26 @@ int GMRFLib_ai_vb_correct_mean(int thread_id, GMRFLib_density_tp ***density,	//
 	}
 }
 
+static int GMRFLib_ai_vb_block_size(int nvb)
+{
+	// the number of vb-nodes to solve for in one multi-rhs solve. use smaller blocks if needed to keep all threads busy
+	int nt = IMAX(1, IMAX(GMRFLib_openmp->max_threads_inner, (omp_get_level() == 0 ? GMRFLib_openmp->max_threads_outer : 1)));
+	return IMAX(1, IMIN(GMRFLib_VB_NRHS_BLOCK, (nvb + nt - 1) / nt));
+}
+
+static int GMRFLib_ai_vb_cov_columns(double *cov, int *idx, int nb, GMRFLib_problem_tp *problem)
+{
+	// cov[, k] = Cov(x, x[idx[k]]) for k = 0...nb-1, column-wise in 'cov', using one multi-rhs solve
+	int n = problem->sub_graph->n;
+	Memset(cov, 0, (size_t) n * nb * sizeof(double));
+	for (int k = 0; k < nb; k++) {
+		cov[k * n + idx[k]] = 1.0;
+	}
+	return GMRFLib_Qsolve_multi(cov, cov, nb, problem, idx);
+}
+
 int GMRFLib_ai_vb_correct_mean_preopt(int thread_id,
-				      GMRFLib_density_tp ***density,
-				      int dens_count,
+				      GMRFLib_density_pool_tp *density,
 				      double *UNUSED(c),
 				      double *d,
 				      GMRFLib_prior_mean_tp **prior_mean,
@@ -4474,8 +4543,8 @@ int GMRFLib_ai_vb_correct_mean_preopt(int thread_id,
 	double *pvar = Calloc_get(preopt->mnpred);
 
 	for (int i = 0; i < graph->n; i++) {
-		if (density[i][dens_count]) {
-			x_mean[i] = density[i][dens_count]->user_mean;
+		if (density) {
+			x_mean[i] = GMRFLib_density_pool_user_mean(density, i);
 		} else {
 			x_mean[i] = ai_store->problem->mean_constr[i];
 		}
@@ -4519,20 +4588,24 @@ int GMRFLib_ai_vb_correct_mean_preopt(int thread_id,
 	gsl_matrix_set_zero(M);
 	gsl_matrix_set_zero(QM);
 
+	// the columns of M are computed for a block of vb-nodes at the time, so the factor is traversed once per block
+	int block_size = GMRFLib_ai_vb_block_size(vb_idx->n);
+	int nblock = (vb_idx->n + block_size - 1) / block_size;
+
 #define CODE_BLOCK							\
-	for (int jj = 0; jj < vb_idx->n; jj++) {			\
-		int j = vb_idx->idx[jj];				\
-		double *b = CODE_BLOCK_WORK_PTR(0);			\
-		double *cov = CODE_BLOCK_WORK_PTR(1);			\
-		CODE_BLOCK_WORK_ZERO(0);				\
-		b[j] = 1.0;						\
-		GMRFLib_Qsolve(cov, b, ai_store->problem, j);		\
+	for (int kb = 0; kb < nblock; kb++) {				\
+		int first = kb * block_size;				\
+		int nb = IMIN(block_size, vb_idx->n - first);		\
+		double *cov = CODE_BLOCK_WORK_PTR(0);			\
+		GMRFLib_ai_vb_cov_columns(cov, vb_idx->idx + first, nb, ai_store->problem); \
 		for (int i = 0; i < graph->n; i++) {			\
-			gsl_matrix_set(M, i, jj, cov[i]);		\
+			for (int jj = 0; jj < nb; jj++) {		\
+				gsl_matrix_set(M, i, first + jj, cov[jj * graph->n + i]); \
+			}						\
 		}							\
 	}
 
-	RUN_CODE_BLOCK(GMRFLib_MAX_THREADS(), 2, graph->n);
+	RUN_CODE_BLOCK(GMRFLib_MAX_THREADS(), 1, block_size * graph->n);
 #undef CODE_BLOCK
 
 	for (int iter = 0; iter < niter; iter++) {
@@ -4748,8 +4821,8 @@ int GMRFLib_ai_vb_correct_mean_preopt(int thread_id,
 	// update the mean unless we're in an emergency
 	if (!emergency) {
 		for (int i = 0; i < graph->n; i++) {
-			if (density[i][dens_count]) {
-				GMRFLib_density_new_user_mean(density[i][dens_count], x_mean[i]);
+			if (density) {
+				GMRFLib_density_pool_new_user_mean(density, i, x_mean[i]);
 			}
 		}
 	}
@@ -4774,8 +4847,7 @@ int GMRFLib_ai_vb_correct_mean_preopt(int thread_id,
 }
 
 int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
-					  GMRFLib_density_tp ***density,
-					  int dens_count,
+					  GMRFLib_density_pool_tp *density,
 					  double *c,
 					  double *d,
 					  GMRFLib_ai_param_tp *ai_par,
@@ -4831,7 +4903,7 @@ int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
 
 #pragma omp simd
 	for (int i = 0; i < graph->n; i++) {
-		x_mean[i] = (density[i][dens_count] ? density[i][dens_count]->user_mean : ai_store->problem->mean_constr[i]);
+		x_mean[i] = (density ? GMRFLib_density_pool_user_mean(density, i) : ai_store->problem->mean_constr[i]);
 	}
 	Memcpy(mean_constr, ai_store->problem->mean_constr, graph->n * sizeof(double));
 
@@ -4912,6 +4984,10 @@ int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
 		cov_latent_store[ii] = Calloc(graph->n, STORAGE_TP);
 	}
 
+	// the columns of cov(latent) are computed for a block of vb-nodes at the time
+	int block_size = GMRFLib_ai_vb_block_size(vb_idx->n);
+	int nblock = (vb_idx->n + block_size - 1) / block_size;
+
 	double diff_sigma_max = 0.0;
 	double diff_sigma_max_limit = 0.005;
 	GMRFLib_problem_tp *problem = NULL;
@@ -5012,7 +5088,7 @@ int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
 		}
 
 		GMRFLib_idxval_tp **A = NULL;
-		if (preopt->pA_idxval) {
+		if (preopt->mpred) {
 			A = preopt->pAA_idxval;
 		} else {
 			A = preopt->A_idxval;
@@ -5023,41 +5099,36 @@ int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
 //#define COV_ETA_LATENT(value_, k_, cov_latent_) (value_) = GMRFLib_dot_product(A[k_], cov_latent_)
 #define COV_ETA_LATENT(value_, k_, cov_latent_) GMRFLib_dot_product_INLINE(value_, A[k_], cov_latent_)
 
-#define COMPUTE_COV_LATENT(cov_latent_, j_, b_)				\
-		if (1) {						\
-			int _j = j_;					\
-			Memset(b_, 0, graph->n * sizeof(double));	\
-			b_[_j] = 1.0;					\
-			GMRFLib_Qsolve(cov_latent_, b_, problem, _j);	\
-		}
-
 		if (enable_tref_a) {
 			tref_a[2] -= GMRFLib_timer();
 		}
 
 #define CODE_BLOCK							\
-		for (int ii = 0; ii < vb_idx->n; ii++) {		\
-			int i = vb_idx->idx[ii];			\
-			double *cov_latent_i = CODE_BLOCK_WORK_PTR(0);	\
-			double *b_i = CODE_BLOCK_WORK_PTR(1);		\
-			COMPUTE_COV_LATENT(cov_latent_i, i, b_i);	\
+		for (int kb = 0; kb < nblock; kb++) {			\
+			int first = kb * block_size;			\
+			int nb = IMIN(block_size, vb_idx->n - first);	\
+			double *cov_latent = CODE_BLOCK_WORK_PTR(0);	\
+			GMRFLib_ai_vb_cov_columns(cov_latent, vb_idx->idx + first, nb, problem); \
 									\
-			if (storage_is_double) {			\
-				Memcpy(cov_latent_store[ii], cov_latent_i, graph->n * sizeof(double)); \
-			} else {					\
-				for(int k = 0; k < graph->n; k++) {	\
-					cov_latent_store[ii][k] = (typeof(STORAGE_TP)) cov_latent_i[k];	\
+			for (int ii = first; ii < first + nb; ii++) {	\
+				double *cov_latent_i = cov_latent + (ii - first) * graph->n; \
+				if (storage_is_double) {		\
+					Memcpy(cov_latent_store[ii], cov_latent_i, graph->n * sizeof(double)); \
+				} else {				\
+					for(int k = 0; k < graph->n; k++) { \
+						cov_latent_store[ii][k] = (typeof(STORAGE_TP)) cov_latent_i[k];	\
+					}				\
 				}					\
-			}						\
 									\
-			STORAGE_TP *cov_eta_latent_i = cov_eta_latent_store[ii]; \
-			for (int kk = 0; kk < d_idx->n; kk++) {		\
-				int k = d_idx->idx[kk];			\
-				COV_ETA_LATENT(cov_eta_latent_i[kk], k, cov_latent_i); \
+				STORAGE_TP *cov_eta_latent_i = cov_eta_latent_store[ii]; \
+				for (int kk = 0; kk < d_idx->n; kk++) {	\
+					int k = d_idx->idx[kk];		\
+					COV_ETA_LATENT(cov_eta_latent_i[kk], k, cov_latent_i); \
+				}					\
 			}						\
 		}
 
-		RUN_CODE_BLOCK(GMRFLib_MAX_THREADS(), 2, graph->n);
+		RUN_CODE_BLOCK(GMRFLib_MAX_THREADS(), 1, block_size * graph->n);
 #undef CODE_BLOCK
 
 		if (enable_tref_a) {
@@ -5230,8 +5301,8 @@ int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
 		ai_store->problem = problem;
 		Memcpy(problem->mean_constr, mean_constr, graph->n * sizeof(double));
 		for (int i = 0; i < graph->n; i++) {
-			if (density[i][dens_count]) {
-				GMRFLib_density_new_user_stdev(density[i][dens_count], sd_prev[i]);
+			if (density) {
+				GMRFLib_density_pool_new_user_stdev(density, i, sd_prev[i]);
 			}
 		}
 	}
@@ -5422,6 +5493,7 @@ int GMRFLib_ai_store_config_preopt(int thread_id, GMRFLib_ai_misc_output_tp *mo,
 
 		mo->configs_preopt[id]->A = preopt->A;
 		mo->configs_preopt[id]->pA = preopt->pA;
+		mo->configs_preopt[id]->pA_mmap = preopt->pA_mmap;
 		GMRFLib_duplicate_constr(&(mo->configs_preopt[id]->constr), preopt->latent_constr, preopt->preopt_graph);
 
 		int *i, *j, ii, jj, k, kk;
@@ -5550,6 +5622,18 @@ int GMRFLib_ai_store_config_preopt(int thread_id, GMRFLib_ai_misc_output_tp *mo,
 		cfg->theta = NULL;
 	}
 	cfg->arg_str = arg_str;
+
+	if (mo->configs_stream) {
+		// the configuration is finished, so compress and write it out now and keep only its index
+		cfg->chunk = Calloc(1, GMRFLib_cstream_chunk_tp);
+		GMRFLib_cstream_write(mo->configs_stream, cfg->chunk, g->n, mo->configs_preopt[id]->nz, mo->configs_preopt[id]->prior_nz,
+				      cfg->mean, cfg->improved_mean, cfg->Q, cfg->Qinv, cfg->Qprior);
+		Free(cfg->mean);
+		Free(cfg->improved_mean);
+		Free(cfg->Q);
+		Free(cfg->Qinv);
+		Free(cfg->Qprior);
+	}
 	mo->configs_preopt[id]->nconfig++;
 
 	return GMRFLib_SUCCESS;
@@ -6828,8 +6912,14 @@ GMRFLib_ai_store_tp *GMRFLib_duplicate_ai_store(GMRFLib_ai_store_tp *ai_store, i
 	DUPLICATE(correction_term, n, double, skeleton);
 	DUPLICATE(derivative3, n, double, skeleton);
 	DUPLICATE(derivative4, n, double, skeleton);
-	DUPLICATE(correction_idx, n, int, skeleton);
-	new_ai_store->d_idx = GMRFLib_idx_duplicate(ai_store->d_idx);
+	if (copy_ptr) {
+		// these do not change, so they are shared and reference counted
+		new_ai_store->correction_idx = (skeleton ? NULL : GMRFLib_shared_ref(ai_store->correction_idx));
+		new_ai_store->d_idx = GMRFLib_shared_ref(ai_store->d_idx);
+	} else {
+		DUPLICATE(correction_idx, n, int, skeleton);
+		new_ai_store->d_idx = GMRFLib_idx_duplicate(ai_store->d_idx);
+	}
 
 	char *tmp = Calloc(1, char);
 	Free(tmp);
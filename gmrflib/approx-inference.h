@@ -40,6 +40,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/config-stream.h"
 
 #undef __BEGIN_DECLS
 #undef __END_DECLS
@@ -132,6 +133,11 @@ typedef enum {
 				      ((v_) == GMRFLib_VB_HESSIAN_STRATEGY_PARTIAL ? "partial" : \
 				       ((v_) == GMRFLib_VB_HESSIAN_STRATEGY_DIAGONAL ? "diagonal" : "invalid")))
 
+/*
+ * max number of rhs's in each of the multi-rhs solves in the VB corrections
+ */
+#define GMRFLib_VB_NRHS_BLOCK (16)
+
 typedef enum {
 
 	/**
@@ -601,6 +607,15 @@ typedef struct {
 	int parallel_linesearch;
 	int fixed_mode;
 	int hessian_correct_skewness_only;
+
+	/**
+	 * \brief A known Hessian (nhyper x nhyper) from a previous fit, with the initial values as its mode.
+	 *
+	 * If the mode has moved less than hessian_known_tol from the initial values, measured in the metric of hessian_known,
+	 * then hessian_known is used instead of estimating the Hessian again.
+	 */
+	double *hessian_known;
+	double hessian_known_tol;
 } GMRFLib_ai_param_tp;
 
 /**
@@ -933,6 +948,7 @@ typedef struct {
 	double *lpred_mean;
 	double *lpred_variance;
 	char **arg_str;
+	GMRFLib_cstream_chunk_tp *chunk;		       /* if streamed: mean, improved_mean, Q, Qinv and Qprior are here */
 } GMRFLib_store_config_preopt_tp;
 
 typedef struct {
@@ -954,6 +970,7 @@ typedef struct {
 	GMRFLib_store_config_preopt_tp **config;	       /* the configurations */
 	GMRFLib_matrix_tp *A;
 	GMRFLib_matrix_tp *pA;
+	GMRFLib_matrix_mmap_tp *pA_mmap;		       /* if pA is memory-mapped, then pA = NULL */
 } GMRFLib_store_configs_preopt_tp;
 
 typedef struct {
@@ -1001,6 +1018,7 @@ typedef struct {
 	int config_lite;
 	GMRFLib_store_configs_tp **configs;		       /* configs[id][...] */
 	GMRFLib_store_configs_preopt_tp **configs_preopt;      /* configs[id][...] */
+	GMRFLib_cstream_tp *configs_stream;		       /* if non-NULL, stream the configurations compressed to file */
 
 	int likelihood_info;
 	char **warnings;
@@ -1229,8 +1247,7 @@ int GMRFLib_ai_vb_correct_mean_std(int thread_id, GMRFLib_density_tp *** density
 				   GMRFLib_ai_store_tp * ai_store,
 				   GMRFLib_graph_tp * graph,
 				   GMRFLib_Qfunc_tp * Qfunc, void *Qfunc_arg, GMRFLib_logl_tp * loglFunc, void *loglFunc_arg);
-int GMRFLib_ai_vb_correct_mean_preopt(int thread_id, GMRFLib_density_tp *** density,
-				      int dens_count,
+int GMRFLib_ai_vb_correct_mean_preopt(int thread_id, GMRFLib_density_pool_tp * density,
 				      double *c,
 				      double *d,
 				      GMRFLib_prior_mean_tp ** prior_mean,
@@ -1240,8 +1257,7 @@ int GMRFLib_ai_vb_correct_mean_preopt(int thread_id, GMRFLib_density_tp *** dens
 				      GMRFLib_Qfunc_tp * Qfunc, void *Qfunc_arg, GMRFLib_logl_tp * loglFunc, void *loglFunc_arg,
 				      GMRFLib_preopt_tp * preopt, GMRFLib_idx_tp * d_idx);
 int GMRFLib_ai_vb_correct_variance_preopt(int thread_id,
-					  GMRFLib_density_tp *** density,
-					  int dens_count,
+					  GMRFLib_density_pool_tp * density,
 					  double *UNUSED(c),
 					  double *d,
 					  GMRFLib_ai_param_tp * ai_par,
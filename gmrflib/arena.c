@@ -0,0 +1,258 @@
+
+/* arena.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+/*
+ * Per-thread arenas for workspaces. RUN_CODE_BLOCK and Calloc_init() allocate their (zeroed) workspace on entry and release it on exit,
+ * and this is done within loops over theta and over the iterations. With many threads, calloc() and free() of large blocks then
+ * contend for the same locks, and the pages are new and have to be faulted in each time. Here each thread keeps its own stack of
+ * blocks, which are reused, so an allocation is just a pointer increment and a memset() of memory that is already mapped.
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/arena.h"
+
+static GMRFLib_arena_tp *arena = NULL;
+#pragma omp threadprivate(arena)
+
+// all arenas, for the report
+static GMRFLib_arena_tp **arena_all = NULL;
+static int arena_nall = 0;
+
+static GMRFLib_arena_tp *arena_get(void)
+{
+	if (!arena) {
+		arena = Calloc(1, GMRFLib_arena_tp);
+		arena->cur = -1;
+#pragma omp critical (Name_48f86ade8bc9d005d4bdbcb77e1e66b4e3ad048d)
+		{
+			arena_all = Realloc(arena_all, arena_nall + 1, GMRFLib_arena_tp *);
+			arena_all[arena_nall++] = arena;
+		}
+	}
+	return arena;
+}
+
+static void arena_add_block(GMRFLib_arena_tp * a, size_t bytes)
+{
+	size_t size = GMRFLib_ARENA_BLOCK_MIN;
+	if (a->nblock > 0) {
+		size = 2 * a->block[a->nblock - 1].size;
+	}
+	size = (bytes > size ? bytes : size);
+
+	GMRFLib_arena_block_tp *b = NULL;
+	a->block = Realloc(a->block, a->nblock + 1, GMRFLib_arena_block_tp);
+	b = &(a->block[a->nblock++]);
+	b->raw = Malloc(size + GMRFLib_L1_CACHELINE, char);
+	b->mem = (char *) (((uintptr_t) b->raw + GMRFLib_L1_CACHELINE - 1) & ~((uintptr_t) GMRFLib_L1_CACHELINE - 1));
+	b->size = size;
+	b->used = 0;
+	a->reserved += size;
+}
+
+static size_t arena_keep_max(void)
+{
+	// the max to keep in each arena, so that all arenas together keep at most GMRFLib_ARENA_KEEP_MAX
+	size_t keep = (size_t) GMRFLib_ARENA_KEEP_MAX / (size_t) IMAX(1, GMRFLib_MAX_THREADS());
+	return (keep > (size_t) GMRFLib_ARENA_BLOCK_MIN ? keep : (size_t) GMRFLib_ARENA_BLOCK_MIN);
+}
+
+static void arena_trim(GMRFLib_arena_tp * a)
+{
+	// when the arena is empty and there is more than one block, or more than we want to keep, replace them with one, so the next
+	// time the memory is in one piece
+	if (a->nrec > 0 || a->nblock == 0) {
+		return;
+	}
+
+	size_t keep = arena_keep_max();
+	if (a->nblock == 1 && a->reserved <= keep) {
+		return;
+	}
+
+	size_t size = (a->reserved < keep ? a->reserved : keep);
+	for (int i = 0; i < a->nblock; i++) {
+		Free(a->block[i].raw);
+	}
+	Free(a->block);
+	a->nblock = 0;
+	a->cur = -1;
+	a->reserved = 0;
+	arena_add_block(a, size);
+}
+
+static void arena_pop(GMRFLib_arena_tp * a)
+{
+	// pop the released allocations off the top of the stack
+	while (a->nrec > 0 && a->rec[a->nrec - 1].freed) {
+		GMRFLib_arena_rec_tp *r = &(a->rec[--(a->nrec)]);
+		if (r->block >= 0) {
+			a->in_use -= a->block[r->block].used - r->used;
+			a->block[r->block].used = r->used;
+			a->cur = r->cur;
+		}
+	}
+	arena_trim(a);
+}
+
+void *GMRFLib_arena_calloc(size_t nmemb, size_t size, const char *file, const char *funcname, int lineno)
+{
+	// as GMRFLib_calloc(), but the memory must be released with GMRFLib_arena_free() (or GMRFLib_arena_release()) by the same thread
+
+	if (!GMRFLib_arena_enable) {
+		return GMRFLib_calloc(nmemb, size, file, funcname, lineno);
+	}
+
+	GMRFLib_arena_tp *a = arena_get();
+	size_t bytes = (nmemb * size > 0 ? nmemb * size : 1);
+	bytes = (bytes + GMRFLib_L1_CACHELINE - 1) & ~((size_t) GMRFLib_L1_CACHELINE - 1);
+
+	if (a->nrec == a->nrec_alloc) {
+		a->nrec_alloc = IMAX(16, 2 * a->nrec_alloc);
+		a->rec = Realloc(a->rec, a->nrec_alloc, GMRFLib_arena_rec_tp);
+	}
+	GMRFLib_arena_rec_tp *r = &(a->rec[a->nrec++]);
+	r->freed = 0;
+	r->cur = a->cur;
+
+	if (bytes > (size_t) GMRFLib_ARENA_REQUEST_MAX) {
+		r->block = -1;
+		r->used = 0;
+		r->ptr = GMRFLib_calloc(nmemb, size, file, funcname, lineno);
+		a->nfallback++;
+		return r->ptr;
+	}
+
+	int b = IMAX(0, a->cur);
+	while (b < a->nblock && a->block[b].used + bytes > a->block[b].size) {
+		b++;
+	}
+	if (b == a->nblock) {
+		arena_add_block(a, bytes);
+	}
+
+	GMRFLib_arena_block_tp *blk = &(a->block[b]);
+	r->block = b;
+	r->used = blk->used;
+	r->ptr = blk->mem + blk->used;
+	blk->used += bytes;
+	a->cur = b;
+
+	a->in_use += bytes;
+	a->high_water = (a->in_use > a->high_water ? a->in_use : a->high_water);
+	a->served += (double) bytes;
+	a->nalloc++;
+
+	Memset(r->ptr, 0, bytes);
+	return r->ptr;
+}
+
+int GMRFLib_arena_free(void *ptr)
+{
+	if (!ptr) {
+		return GMRFLib_SUCCESS;
+	}
+
+	GMRFLib_arena_tp *a = arena;
+	int k = -1;
+	if (a) {
+		for (k = a->nrec - 1; k >= 0; k--) {
+			if (a->rec[k].ptr == ptr) {
+				break;
+			}
+		}
+	}
+	if (k < 0) {
+		// not from this arena, then it is from GMRFLib_calloc() when the arena was disabled
+		Free(ptr);
+		return GMRFLib_SUCCESS;
+	}
+
+	if (a->rec[k].block < 0) {
+		Free(a->rec[k].ptr);
+	}
+	a->rec[k].freed = 1;
+	arena_pop(a);
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_arena_mark(void)
+{
+	// return a mark of the current position. all allocations done after this are released by GMRFLib_arena_release(mark)
+	return arena_get()->nrec;
+}
+
+int GMRFLib_arena_release(int mark)
+{
+	GMRFLib_arena_tp *a = arena;
+	if (!a) {
+		return GMRFLib_SUCCESS;
+	}
+
+	for (int k = IMAX(0, mark); k < a->nrec; k++) {
+		if (!a->rec[k].freed && a->rec[k].block < 0) {
+			Free(a->rec[k].ptr);
+		}
+		a->rec[k].freed = 1;
+	}
+	arena_pop(a);
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_arena_report(FILE * fp)
+{
+	// report bytes served and the high-water marks of the arenas. the counters of the other threads are read without locking
+	fp = (fp ? fp : stdout);
+
+	double served = 0.0;
+	size_t nalloc = 0, nfallback = 0, reserved = 0, high_water = 0, high_water_max = 0;
+
+#pragma omp critical (Name_48f86ade8bc9d005d4bdbcb77e1e66b4e3ad048d)
+	{
+		for (int i = 0; i < arena_nall; i++) {
+			GMRFLib_arena_tp *a = arena_all[i];
+			served += a->served;
+			nalloc += a->nalloc;
+			nfallback += a->nfallback;
+			reserved += a->reserved;
+			high_water += a->high_water;
+			high_water_max = (a->high_water > high_water_max ? a->high_water : high_water_max);
+		}
+	}
+
+	double Mb = 1.0 / (1024.0 * 1024.0);
+	fprintf(fp, "\nArena: threads=%1d allocations=%zu (%zu to calloc) served=%.1fMb\n", arena_nall, nalloc, nfallback, served * Mb);
+	fprintf(fp, "\thigh-water=%.1fMb (max %.1fMb per thread) reserved=%.1fMb\n", high_water * Mb, high_water_max * Mb, reserved * Mb);
+
+	return GMRFLib_SUCCESS;
+}
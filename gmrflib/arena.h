@@ -0,0 +1,107 @@
+
+/* arena.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file arena.h
+  \brief Typedefs for \ref arena.c
+*/
+
+#ifndef __GMRFLib_ARENA_H__
+#define __GMRFLib_ARENA_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+/*
+ * the smallest block to allocate, the max that is kept by all arenas together when they are empty (divided evenly between the
+ * threads), and requests larger than this go directly to calloc()
+ */
+#define GMRFLib_ARENA_BLOCK_MIN (1024L * 1024L)
+#define GMRFLib_ARENA_KEEP_MAX (256L * 1024L * 1024L)
+#define GMRFLib_ARENA_REQUEST_MAX (1024L * 1024L * 1024L)
+
+typedef struct {
+	char *raw;					       /* as from malloc() */
+	char *mem;					       /* aligned at GMRFLib_L1_CACHELINE */
+	size_t size;
+	size_t used;
+} GMRFLib_arena_block_tp;
+
+typedef struct {
+	void *ptr;
+	int block;					       /* -1 if from calloc() */
+	int freed;
+	int cur;					       /* current block before this one */
+	size_t used;					       /* used in 'block' before this one */
+} GMRFLib_arena_rec_tp;
+
+/*
+ * one arena for each thread, which is a stack of blocks. allocations are released in reverse order; if not, the memory is reclaimed
+ * when those on top are released.
+ */
+typedef struct {
+	int nblock;
+	int cur;
+	GMRFLib_arena_block_tp *block;
+
+	int nrec;
+	int nrec_alloc;
+	GMRFLib_arena_rec_tp *rec;
+
+	size_t in_use;					       /* bytes */
+	size_t high_water;				       /* bytes */
+	size_t reserved;				       /* bytes */
+	double served;					       /* bytes, accumulated */
+	size_t nalloc;
+	size_t nfallback;				       /* number of requests passed on to calloc() */
+} GMRFLib_arena_tp;
+
+int GMRFLib_arena_free(void *ptr);
+int GMRFLib_arena_mark(void);
+int GMRFLib_arena_release(int mark);
+int GMRFLib_arena_report(FILE * fp);
+void *GMRFLib_arena_calloc(size_t nmemb, size_t size, const char *file, const char *funcname, int lineno);
+
+__END_DECLS
+#endif
@@ -0,0 +1,689 @@
+
+/* bench.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+/*
+ * Kernel benchmarks. With 'inla -m bench' we build a fixed set of synthetic graphs at several sizes and time the numerical kernels on
+ * them for each available sparse solver: reordering, the first (symbolic and numeric) and repeated (numeric) factorisation, solves
+ * with 1 and k right hand sides, Qinv, Qx, the tabulation of a Qfunc and the idxval dot product. The graphs are generated with a
+ * fixed seed, so results from different releases on the same host can be compared to catch performance regressions.
+ *
+ * The results are written one line per (graph, solver, kernel) as whitespace separated columns, with '#' for comments:
+ *
+ *     graph size n nnz smtp kernel nrep median min
+ *
+ * where the times are in seconds and 'nnz' is the number of off-diagonal non-zeros in the graph.
+ *
+ * Model benchmarks. With 'inla -m benchmodel Model.ini' the model is fitted as usual, and then the wall time of each phase (parse,
+ * build, optimise, hessian, integrate, combine and output), the peak RSS and the number of factorisations are appended to the
+ * results file as lines of
+ *
+ *     model metric value
+ *
+ * where 'model' is the name of the directory containing the ini-file. The results file is $INLA_BENCH_RESULTS, or 'bench-model.txt' in
+ * the results directory. If $INLA_BENCH_BASELINE is set, the results are compared with the last entries for the same model in that
+ * file, and a metric is a regression if it exceeds the baseline with more than the relative tolerance $INLA_BENCH_TOL (default
+ * GMRFLib_BENCH_TOL) plus a small absolute slack, so that the short phases are not dominated by noise.
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/bench.h"
+
+/*
+ * number of repetitions for each kernel; we report the median and the minimum
+ */
+#define BENCH_NREP (7)
+
+/*
+ * number of right hand sides for the multi-rhs solve
+ */
+#define BENCH_NRHS (16)
+
+/*
+ * skip the band-solver if the band would need more than this number of doubles
+ */
+#define BENCH_BAND_MAX ((size_t) 1 << 25)
+
+typedef enum {
+	BENCH_LATTICE = 0,
+	BENCH_MESH,
+	BENCH_AR1,
+	BENCH_RW2,
+	BENCH_GROUP_MESH
+} bench_graph_tp;
+
+typedef struct {
+	FILE *fp;
+	int verbose;
+	const char *gname;
+	const char *size;
+	GMRFLib_graph_tp *graph;
+	const char *smtp;
+} bench_ctx_tp;
+
+static unsigned int bench_rand(unsigned int *state)
+{
+	/*
+	 * xorshift32. we do not want to depend on the state of the global RNG, so the graphs are the same for every run
+	 */
+	unsigned int x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+static double bench_Qfunc(int UNUSED(thread_id), int i, int j, double *UNUSED(values), void *arg)
+{
+	if (j < 0) {
+		return NAN;
+	}
+
+	/*
+	 * diagonal dominant, so its positive definite for any graph
+	 */
+	GMRFLib_graph_tp *g = (GMRFLib_graph_tp *) arg;
+	return (i == j ? g->nnbs[i] + 1.0 : -1.0);
+}
+
+static GMRFLib_graph_tp *bench_mk_mesh(int m, unsigned int seed)
+{
+	/*
+	 * a planar triangulation of a m x m grid, with a random diagonal in each cell
+	 */
+	GMRFLib_ged_tp *ged = NULL;
+	GMRFLib_graph_tp *g = NULL;
+	unsigned int state = seed;
+
+	GMRFLib_ged_init2(&ged, m * m);
+	for (int irow = 0; irow < m; irow++) {
+		for (int icol = 0; icol < m; icol++) {
+			int node = irow * m + icol;
+			if (icol + 1 < m) {
+				GMRFLib_ged_add(ged, node, node + 1);
+			}
+			if (irow + 1 < m) {
+				GMRFLib_ged_add(ged, node, node + m);
+			}
+			if (icol + 1 < m && irow + 1 < m) {
+				if (bench_rand(&state) & 1U) {
+					GMRFLib_ged_add(ged, node, node + m + 1);
+				} else {
+					GMRFLib_ged_add(ged, node + 1, node + m);
+				}
+			}
+		}
+	}
+	GMRFLib_ged_build(&g, ged);
+	GMRFLib_ged_free(ged);
+
+	return g;
+}
+
+static GMRFLib_graph_tp *bench_mk_graph(bench_graph_tp gtype, int size)
+{
+	/*
+	 * the size-argument is the number of nodes along each side for the spatial graphs, and the length for the chains
+	 */
+	GMRFLib_graph_tp *g = NULL;
+
+	switch (gtype) {
+	case BENCH_LATTICE:
+		GMRFLib_graph_mk_lattice(&g, size, size, 1, 1, 0);
+		break;
+
+	case BENCH_MESH:
+		g = bench_mk_mesh(size, 20240601U);
+		break;
+
+	case BENCH_AR1:
+		GMRFLib_graph_mk_linear(&g, size, 1, 0);
+		break;
+
+	case BENCH_RW2:
+		GMRFLib_graph_mk_linear(&g, size, 2, 0);
+		break;
+
+	case BENCH_GROUP_MESH:
+	{
+		/*
+		 * AR1 (group) x mesh (space), with 10 groups, as the graph for a kronecker product
+		 */
+		const int ngroup = 10;
+		GMRFLib_graph_tp *space = bench_mk_mesh(size, 20240601U);
+		GMRFLib_ged_tp *ged = NULL;
+		int ns = space->n;
+
+		GMRFLib_ged_init2(&ged, ngroup * ns);
+		for (int k = 0; k < ngroup; k++) {
+			GMRFLib_ged_insert_graph(ged, space, k * ns);
+			if (k > 0) {
+				GMRFLib_ged_insert_graph2(ged, space, (k - 1) * ns, k * ns);
+			}
+		}
+		GMRFLib_ged_build(&g, ged);
+		GMRFLib_ged_free(ged);
+		GMRFLib_graph_free(space);
+	}
+		break;
+
+	default:
+		GMRFLib_ASSERT_RETVAL(0 == 1, GMRFLib_ESNH, NULL);
+		break;
+	}
+
+	return g;
+}
+
+static void bench_report(bench_ctx_tp *ctx, const char *kernel, double *t, int nrep)
+{
+	qsort((void *) t, (size_t) nrep, sizeof(double), GMRFLib_dcmp);
+	fprintf(ctx->fp, "%-10s %-6s %8d %9d %-7s %-17s %2d %.6e %.6e\n", ctx->gname, ctx->size, ctx->graph->n, ctx->graph->nnz, ctx->smtp,
+		kernel, nrep, t[nrep / 2], t[0]);
+	fflush(ctx->fp);
+	if (ctx->verbose && ctx->fp != stdout) {
+		printf("\t%-10s %-6s %-7s %-17s %.6e\n", ctx->gname, ctx->size, ctx->smtp, kernel, t[nrep / 2]);
+	}
+}
+
+static int bench_release_numeric(GMRFLib_sm_fact_tp *sm_fact, supernodal_factor_matrix *symb, GMRFLib_taucs_cache_tp *cache)
+{
+	/*
+	 * release the numerical factorisation only, so the next factorisation is a numerical one, which is the common case while
+	 * running INLA. with PARDISO, the build and the factorisation replace the old ones.
+	 */
+	switch (sm_fact->smtp) {
+	case GMRFLib_SMTP_BAND:
+		GMRFLib_free_fact_sparse_matrix(sm_fact);
+		break;
+
+	case GMRFLib_SMTP_TAUCS:
+		GMRFLib_free_fact_sparse_matrix(sm_fact);
+		sm_fact->TAUCS_symb_fact = GMRFLib_sm_fact_duplicate_TAUCS(symb);
+		sm_fact->TAUCS_cache = GMRFLib_taucs_cache_duplicate(cache);
+		break;
+
+	default:
+		break;
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+static int bench_sparse(bench_ctx_tp *ctx, GMRFLib_smtp_tp smtp)
+{
+	int n = ctx->graph->n, thread_id = 0;
+	double t[BENCH_NREP];
+	GMRFLib_graph_tp *graph = ctx->graph;
+	GMRFLib_sm_fact_tp sm_fact;
+
+	ctx->smtp = GMRFLib_SMTP_NAME(smtp);
+
+	/*
+	 * reordering
+	 */
+	for (int r = 0; r < BENCH_NREP; r++) {
+		memset((void *) &sm_fact, 0, sizeof(GMRFLib_sm_fact_tp));
+		sm_fact.smtp = smtp;
+		t[r] = -GMRFLib_timer();
+		GMRFLib_compute_reordering(&sm_fact, graph, NULL);
+		t[r] += GMRFLib_timer();
+		if (r < BENCH_NREP - 1) {
+			GMRFLib_free_fact_sparse_matrix(&sm_fact);
+			GMRFLib_free_reordering(&sm_fact);
+		}
+	}
+	bench_report(ctx, "reorder", t, BENCH_NREP);
+
+	if (smtp == GMRFLib_SMTP_BAND && (size_t) (sm_fact.bandwidth + 1) * (size_t) n > BENCH_BAND_MAX) {
+		fprintf(ctx->fp, "# %s %s: skip band, bandwidth %1d is too large\n", ctx->gname, ctx->size, sm_fact.bandwidth);
+		GMRFLib_free_reordering(&sm_fact);
+		return GMRFLib_SUCCESS;
+	}
+
+	/*
+	 * the first factorisation includes the symbolic one for TAUCS. we keep a copy of the symbolic factorisation to reuse it.
+	 */
+	GMRFLib_build_sparse_matrix(thread_id, &sm_fact, bench_Qfunc, (void *) graph, graph);
+	t[0] = -GMRFLib_timer();
+	GMRFLib_factorise_sparse_matrix(&sm_fact, graph);
+	t[0] += GMRFLib_timer();
+	bench_report(ctx, "factorise-first", t, 1);
+
+	supernodal_factor_matrix *symb = NULL;
+	GMRFLib_taucs_cache_tp *cache = NULL;
+	if (smtp == GMRFLib_SMTP_TAUCS) {
+		symb = GMRFLib_sm_fact_duplicate_TAUCS(sm_fact.TAUCS_symb_fact);
+		cache = GMRFLib_taucs_cache_duplicate(sm_fact.TAUCS_cache);
+	}
+
+	double tb[BENCH_NREP];
+	for (int r = 0; r < BENCH_NREP; r++) {
+		bench_release_numeric(&sm_fact, symb, cache);
+		tb[r] = -GMRFLib_timer();
+		GMRFLib_build_sparse_matrix(thread_id, &sm_fact, bench_Qfunc, (void *) graph, graph);
+		tb[r] += GMRFLib_timer();
+		t[r] = -GMRFLib_timer();
+		GMRFLib_factorise_sparse_matrix(&sm_fact, graph);
+		t[r] += GMRFLib_timer();
+	}
+	bench_report(ctx, "build", tb, BENCH_NREP);
+	bench_report(ctx, "factorise", t, BENCH_NREP);
+
+	if (symb) {
+		GMRFLib_free_fact_sparse_matrix_TAUCS(NULL, NULL, symb);
+		GMRFLib_taucs_cache_free(cache);
+	}
+
+	/*
+	 * solves with 1 and BENCH_NRHS right hand sides
+	 */
+	double *rhs = Calloc(n * BENCH_NRHS, double);
+	for (int r = 0; r < BENCH_NREP; r++) {
+		GMRFLib_fill(n, 1.0, rhs);
+		t[r] = -GMRFLib_timer();
+		GMRFLib_solve_llt_sparse_matrix(rhs, 1, &sm_fact, graph);
+		t[r] += GMRFLib_timer();
+	}
+	bench_report(ctx, "solve-1", t, BENCH_NREP);
+
+	for (int r = 0; r < BENCH_NREP; r++) {
+		GMRFLib_fill(n * BENCH_NRHS, 1.0, rhs);
+		t[r] = -GMRFLib_timer();
+		GMRFLib_solve_llt_sparse_matrix(rhs, BENCH_NRHS, &sm_fact, graph);
+		t[r] += GMRFLib_timer();
+	}
+	char kname[32];
+	snprintf(kname, sizeof(kname), "solve-%1d", BENCH_NRHS);
+	bench_report(ctx, kname, t, BENCH_NREP);
+	Free(rhs);
+
+	GMRFLib_free_fact_sparse_matrix(&sm_fact);
+	GMRFLib_free_reordering(&sm_fact);
+
+	/*
+	 * Qinv goes through the problem interface, which use the global choice of solver
+	 */
+	GMRFLib_smtp_tp smtp_save = GMRFLib_smtp;
+	GMRFLib_problem_tp *problem = NULL;
+
+	GMRFLib_smtp = smtp;
+	GMRFLib_init_problem(thread_id, &problem, NULL, NULL, NULL, NULL, graph, bench_Qfunc, (void *) graph, NULL);
+	for (int r = 0; r < BENCH_NREP; r++) {
+		GMRFLib_free_Qinv(problem);
+		t[r] = -GMRFLib_timer();
+		GMRFLib_Qinv(problem);
+		t[r] += GMRFLib_timer();
+	}
+	bench_report(ctx, "Qinv", t, BENCH_NREP);
+	GMRFLib_free_problem(problem);
+	GMRFLib_smtp = smtp_save;
+
+	return GMRFLib_SUCCESS;
+}
+
+static int bench_generic(bench_ctx_tp *ctx)
+{
+	/*
+	 * the kernels that do not depend on the sparse solver
+	 */
+	int n = ctx->graph->n, thread_id = 0;
+	double t[BENCH_NREP];
+	GMRFLib_graph_tp *graph = ctx->graph;
+
+	ctx->smtp = "-";
+
+	double *x = Calloc(2 * n, double);
+	double *res = x + n;
+	GMRFLib_fill(n, 1.0, x);
+	for (int r = 0; r < BENCH_NREP; r++) {
+		t[r] = -GMRFLib_timer();
+		GMRFLib_Qx(thread_id, res, x, graph, bench_Qfunc, (void *) graph);
+		t[r] += GMRFLib_timer();
+	}
+	bench_report(ctx, "Qx", t, BENCH_NREP);
+
+	for (int r = 0; r < BENCH_NREP; r++) {
+		GMRFLib_tabulate_Qfunc_tp *tab = NULL;
+		t[r] = -GMRFLib_timer();
+		GMRFLib_tabulate_Qfunc(thread_id, &tab, graph, bench_Qfunc, (void *) graph, NULL);
+		t[r] += GMRFLib_timer();
+		GMRFLib_free_tabulate_Qfunc(tab);
+	}
+	bench_report(ctx, "tabulate-Qfunc", t, BENCH_NREP);
+
+	/*
+	 * the dot product with an idxval over the nodes of every second row of the graph, as blocks of sequential indices is the
+	 * typical case. it is too fast to time a single call, so we time 'nloop' of them.
+	 */
+	GMRFLib_idxval_tp *h = NULL;
+	unsigned int state = 20240601U;
+	const int nloop = 100;
+
+	GMRFLib_idxval_create(&h);
+	for (int i = 0; i < n; i++) {
+		if ((i / 64) % 2 == 0 || (bench_rand(&state) % 8U) == 0) {
+			GMRFLib_idxval_add(&h, i, 1.0 + (double) (i % 7));
+		}
+	}
+	GMRFLib_idxval_prepare(&h, 1, 1);
+
+	double sum = 0.0;
+	for (int r = 0; r < BENCH_NREP; r++) {
+		t[r] = -GMRFLib_timer();
+		for (int k = 0; k < nloop; k++) {
+			sum += GMRFLib_dot_product(h, x);
+		}
+		t[r] += GMRFLib_timer();
+		t[r] /= nloop;
+	}
+	bench_report(ctx, "dot-idxval", t, BENCH_NREP);
+	if (ISNAN(sum)) {
+		fprintf(ctx->fp, "# dot-idxval: sum is NAN\n");
+	}
+
+	GMRFLib_idxval_free(h);
+	Free(x);
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_bench_run(const char *filename, int verbose)
+{
+	const struct {
+		const char *name;
+		bench_graph_tp gtype;
+		int size[3];
+	} cases[] = {
+		{ "lattice", BENCH_LATTICE, { 32, 100, 250 } },
+		{ "mesh", BENCH_MESH, { 32, 100, 250 } },
+		{ "ar1", BENCH_AR1, { 1000, 10000, 100000 } },
+		{ "rw2", BENCH_RW2, { 1000, 10000, 100000 } },
+		{ "group-mesh", BENCH_GROUP_MESH, { 10, 32, 70 } }
+	};
+	const char *size_names[] = { "small", "medium", "large" };
+	const int ncases = (int) (sizeof(cases) / sizeof(cases[0]));
+
+	GMRFLib_smtp_tp smtps[3];
+	int nsmtp = 0;
+	smtps[nsmtp++] = GMRFLib_SMTP_BAND;
+	smtps[nsmtp++] = GMRFLib_SMTP_TAUCS;
+	if (GMRFLib_pardiso_check_install(1, 1) == GMRFLib_SUCCESS) {
+		smtps[nsmtp++] = GMRFLib_SMTP_PARDISO;
+	}
+
+	FILE *fp = stdout;
+	if (filename) {
+		fp = fopen(filename, "w");
+		if (!fp) {
+			GMRFLib_ERROR(GMRFLib_EOPENFILE);
+		}
+	}
+
+	double time_used = -GMRFLib_timer();
+	fprintf(fp, "# INLA kernel benchmark, written by 'inla -m bench'\n");
+	fprintf(fp, "# version = %1d\n", GMRFLib_BENCH_VERSION);
+	fprintf(fp, "# threads = %1d\n", GMRFLib_openmp->max_threads);
+	fprintf(fp, "# columns: graph size n nnz smtp kernel nrep median min\n");
+
+	bench_ctx_tp ctx;
+	memset((void *) &ctx, 0, sizeof(bench_ctx_tp));
+	ctx.fp = fp;
+	ctx.verbose = verbose;
+
+	for (int c = 0; c < ncases; c++) {
+		for (int s = 0; s < 3; s++) {
+			ctx.gname = cases[c].name;
+			ctx.size = size_names[s];
+			ctx.graph = bench_mk_graph(cases[c].gtype, cases[c].size[s]);
+			for (int k = 0; k < nsmtp; k++) {
+				bench_sparse(&ctx, smtps[k]);
+			}
+			bench_generic(&ctx);
+			GMRFLib_graph_free(ctx.graph);
+			ctx.graph = NULL;
+		}
+	}
+
+	time_used += GMRFLib_timer();
+	fprintf(fp, "# total time %.2f seconds\n", time_used);
+	if (verbose) {
+		printf("\tbenchmark took %.2f seconds\n", time_used);
+	}
+	if (fp != stdout) {
+		fclose(fp);
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+#define BENCH_NMETRIC (GMRFLib_BENCH_PHASE_N + 3)
+
+static double bench_phase_time[GMRFLib_BENCH_PHASE_N];
+static GMRFLib_bench_phase_tp bench_phase_cur = GMRFLib_BENCH_PHASE_NONE;
+static double bench_phase_tref = 0.0;
+
+int GMRFLib_bench_phase(GMRFLib_bench_phase_tp phase)
+{
+	// the phases are changed in the main thread only, and a new phase ends the current one
+	if (omp_get_level() > 0 || phase == bench_phase_cur) {
+		return GMRFLib_SUCCESS;
+	}
+
+	double now = GMRFLib_timer();
+	if (bench_phase_cur != GMRFLib_BENCH_PHASE_NONE) {
+		bench_phase_time[bench_phase_cur] += now - bench_phase_tref;
+	}
+	bench_phase_cur = phase;
+	bench_phase_tref = now;
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_bench_model_reset(void)
+{
+	// start the counting for a new model. the peak RSS is for the process and cannot be reset
+	Memset(bench_phase_time, 0, sizeof(bench_phase_time));
+	bench_phase_cur = GMRFLib_BENCH_PHASE_NONE;
+	bench_phase_tref = 0.0;
+	GMRFLib_factorise_count = 0;
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_bench_place(int place)
+{
+	/*
+	 * map the places in GMRFLib_openmp_implement_strategy() to phases. the other places are used within a phase and do not change
+	 * it
+	 */
+	switch (place) {
+	case GMRFLib_OPENMP_PLACES_PARSE_MODEL:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_PARSE);
+
+	case GMRFLib_OPENMP_PLACES_BUILD_MODEL:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_BUILD);
+
+	case GMRFLib_OPENMP_PLACES_OPTIMIZE:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_OPTIMISE);
+
+	case GMRFLib_OPENMP_PLACES_HESSIAN:
+	case GMRFLib_OPENMP_PLACES_HESSIAN_SCALE:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_HESSIAN);
+
+	case GMRFLib_OPENMP_PLACES_INTEGRATE_HYPERPAR:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_INTEGRATE);
+
+	case GMRFLib_OPENMP_PLACES_COMBINE:
+		return GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_COMBINE);
+
+	default:
+		break;
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+static char *bench_model_name(const char *ini_file)
+{
+	// the name of the directory containing the ini-file, as in 'corpus/<name>/Model.ini', or the ini-file itself
+	char *path = Strdup(ini_file);
+	char *name = NULL;
+	char *p = strrchr(path, '/');
+
+	if (p) {
+		*p = '\0';
+		char *q = strrchr(path, '/');
+		name = Strdup(q ? q + 1 : path);
+	} else {
+		name = Strdup(path);
+	}
+	Free(path);
+
+	return name;
+}
+
+static int bench_baseline_read(const char *filename, const char *name, const char **metric, double *base)
+{
+	/*
+	 * read the baseline values for model 'name'. if there are several entries, the last one is used. missing values are NAN
+	 */
+	FILE *fp = fopen(filename, "r");
+	if (!fp) {
+		GMRFLib_ERROR(GMRFLib_EOPENFILE);
+	}
+
+	char line[1024], bname[256], bmetric[64];
+	double value;
+
+	for (int k = 0; k < BENCH_NMETRIC; k++) {
+		base[k] = NAN;
+	}
+	while (fgets(line, (int) sizeof(line), fp)) {
+		if (line[0] == '#' || sscanf(line, "%255s %63s %lf", bname, bmetric, &value) != 3 || strcmp(bname, name)) {
+			continue;
+		}
+		for (int k = 0; k < BENCH_NMETRIC; k++) {
+			if (!strcmp(bmetric, metric[k])) {
+				base[k] = value;
+				break;
+			}
+		}
+	}
+	fclose(fp);
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_bench_model_report(const char *ini_file, const char *dir, int verbose, int *nregression)
+{
+	const char *metric[BENCH_NMETRIC];
+	double value[BENCH_NMETRIC], slack[BENCH_NMETRIC], total = 0.0;
+	int crm = 0, prm = 0, cvm = 0, pvm = 0;
+
+	GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_NONE);
+	for (int k = 0; k < GMRFLib_BENCH_PHASE_N; k++) {
+		metric[k] = GMRFLib_BENCH_PHASE_NAME(k);
+		value[k] = bench_phase_time[k];
+		slack[k] = GMRFLib_BENCH_SLACK_TIME;
+		total += value[k];
+	}
+
+	GMRFLib_getMemory(&crm, &prm, &cvm, &pvm);
+	int k = GMRFLib_BENCH_PHASE_N;
+	metric[k] = "total";
+	value[k] = total;
+	slack[k++] = GMRFLib_BENCH_SLACK_TIME;
+	metric[k] = "peak_rss_mb";
+	value[k] = prm / 1024.0;
+	slack[k++] = GMRFLib_BENCH_SLACK_MEM;
+	metric[k] = "nfact";
+	value[k] = (double) GMRFLib_factorise_count;
+	slack[k++] = 0.0;
+	assert(k == BENCH_NMETRIC);
+
+	char *name = bench_model_name(ini_file);
+	char *results = NULL;
+	if (getenv("INLA_BENCH_RESULTS")) {
+		results = Strdup(getenv("INLA_BENCH_RESULTS"));
+	} else {
+		GMRFLib_sprintf(&results, "%s/bench-model.txt", (dir ? dir : "."));
+	}
+
+	/*
+	 * compare before we append the results, as the results file can be the baseline
+	 */
+	*nregression = 0;
+	char *baseline = getenv("INLA_BENCH_BASELINE");
+	if (baseline && *baseline) {
+		double base[BENCH_NMETRIC];
+		double tol = (getenv("INLA_BENCH_TOL") ? atof(getenv("INLA_BENCH_TOL")) : GMRFLib_BENCH_TOL);
+
+		GMRFLib_EWRAP0(bench_baseline_read(baseline, name, metric, base));
+		if (verbose) {
+			printf("Benchmark model [%s] compared with baseline [%s], tolerance %.0f%%\n", name, baseline, 100.0 * tol);
+			printf("\t%-12s %12s %12s %8s\n", "metric", "baseline", "current", "ratio");
+		}
+		for (k = 0; k < BENCH_NMETRIC; k++) {
+			if (ISNAN(base[k])) {
+				continue;
+			}
+			int regression = (value[k] > base[k] * (1.0 + tol) + slack[k]);
+			if (verbose) {
+				printf("\t%-12s %12.4f %12.4f %8.3f %s\n", metric[k], base[k], value[k],
+				       (base[k] > 0.0 ? value[k] / base[k] : 1.0), (regression ? "REGRESSION" : ""));
+			}
+			if (regression) {
+				fprintf(stderr, "*** Benchmark regression: model [%s] %s = %.4f, baseline = %.4f\n", name, metric[k], value[k], base[k]);
+				(*nregression)++;
+			}
+		}
+	}
+
+	FILE *fp = fopen(results, "a");
+	if (!fp) {
+		GMRFLib_ERROR(GMRFLib_EOPENFILE);
+	}
+	fprintf(fp, "# %s, threads = %1d\n", ini_file, GMRFLib_openmp->max_threads);
+	for (k = 0; k < BENCH_NMETRIC; k++) {
+		fprintf(fp, "%s %s %.6g\n", name, metric[k], value[k]);
+	}
+	fclose(fp);
+	if (verbose) {
+		printf("Benchmark results for model [%s] appended to [%s]\n", name, results);
+	}
+
+	Free(name);
+	Free(results);
+
+	return GMRFLib_SUCCESS;
+}
@@ -0,0 +1,100 @@
+
+/* bench.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file bench.h
+  \brief Typedefs for \ref bench.c
+*/
+
+#ifndef __GMRFLib_BENCH_H__
+#define __GMRFLib_BENCH_H__
+
+#include <stdlib.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+/*
+ * increase this if the format of the results, the graphs or the kernels change, so results are only compared with results of the
+ * same version
+ */
+#define GMRFLib_BENCH_VERSION (1)
+
+/*
+ * the phases of a model fit, as reported by 'inla -m benchmodel'. the phases are switched from the main thread, mostly by the
+ * places in GMRFLib_openmp_implement_strategy(), and a new phase ends the current one
+ */
+typedef enum {
+	GMRFLib_BENCH_PHASE_NONE = -1,
+	GMRFLib_BENCH_PHASE_PARSE = 0,
+	GMRFLib_BENCH_PHASE_BUILD,
+	GMRFLib_BENCH_PHASE_OPTIMISE,
+	GMRFLib_BENCH_PHASE_HESSIAN,
+	GMRFLib_BENCH_PHASE_INTEGRATE,
+	GMRFLib_BENCH_PHASE_COMBINE,
+	GMRFLib_BENCH_PHASE_OUTPUT,
+	GMRFLib_BENCH_PHASE_N
+} GMRFLib_bench_phase_tp;
+
+#define GMRFLib_BENCH_PHASE_NAME(phase)					\
+	((phase) == GMRFLib_BENCH_PHASE_PARSE ? "parse" :		\
+	 ((phase) == GMRFLib_BENCH_PHASE_BUILD ? "build" :		\
+	  ((phase) == GMRFLib_BENCH_PHASE_OPTIMISE ? "optimise" :	\
+	   ((phase) == GMRFLib_BENCH_PHASE_HESSIAN ? "hessian" :	\
+	    ((phase) == GMRFLib_BENCH_PHASE_INTEGRATE ? "integrate" :	\
+	     ((phase) == GMRFLib_BENCH_PHASE_COMBINE ? "combine" :	\
+	      ((phase) == GMRFLib_BENCH_PHASE_OUTPUT ? "output" : "none")))))))
+
+/*
+ * default relative tolerance, and the absolute slack for times (seconds) and memory (Mb), when comparing with a baseline
+ */
+#define GMRFLib_BENCH_TOL (0.2)
+#define GMRFLib_BENCH_SLACK_TIME (0.1)
+#define GMRFLib_BENCH_SLACK_MEM (10.0)
+
+int GMRFLib_bench_run(const char *filename, int verbose);
+int GMRFLib_bench_phase(GMRFLib_bench_phase_tp phase);
+int GMRFLib_bench_place(int place);
+int GMRFLib_bench_model_reset(void);
+int GMRFLib_bench_model_report(const char *ini_file, const char *dir, int verbose, int *nregression);
+
+__END_DECLS
+#endif
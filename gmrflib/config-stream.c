@@ -0,0 +1,167 @@
+
+/* config-stream.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+
+#include <zlib.h>
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+
+static unsigned char *cstream_shuffle(unsigned char *dest, const void *src, int n, int width)
+{
+	// store byte 'b' of all the 'n' values of size 'width' together. return the next free position in 'dest'
+	const unsigned char *s = (const unsigned char *) src;
+	for (int b = 0; b < width; b++) {
+		unsigned char *d = dest + (size_t) b * n;
+		for (int k = 0; k < n; k++) {
+			d[k] = s[(size_t) k * width + b];
+		}
+	}
+	return dest + (size_t) n * width;
+}
+
+GMRFLib_cstream_tp *GMRFLib_cstream_open(const char *filename, int use_float)
+{
+	FILE *fp = fopen(filename, "wb");
+	if (!fp) {
+		GMRFLib_ERROR_MSG_NO_RETURN(GMRFLib_EOPENFILE, filename);
+		return NULL;
+	}
+
+	GMRFLib_cstream_tp *cs = Calloc(1, GMRFLib_cstream_tp);
+	cs->filename = Strdup(filename);
+	cs->fp = fp;
+	cs->use_float = (use_float ? 1 : 0);
+	cs->level = Z_BEST_SPEED;			       /* the ratio is hardly better for higher levels */
+	cs->offset = 0;
+
+	return cs;
+}
+
+size_t GMRFLib_cstream_chunk_size(GMRFLib_cstream_tp *cs)
+{
+	// the uncompressed size of a chunk
+	return (size_t) (2 * cs->n + cs->nz + cs->prior_nz) * sizeof(double) + (size_t) cs->nz * (cs->use_float ? sizeof(float) : sizeof(double));
+}
+
+int GMRFLib_cstream_write(GMRFLib_cstream_tp *cs, GMRFLib_cstream_chunk_tp *chunk, int n, int nz, int prior_nz, double *mean,
+			  double *improved_mean, double *Q, double *Qinv, double *Qprior)
+{
+	// compress one configuration and append it. the compression is done by the calling thread, only the write is serialised
+
+	GMRFLib_ENTER_ROUTINE;
+
+#pragma omp critical (Name_0b6f4a1cf0e35d3cb2e29d7c6b1e3f06a3a0c8d1)
+	{
+		if (!(cs->Qref)) {
+			cs->n = n;
+			cs->nz = nz;
+			cs->prior_nz = prior_nz;
+			cs->Qref = Calloc(nz, double);
+			Memcpy(cs->Qref, Q, nz * sizeof(double));
+			cs->Qref_shuffled = Calloc((size_t) nz * sizeof(double), unsigned char);
+			cstream_shuffle(cs->Qref_shuffled, Q, nz, sizeof(double));
+		}
+	}
+	assert(cs->n == n && cs->nz == nz && cs->prior_nz == prior_nz);
+
+	size_t ulen = GMRFLib_cstream_chunk_size(cs);
+	unsigned char *buf = Calloc(ulen, unsigned char);
+	unsigned char *p = buf, *q = NULL;
+
+	p = cstream_shuffle(p, mean, n, sizeof(double));
+	p = cstream_shuffle(p, improved_mean, n, sizeof(double));
+	q = p;
+	p = cstream_shuffle(p, Q, nz, sizeof(double));
+	for (size_t k = 0; k < (size_t) nz * sizeof(double); k++) {
+		q[k] -= cs->Qref_shuffled[k];
+	}
+	if (cs->use_float) {
+		float *f = Calloc(nz, float);
+		for (int k = 0; k < nz; k++) {
+			f[k] = (float) Qinv[k];
+		}
+		p = cstream_shuffle(p, f, nz, sizeof(float));
+		Free(f);
+	} else {
+		p = cstream_shuffle(p, Qinv, nz, sizeof(double));
+	}
+	p = cstream_shuffle(p, Qprior, prior_nz, sizeof(double));
+	assert((size_t) (p - buf) == ulen);
+
+	uLongf zlen = compressBound((uLong) ulen);
+	unsigned char *zbuf = Calloc(zlen, unsigned char);
+	int ret = compress2(zbuf, &zlen, buf, (uLong) ulen, cs->level);
+	Free(buf);
+	if (ret != Z_OK) {
+		Free(zbuf);
+		GMRFLib_LEAVE_ROUTINE;
+		GMRFLib_ERROR(GMRFLib_ESNH);
+	}
+
+	size_t nw = 0;
+#pragma omp critical (Name_5d1f0a38e2c7b6a49d8e1f3c0b7a6e5d4c3b2a19)
+	{
+		chunk->offset = cs->offset;
+		chunk->zlen = (int) zlen;
+		nw = fwrite((void *) zbuf, (size_t) 1, (size_t) zlen, cs->fp);
+		cs->offset += (long) zlen;
+		cs->bytes_raw += ulen;
+	}
+	Free(zbuf);
+
+	GMRFLib_LEAVE_ROUTINE;
+	if (nw != (size_t) zlen) {
+		GMRFLib_ERROR(GMRFLib_EWRITE);
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_cstream_close(GMRFLib_cstream_tp *cs)
+{
+	if (cs && cs->fp) {
+		fclose(cs->fp);
+		cs->fp = NULL;
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_cstream_free(GMRFLib_cstream_tp *cs)
+{
+	if (cs) {
+		GMRFLib_cstream_close(cs);
+		Free(cs->filename);
+		Free(cs->Qref);
+		Free(cs->Qref_shuffled);
+		Free(cs);
+	}
+	return GMRFLib_SUCCESS;
+}
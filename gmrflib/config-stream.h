@@ -0,0 +1,92 @@
+
+/* config-stream.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file config-stream.h
+  \brief Typedefs for \ref config-stream.c
+*/
+
+#ifndef __GMRFLib_CONFIG_STREAM_H__
+#define __GMRFLib_CONFIG_STREAM_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+/*
+ * A configuration stream: the large arrays of each stored configuration (mean, improved_mean, Q, Qinv and Qprior) are compressed into
+ * one zlib-chunk as soon as the configuration is finished, and appended to 'filename'. Each chunk is self-contained, so the R interface
+ * can read it back using only its (offset, zlen) index entry.
+ *
+ * Each array in the chunk is byte-shuffled (byte b of all values first, then byte b+1, and so on) which makes the exponent and high
+ * mantissa bytes compress well. Q is also delta-coded bytewise (mod 256) against the Q of the first configuration written, as the Q's
+ * share the same pattern and many values do not change with theta. If 'use_float', Qinv is stored in single precision.
+ */
+typedef struct {
+	char *filename;
+	FILE *fp;
+	int use_float;					       /* store Qinv as float */
+	int level;					       /* zlib compression level */
+	int n;						       /* length of mean and improved_mean */
+	int nz;						       /* length of Q and Qinv */
+	int prior_nz;					       /* length of Qprior */
+	double *Qref;					       /* the reference Q for the delta-coding */
+	unsigned char *Qref_shuffled;
+	long offset;					       /* current size of the file */
+	size_t bytes_raw;				       /* total number of bytes before compression */
+} GMRFLib_cstream_tp;
+
+typedef struct {
+	long offset;					       /* offset in the file */
+	int zlen;					       /* length of the compressed chunk */
+} GMRFLib_cstream_chunk_tp;
+
+GMRFLib_cstream_tp *GMRFLib_cstream_open(const char *filename, int use_float);
+int GMRFLib_cstream_close(GMRFLib_cstream_tp * cs);
+int GMRFLib_cstream_free(GMRFLib_cstream_tp * cs);
+int GMRFLib_cstream_write(GMRFLib_cstream_tp * cs, GMRFLib_cstream_chunk_tp * chunk, int n, int nz, int prior_nz, double *mean,
+			  double *improved_mean, double *Q, double *Qinv, double *Qprior);
+size_t GMRFLib_cstream_chunk_size(GMRFLib_cstream_tp * cs);
+
+__END_DECLS
+#endif
@@ -0,0 +1,374 @@
+
+/* density-pool.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+
+#include <stddef.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+
+#define CONST_3 (-0.918938533204672741780329736407)	       // log(1.0/sqrt(2.0*M_PI))
+
+/*
+ * A pool of densities, stored as a structure of arrays, so that the densities for a block of nodes needs a few large
+ * allocations instead of one (or more) for each node. GMRFLib_density_pool_set_normal() creates a Gaussian directly in
+ * the pool, GMRFLib_density_pool_set() moves a density into the pool, and GMRFLib_density_pool_view() gives back a
+ * GMRFLib_density_tp, in the storage of the caller, for the code that needs one. The Gaussians, which is what the
+ * latent and predictor marginals are in the compact mode, are evaluated directly from the arrays.
+ */
+
+int GMRFLib_density_pool_create(GMRFLib_density_pool_tp **pool, int n)
+{
+	/*
+	 * create a pool for 'n' densities 
+	 */
+	GMRFLib_ASSERT(n >= 0, GMRFLib_EPARAMETER);
+
+	GMRFLib_density_pool_tp *p = Calloc(1, GMRFLib_density_pool_tp);
+	size_t len = (size_t) IMAX(1, n);
+
+	p->n = n;
+	p->type = Calloc(len, GMRFLib_density_type_tp);
+	p->sn_param = Calloc(len, GMRFLib_sn_param_tp);
+	p->log_correction = Calloc(3 * len, GMRFLib_spline_tp *);
+	p->P = p->log_correction + len;
+	p->Pinv = p->P + len;
+
+	// one arena for all the double's
+	p->mean = Calloc(9 * len, double);
+	p->stdev = p->mean + len;
+	p->skewness = p->stdev + len;
+	p->user_mode = p->skewness + len;
+	p->std_mean = p->user_mode + len;
+	p->std_stdev = p->std_mean + len;
+	p->x_min = p->std_stdev + len;
+	p->x_max = p->x_min + len;
+	p->log_norm_const = p->x_max + len;
+
+	*pool = p;
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_free(GMRFLib_density_pool_tp *pool)
+{
+	if (pool) {
+		for (int i = 0; i < pool->n; i++) {
+			if (pool->log_correction[i]) {
+				GMRFLib_spline_free(pool->log_correction[i]);
+			}
+			if (pool->P[i]) {
+				GMRFLib_spline_free(pool->P[i]);
+			}
+			if (pool->Pinv[i]) {
+				GMRFLib_spline_free(pool->Pinv[i]);
+			}
+		}
+		Free(pool->type);
+		Free(pool->sn_param);
+		Free(pool->log_correction);
+		Free(pool->mean);
+		Free(pool);
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_set(GMRFLib_density_pool_tp *pool, int idx, GMRFLib_density_tp *density)
+{
+	/*
+	 * move 'density' into position 'idx' of the pool. the splines are taken over by the pool, and 'density' is free'd.
+	 * this function can be called in parallel for different 'idx'
+	 */
+	GMRFLib_ASSERT(pool && density && idx >= 0 && idx < pool->n, GMRFLib_EPARAMETER);
+	GMRFLib_ASSERT(!GMRFLib_getbit(density->flags, DENSITY_FLAGS_VIEW), GMRFLib_EPARAMETER);
+
+	pool->type[idx] = density->type;
+	pool->mean[idx] = density->mean;
+	pool->stdev[idx] = density->stdev;
+	pool->skewness[idx] = density->skewness;
+	pool->user_mode[idx] = density->user_mode;
+	pool->std_mean[idx] = density->std_mean;
+	pool->std_stdev[idx] = density->std_stdev;
+	pool->x_min[idx] = density->x_min;
+	pool->x_max[idx] = density->x_max;
+	pool->log_norm_const[idx] = density->log_norm_const;
+	if (density->type == GMRFLib_DENSITY_TYPE_SKEWNORMAL) {
+		Memcpy(&(pool->sn_param[idx]), density->sn_param, sizeof(GMRFLib_sn_param_tp));
+	}
+	pool->log_correction[idx] = density->log_correction;
+	pool->P[idx] = density->P;
+	pool->Pinv[idx] = density->Pinv;
+
+	density->log_correction = density->P = density->Pinv = NULL;
+	if (density->type == GMRFLib_DENSITY_TYPE_SCGAUSSIAN) {
+		// GMRFLib_free_density() do not check for NULL here
+		Free(density);
+	} else {
+		GMRFLib_free_density(density);
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_set_normal(GMRFLib_density_pool_tp *pool, int idx, double mean, double stdev, double std_mean, double std_stdev)
+{
+	/*
+	 * as GMRFLib_density_create_normal() without lookup-tables, but store the density in position 'idx' of the pool
+	 */
+	GMRFLib_ASSERT(pool && idx >= 0 && idx < pool->n, GMRFLib_EPARAMETER);
+
+	pool->type[idx] = GMRFLib_DENSITY_TYPE_GAUSSIAN;
+	pool->mean[idx] = mean;
+	pool->stdev[idx] = stdev;
+	pool->skewness[idx] = 0.0;
+	pool->user_mode[idx] = std_stdev * mean + std_mean;
+	pool->std_mean[idx] = std_mean;
+	pool->std_stdev[idx] = std_stdev;
+	pool->x_min[idx] = -GMRFLib_DENSITY_INTEGRATION_LIMIT * stdev + mean;
+	pool->x_max[idx] = GMRFLib_DENSITY_INTEGRATION_LIMIT * stdev + mean;
+	pool->log_norm_const[idx] = 0.0;
+
+	return GMRFLib_SUCCESS;
+}
+
+GMRFLib_density_tp *GMRFLib_density_pool_view(GMRFLib_density_tp *view, GMRFLib_density_pool_tp *pool, int idx)
+{
+	/*
+	 * fill 'view' with density 'idx' in the pool and return it. the parameters and splines are shared with the pool, so
+	 * the view is only valid as long as the pool, and must not be free'd with GMRFLib_free_density()
+	 */
+	Memset(view, 0, sizeof(GMRFLib_density_tp));
+	view->type = pool->type[idx];
+	view->mean = pool->mean[idx];
+	view->stdev = pool->stdev[idx];
+	view->skewness = pool->skewness[idx];
+	view->std_mean = pool->std_mean[idx];
+	view->std_stdev = pool->std_stdev[idx];
+	view->user_mean = view->std_stdev * view->mean + view->std_mean;
+	view->user_stdev = view->std_stdev * view->stdev;
+	view->user_mode = pool->user_mode[idx];
+	view->x_min = pool->x_min[idx];
+	view->x_max = pool->x_max[idx];
+	view->log_norm_const = pool->log_norm_const[idx];
+	view->sn_param = (view->type == GMRFLib_DENSITY_TYPE_SKEWNORMAL ? &(pool->sn_param[idx]) : NULL);
+	view->log_correction = pool->log_correction[idx];
+	view->P = pool->P[idx];
+	view->Pinv = pool->Pinv[idx];
+	GMRFLib_setbit(&(view->flags), DENSITY_FLAGS_VIEW);
+
+	return view;
+}
+
+double GMRFLib_density_pool_user_mean(GMRFLib_density_pool_tp *pool, int idx)
+{
+	return pool->std_stdev[idx] * pool->mean[idx] + pool->std_mean[idx];
+}
+
+int GMRFLib_density_pool_new_user_mean(GMRFLib_density_pool_tp *pool, int idx, double new_user_mean)
+{
+	/*
+	 * as GMRFLib_density_new_user_mean() for density 'idx' in the pool
+	 */
+	double diff = new_user_mean - GMRFLib_density_pool_user_mean(pool, idx);
+	pool->std_mean[idx] += diff;
+	if (!ISNAN(pool->user_mode[idx])) {
+		pool->user_mode[idx] += diff;
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_new_user_stdev(GMRFLib_density_pool_tp *pool, int idx, double new_user_stdev)
+{
+	/*
+	 * as GMRFLib_density_new_user_stdev() for density 'idx' in the pool
+	 */
+	assert(pool->type[idx] == GMRFLib_DENSITY_TYPE_GAUSSIAN);
+	pool->stdev[idx] *= new_user_stdev / (pool->std_stdev[idx] * pool->stdev[idx]);
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_nlogdensity(double *logdens, double *x, int n, GMRFLib_density_pool_tp *pool, int idx)
+{
+	/*
+	 * as GMRFLib_evaluate_nlogdensity() for density 'idx' in the pool. Note that x is in *standardised scale*.
+	 */
+	if (pool->type[idx] == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		double c1 = CONST_3 - log(pool->stdev[idx]);
+		double c2 = -0.5 / SQR(pool->stdev[idx]);
+		double m = pool->mean[idx];
+#pragma omp simd
+		for (int i = 0; i < n; i++) {
+			double xx = x[i] - m;
+			logdens[i] = c1 + c2 * xx * xx;
+		}
+	} else {
+		GMRFLib_density_tp view;
+		GMRFLib_evaluate_nlogdensity(logdens, x, n, GMRFLib_density_pool_view(&view, pool, idx));
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_P(double *px, double *x, int n, GMRFLib_density_pool_tp *pool, int idx)
+{
+	/*
+	 * as GMRFLib_density_P_n() for density 'idx' in the pool. Note that x is in *standardised scale*.
+	 */
+	if (pool->type[idx] == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		double m = pool->mean[idx];
+		double is = 1.0 / pool->stdev[idx];
+		for (int i = 0; i < n; i++) {
+			px[i] = GMRFLib_cdfnorm((x[i] - m) * is);
+		}
+	} else {
+		GMRFLib_density_tp view;
+		GMRFLib_density_P_n(px, x, n, GMRFLib_density_pool_view(&view, pool, idx));
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_Pinv(double *xp, double *p, int n, GMRFLib_density_pool_tp *pool, int idx)
+{
+	/*
+	 * as GMRFLib_density_Pinv_n() for density 'idx' in the pool. Note that xp is in *standardised scale*.
+	 */
+	if (pool->type[idx] == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		double m = pool->mean[idx];
+		double s = pool->stdev[idx];
+		for (int i = 0; i < n; i++) {
+			GMRFLib_ASSERT(p[i] >= 0 && p[i] <= 1, GMRFLib_EPARAMETER);
+			xp[i] = m + s * GMRFLib_cdfnorm_inv(p[i]);
+		}
+	} else {
+		GMRFLib_density_tp view;
+		GMRFLib_density_Pinv_n(xp, p, n, GMRFLib_density_pool_view(&view, pool, idx));
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_evaluate_ndensities(double *dens, double *x_user, int nx, GMRFLib_density_pool_tp **pools, int idx,
+					     GMRFLib_idxval_tp *probs)
+{
+	/*
+	 * as GMRFLib_evaluate_ndensities() for the mixture
+	 * 
+	 * \sum_k probs->val[k] * pools[probs->idx[k]][idx]
+	 * 
+	 * in ***USER SCALE***. the weights need not to be scaled.
+	 */
+	double *d_tmp = NULL, *x_std = NULL, *work = NULL;
+	double work_stack[2 * GMRFLib_DENSITY_NX_STACK];
+
+	if (nx <= GMRFLib_DENSITY_NX_STACK) {
+		d_tmp = work_stack;
+		x_std = work_stack + GMRFLib_DENSITY_NX_STACK;
+	} else {
+		work = Calloc(2 * nx, double);
+		d_tmp = work;
+		x_std = work + nx;
+	}
+
+	Memset(dens, 0, nx * sizeof(double));
+	for (int k = 0; k < probs->n; k++) {
+		GMRFLib_density_pool_tp *pool = pools[probs->idx[k]];
+		double a = probs->val[k] / pool->std_stdev[idx];
+		double s_a = 1.0 / pool->std_stdev[idx];
+		double s_b = -pool->std_mean[idx] / pool->std_stdev[idx];
+
+		if (pool->type[idx] == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+			double c1 = CONST_3 - log(pool->stdev[idx]);
+			double c2 = -0.5 / SQR(pool->stdev[idx]);
+			s_b -= pool->mean[idx];
+#pragma omp simd
+			for (int j = 0; j < nx; j++) {
+				double z = s_a * x_user[j] + s_b;
+				dens[j] += a * exp(c1 + c2 * z * z);
+			}
+		} else {
+			for (int j = 0; j < nx; j++) {
+				x_std[j] = s_a * x_user[j] + s_b;
+			}
+			GMRFLib_density_pool_nlogdensity(d_tmp, x_std, nx, pool, idx);
+			GMRFLib_exp(nx, d_tmp, d_tmp);
+
+			int inc = 1;
+			daxpy_(&nx, &a, d_tmp, &inc, dens, &inc);
+		}
+	}
+
+	Free(work);
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_pool_combine(GMRFLib_density_tp **density, GMRFLib_density_pool_tp **pools, int idx, GMRFLib_idxval_tp *probs,
+				 GMRFLib_density_type_tp type)
+{
+	/*
+	 * as GMRFLib_density_combine_x() for the mixture
+	 * 
+	 * \sum_k probs->val[k] * pools[probs->idx[k]][idx]
+	 */
+	if (probs->n == 0) {
+		*density = NULL;
+		return GMRFLib_SUCCESS;
+	}
+
+	if (probs->n == 1) {
+		GMRFLib_density_tp view, *v = GMRFLib_density_pool_view(&view, pools[probs->idx[0]], idx);
+		return GMRFLib_density_combine_x(density, &v, NULL, type);
+	}
+
+	int nx = 0;
+	double m1 = 0.0, m2 = 0.0, sum_w = 0.0;
+	double x_user[GMRFLib_DENSITY_COMBINE_NX], ddens[GMRFLib_DENSITY_COMBINE_NX];
+
+	for (int k = 0; k < probs->n; k++) {
+		GMRFLib_density_pool_tp *pool = pools[probs->idx[k]];
+		double pp = probs->val[k];
+		double um = pool->std_stdev[idx] * pool->mean[idx] + pool->std_mean[idx];
+		double us = pool->std_stdev[idx] * pool->stdev[idx];
+
+		m1 += pp * um;
+		m2 += pp * (SQR(us) + SQR(um));
+		sum_w += pp;
+	}
+	double mean = m1 / sum_w;
+	double stdev = sqrt(DMAX(0.0, m2 / sum_w - SQR(mean)));
+
+	GMRFLib_density_combine_layout_x(x_user, &nx, mean, stdev);
+	if (type != GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		GMRFLib_density_pool_evaluate_ndensities(ddens, x_user, nx, pools, idx, probs);
+	}
+
+	return GMRFLib_density_combine_create(density, ddens, mean, stdev, type);
+}
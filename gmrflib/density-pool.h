@@ -0,0 +1,109 @@
+
+/* density-pool.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file density-pool.h
+  \brief Typedefs used to represent a pool of densities
+*/
+
+#ifndef __GMRFLib_DENSITY_POOL_H__
+#define __GMRFLib_DENSITY_POOL_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+
+/**
+ * \brief A pool of densities stored as a structure of arrays.
+ *
+ * The densities for a block of nodes are stored in a few arrays, instead of one \c GMRFLib_density_tp object each. All
+ * the parameters of the density are kept as they are, so a density in the pool is exactly the density that was put
+ * into it. \c GMRFLib_density_pool_view() gives a \c GMRFLib_density_tp for density \c idx in the pool, in storage
+ * provided by the caller, to be used with the existing density-functions.
+ */
+typedef struct {
+
+	/**
+	 * \brief Number of densities in the pool
+	 */
+	int n;
+
+	/*
+	 * The rest of the paramers is for internal use only. 
+	 */
+	GMRFLib_density_type_tp *type;
+	double *mean;					       /* as in GMRFLib_density_tp */
+	double *stdev;
+	double *skewness;
+	double *user_mode;
+	double *std_mean;
+	double *std_stdev;
+	double *x_min;
+	double *x_max;
+	double *log_norm_const;
+	GMRFLib_sn_param_tp *sn_param;			       /* for SKEWNORMAL */
+	GMRFLib_spline_tp **log_correction;		       /* for SCGAUSSIAN, owned by the pool */
+	GMRFLib_spline_tp **P;				       /* lookup-tables, owned by the pool */
+	GMRFLib_spline_tp **Pinv;
+} GMRFLib_density_pool_tp;
+
+GMRFLib_density_tp *GMRFLib_density_pool_view(GMRFLib_density_tp * view, GMRFLib_density_pool_tp * pool, int idx);
+double GMRFLib_density_pool_user_mean(GMRFLib_density_pool_tp * pool, int idx);
+int GMRFLib_density_pool_P(double *px, double *x, int n, GMRFLib_density_pool_tp * pool, int idx);
+int GMRFLib_density_pool_Pinv(double *xp, double *p, int n, GMRFLib_density_pool_tp * pool, int idx);
+int GMRFLib_density_pool_combine(GMRFLib_density_tp ** density, GMRFLib_density_pool_tp ** pools, int idx, GMRFLib_idxval_tp * probs,
+				 GMRFLib_density_type_tp type);
+int GMRFLib_density_pool_create(GMRFLib_density_pool_tp ** pool, int n);
+int GMRFLib_density_pool_evaluate_ndensities(double *dens, double *x_user, int nx, GMRFLib_density_pool_tp ** pools, int idx,
+					     GMRFLib_idxval_tp * probs);
+int GMRFLib_density_pool_free(GMRFLib_density_pool_tp * pool);
+int GMRFLib_density_pool_new_user_mean(GMRFLib_density_pool_tp * pool, int idx, double new_user_mean);
+int GMRFLib_density_pool_new_user_stdev(GMRFLib_density_pool_tp * pool, int idx, double new_user_stdev);
+int GMRFLib_density_pool_nlogdensity(double *logdens, double *x, int n, GMRFLib_density_pool_tp * pool, int idx);
+int GMRFLib_density_pool_set(GMRFLib_density_pool_tp * pool, int idx, GMRFLib_density_tp * density);
+int GMRFLib_density_pool_set_normal(GMRFLib_density_pool_tp * pool, int idx, double mean, double stdev, double std_mean, double std_stdev);
+
+__END_DECLS
+#endif
@@ -877,7 +877,9 @@ int GMRFLib_free_density(GMRFLib_density_tp *density)
 
 		case GMRFLib_DENSITY_TYPE_SKEWNORMAL:
 		{
-			Free(density->sn_param);
+			if (!GMRFLib_getbit(density->flags, DENSITY_FLAGS_VIEW)) {
+				Free(density->sn_param);
+			}
 		}
 			break;
 
@@ -1034,6 +1036,42 @@ int GMRFLib_density_P(double *px, double x, GMRFLib_density_tp *density)
 	return GMRFLib_SUCCESS;
 }
 
+int GMRFLib_density_Pinv_n(double *xp, double *p, int n, GMRFLib_density_tp *density)
+{
+	/*
+	 * as GMRFLib_density_Pinv() for p[i], i=0...n-1. 
+	 */
+	if (density->type == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		for (int i = 0; i < n; i++) {
+			GMRFLib_ASSERT(p[i] >= 0 && p[i] <= 1, GMRFLib_EPARAMETER);
+			xp[i] = density->mean + density->stdev * GMRFLib_cdfnorm_inv(p[i]);
+		}
+	} else {
+		for (int i = 0; i < n; i++) {
+			GMRFLib_density_Pinv(&xp[i], p[i], density);
+		}
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_density_P_n(double *px, double *x, int n, GMRFLib_density_tp *density)
+{
+	/*
+	 * as GMRFLib_density_P() for x[i], i=0...n-1. the values are the same as from GMRFLib_density_P().
+	 */
+	if (density->type == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+		double is = 1.0 / density->stdev;
+		for (int i = 0; i < n; i++) {
+			px[i] = GMRFLib_cdfnorm((x[i] - density->mean) * is);
+		}
+	} else {
+		for (int i = 0; i < n; i++) {
+			GMRFLib_density_P(&px[i], x[i], density);
+		}
+	}
+	return GMRFLib_SUCCESS;
+}
+
 int GMRFLib_evaluate_densities(double *dens, double x_user, int n, GMRFLib_density_tp **densities, double *weights)
 {
 	/*
@@ -1069,30 +1107,52 @@ int GMRFLib_evaluate_ndensities(double *dens, double *x_user, int nx, GMRFLib_de
 	 * 
 	 * the weights need not to be scaled. 
 	 */
-	int nd = (probs ? probs->n : 1);
-	int i, k, n_alloc = IMAX(nd, nx);
-	double *d_tmp = NULL, *x_std = NULL, p;
-
-	Calloc_init(2 * n_alloc, 2);
-	d_tmp = Calloc_get(n_alloc);
-	x_std = Calloc_get(n_alloc);
+	int i, k;
+	double *d_tmp = NULL, *x_std = NULL, *work = NULL, p;
+	double work_stack[2 * GMRFLib_DENSITY_NX_STACK];
+
+	// the combine-step calls this for every node with a short grid, so avoid the malloc for those
+	if (nx <= GMRFLib_DENSITY_NX_STACK) {
+		d_tmp = work_stack;
+		x_std = work_stack + GMRFLib_DENSITY_NX_STACK;
+	} else {
+		work = Calloc(2 * nx, double);
+		d_tmp = work;
+		x_std = work + nx;
+	}
 
 	Memset(dens, 0, nx * sizeof(double));
 	for (k = 0; k < probs->n; k++) {
 		i = probs->idx[k];
 		p = probs->val[k];
-		GMRFLib_density_user2std_n(x_std, x_user, densities[i], nx);
-		GMRFLib_evaluate_ndensity(d_tmp, x_std, nx, densities[i]);
 
-		double a = p / densities[i]->std_stdev;
-		int inc = 1;
-		daxpy_(&nx, &a, d_tmp, &inc, dens, &inc);
+		GMRFLib_density_tp *d = densities[i];
+		double a = p / d->std_stdev;
 
-		// for (j = 0; j < nx; j++) 
-		// dens[j] += p * d_tmp[j] / densities[i]->std_stdev;
+		if (d->type == GMRFLib_DENSITY_TYPE_GAUSSIAN) {
+			// fused: x_std = (x_user - std_mean)/std_stdev, evaluate and add to dens, in one pass
+			double s_a = 1.0 / d->std_stdev;
+			double s_b = -d->std_mean / d->std_stdev - d->mean;
+			double c1 = CONST_3 - log(d->stdev);
+			double c2 = -0.5 / SQR(d->stdev);
+#pragma omp simd
+			for (int j = 0; j < nx; j++) {
+				double z = s_a * x_user[j] + s_b;
+				dens[j] += a * exp(c1 + c2 * z * z);
+			}
+		} else {
+			GMRFLib_density_user2std_n(x_std, x_user, d, nx);
+			GMRFLib_evaluate_ndensity(d_tmp, x_std, nx, d);
+
+			int inc = 1;
+			daxpy_(&nx, &a, d_tmp, &inc, dens, &inc);
+
+			// for (j = 0; j < nx; j++) 
+			// dens[j] += p * d_tmp[j] / densities[i]->std_stdev;
+		}
 	}
 
-	Calloc_free();
+	Free(work);
 	return GMRFLib_SUCCESS;
 }
 
@@ -1100,6 +1160,7 @@ int GMRFLib_density_duplicate(GMRFLib_density_tp **density_to, GMRFLib_density_t
 {
 	GMRFLib_density_combine(density_to, &density_from, NULL);
 	(*density_to)->flags = density_from->flags;
+	(*density_to)->flags &= (GMRFLib_uchar) ~(1U << DENSITY_FLAGS_VIEW);   /* the duplicate owns its parameters */
 
 	return GMRFLib_SUCCESS;
 }
@@ -1170,15 +1231,10 @@ int GMRFLib_density_combine_x(GMRFLib_density_tp **density, GMRFLib_density_tp *
 		return GMRFLib_SUCCESS;
 	}
 
-	double mean, stdev, *ddens = NULL, *log_dens = NULL, *xx_real = NULL, m1, m2, sum_w;
-	double xx[] = { -5.0, -4.0, -3.5, -3.0, -2.5, -2.0, -1.5, -1.25, -1.0, -0.75, -0.5, -0.25, -0.125, 0.0,
-		0.125, 0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 5.0
-	};
-	// DO NOT CHANGE xx[] without changing ww[] below
-	// double ww[] = { 1.0, 0.75, 0.5, 0.5, 0.5, 0.5, 0.375, 0.25, 0.25, 0.25, 0.25, 0.1875, 0.125, 0.125,
-	// 0.125, 0.1875, 0.25, 0.25, 0.25, 0.25, 0.375, 0.5, 0.5, 0.5, 0.5, 0.75, 1.0
-	// };
-	int nx = sizeof(xx) / sizeof(double);
+	double mean, stdev, m1, m2, sum_w;
+	int nx = GMRFLib_DENSITY_COMBINE_NX;
+	double xx_real[GMRFLib_DENSITY_COMBINE_NX];
+	double ddens[GMRFLib_DENSITY_COMBINE_NX];
 
 	/*
 	 * compute the mean and variance in the user-scale 
@@ -1201,17 +1257,47 @@ int GMRFLib_density_combine_x(GMRFLib_density_tp **density, GMRFLib_density_tp *
 	/*
 	 * compute the weighted density. note that we have to go through the user/real-scale to get this right 
 	 */
-	Calloc_init(3 * nx, 3);
-	xx_real = Calloc_get(nx);
-	ddens = Calloc_get(nx);
-	log_dens = Calloc_get(nx);
-
-	// for (int i = 0; i < nx; i++) xx_real[i] = xx[i] * stdev + mean;
-	GMRFLib_daxpb(nx, stdev, xx, mean, xx_real);
-
+	GMRFLib_density_combine_layout_x(xx_real, &nx, mean, stdev);
 	if (type != GMRFLib_DENSITY_TYPE_GAUSSIAN) {
 		GMRFLib_evaluate_ndensities(ddens, xx_real, nx, densities, probs);
+	}
+
+	return GMRFLib_density_combine_create(density, ddens, mean, stdev, type);
+}
+
+/*
+ * the grid, in standardised scale, used to combine densities.
+ * DO NOT CHANGE combine_xx[] without changing ww[] in GMRFLib_density_combine_create()
+ */
+static double combine_xx[GMRFLib_DENSITY_COMBINE_NX] = { -5.0, -4.0, -3.5, -3.0, -2.5, -2.0, -1.5, -1.25, -1.0, -0.75, -0.5, -0.25,
+	-0.125, 0.0, 0.125, 0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 5.0
+};
+
+int GMRFLib_density_combine_layout_x(double *x_user, int *nx, double mean, double stdev)
+{
+	/*
+	 * return the grid used to combine densities with this 'mean' and 'stdev' in user scale. with x_user=NULL only 'nx' is
+	 * returned
+	 */
+	*nx = GMRFLib_DENSITY_COMBINE_NX;
+	if (x_user) {
+		// for (int i = 0; i < nx; i++) x_user[i] = combine_xx[i] * stdev + mean;
+		GMRFLib_daxpb(*nx, stdev, combine_xx, mean, x_user);
+	}
+	return GMRFLib_SUCCESS;
+}
 
+int GMRFLib_density_combine_create(GMRFLib_density_tp **density, double *ddens, double mean, double stdev, GMRFLib_density_type_tp type)
+{
+	/*
+	 * create the combined density of 'type' from the mixture-density 'ddens' evaluated at the grid of
+	 * GMRFLib_density_combine_layout_x(), with the given 'mean' and 'stdev'. 'ddens' is not used for type GAUSSIAN.
+	 */
+	int nx = GMRFLib_DENSITY_COMBINE_NX;
+	double *xx = combine_xx;
+	double log_dens[GMRFLib_DENSITY_COMBINE_NX];
+
+	if (type != GMRFLib_DENSITY_TYPE_GAUSSIAN) {
 		GMRFLib_log(nx, ddens, log_dens);
 
 		// if something is weird, the sum will be weird. only then we need to check
@@ -1246,7 +1332,7 @@ int GMRFLib_density_combine_x(GMRFLib_density_tp **density, GMRFLib_density_tp *
 		double ww[] = { 1.0, 0.75, 0.5, 0.5, 0.5, 0.5, 0.375, 0.25, 0.25, 0.25, 0.25, 0.1875, 0.125, 0.125,
 			0.125, 0.1875, 0.25, 0.25, 0.25, 0.25, 0.375, 0.5, 0.5, 0.5, 0.5, 0.75, 1.0
 		};
-		assert(sizeof(xx) == sizeof(ww));
+		assert(sizeof(combine_xx) == sizeof(ww));
 
 		double mom0 = 0.0, mom1 = 0.0, mom2 = 0.0, mom3 = 0.0;
 #pragma omp simd reduction(+: mom0, mom1, mom2, mom3)
@@ -1289,8 +1375,6 @@ int GMRFLib_density_combine_x(GMRFLib_density_tp **density, GMRFLib_density_tp *
 		assert(0 == 1);
 	}
 
-	Calloc_free();
-
 	return GMRFLib_SUCCESS;
 }
 
@@ -63,6 +63,16 @@ __BEGIN_DECLS
  */
 #define GMRFLib_DENSITY_LENGTH_WORK (2048)
 
+/* 
+ *  grids up to this length are evaluated with work-space on the stack, in GMRFLib_evaluate_ndensities()
+ */
+#define GMRFLib_DENSITY_NX_STACK (64)
+
+/* 
+ *  number of grid-points used to combine densities, see GMRFLib_density_combine_layout_x()
+ */
+#define GMRFLib_DENSITY_COMBINE_NX (27)
+
 /* 
  *  this is a wrapper around the gsl-integration routine, so that if the relative high accurancy FAILS due to roundoff errors,
  *  or similar, the increase the 'eps' with a factor of 10 and try again until success. we need in general to use the _qags
@@ -231,7 +241,8 @@ typedef struct {
 } GMRFLib_density_tp;
 
 typedef enum {
-	DENSITY_FLAGS_FAILURE = 0
+	DENSITY_FLAGS_FAILURE = 0,
+	DENSITY_FLAGS_VIEW = 1				       /* parameters are owned by a GMRFLib_density_pool_tp */
 } GMRFLib_density_flag_tp;
 
 typedef enum {
@@ -279,11 +290,15 @@ double GMRFLib_sn_logdensity_diff_omega(double x, void *param);
 double GMRFLib_sn_logdensity_diff_xi(double x, void *param);
 double GMRFLib_sn_mode(double skew);
 int GMRFLib_density_P(double *px, double x, GMRFLib_density_tp * density);
+int GMRFLib_density_P_n(double *px, double *x, int n, GMRFLib_density_tp * density);
 int GMRFLib_density_Pinv(double *xp, double p, GMRFLib_density_tp * density);
+int GMRFLib_density_Pinv_n(double *xp, double *p, int n, GMRFLib_density_tp * density);
 int GMRFLib_density_adjust_vector(double *ldens, int n);
 int GMRFLib_density_combine(GMRFLib_density_tp ** density, GMRFLib_density_tp ** densities, GMRFLib_idxval_tp * probs);
 int GMRFLib_density_combine_x(GMRFLib_density_tp ** density, GMRFLib_density_tp ** densities, GMRFLib_idxval_tp * probs,
 			      GMRFLib_density_type_tp type);
+int GMRFLib_density_combine_create(GMRFLib_density_tp ** density, double *ddens, double mean, double stdev, GMRFLib_density_type_tp type);
+int GMRFLib_density_combine_layout_x(double *x_user, int *nx, double mean, double stdev);
 int GMRFLib_density_create(GMRFLib_density_tp ** density, int type, int n, double *x, double *logdens, double std_mean, double std_stdev,
 			   int lookup_tables);
 int GMRFLib_density_create_normal(GMRFLib_density_tp ** density, double mean, double stdev, double std_mean, double std_stdev, int lookup_tables);
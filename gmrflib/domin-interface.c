@@ -221,6 +221,7 @@ int GMRFLib_opt_f_omp(double **x, int nx, double *f, int *ierr)
 	 * This is the copy that is to be copied 
 	 */
 	ai_store_reference = GMRFLib_duplicate_ai_store(G.ai_store, GMRFLib_TRUE, GMRFLib_TRUE, GMRFLib_FALSE);
+	double tref = GMRFLib_timer();
 #pragma omp parallel for private(i) num_threads(GMRFLib_openmp->max_threads_outer)
 	for (i = 0; i < nx; i++) {
 		int thread_id = omp_get_thread_num();
@@ -241,6 +242,7 @@ int GMRFLib_opt_f_omp(double **x, int nx, double *f, int *ierr)
 	for (i = 0; i < nx; i++) {
 		*ierr = *ierr || err[i];
 	}
+	GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_OPTIMIZE, GMRFLib_timer() - tref, nx);
 
 	GMRFLib_free_ai_store(ai_store_reference);
 	for (i = 0; i < tmax; i++) {
@@ -262,7 +264,7 @@ int GMRFLib_opt_f_intern(int thread_id,
 	 * this version controls AI_STORE 
 	 */
 
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_THETA);
 
 	int i;
 	const int debug = 0;
@@ -419,10 +421,11 @@ int GMRFLib_opt_gradf_intern(double *x, double *gradx, double *f0, int *ierr)
 		Free(mode_reference);
 	}
 
-	if (GMRFLib_openmp->max_threads_outer > 1) {
+	if (GMRFLib_openmp->max_threads_outer > 1 || GMRFLib_openmp->autotune) {
 		ai_store_reference = GMRFLib_duplicate_ai_store(G.ai_store, GMRFLib_TRUE, GMRFLib_TRUE, GMRFLib_FALSE);
 	}
 
+	double tref = GMRFLib_timer();
 	if (G.ai_par->gradient_forward_finite_difference) {
 		/*
 		 * forward differences 
@@ -590,6 +593,9 @@ int GMRFLib_opt_gradf_intern(double *x, double *gradx, double *f0, int *ierr)
 		Free(ffm);
 	}
 
+	GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_OPTIMIZE, GMRFLib_timer() - tref,
+				       (G.ai_par->gradient_forward_finite_difference ? G.nhyper + 1 : 2 * G.nhyper));
+
 	Free(mode_reference);
 	GMRFLib_free_ai_store(ai_store_reference);
 	for (i = 0; i < tmax; i++) {
@@ -713,7 +719,7 @@ int GMRFLib_opt_estimate_hessian(double *hessian, double *x, double *log_dens_mo
 
 	int early_stop = 0;
 
-	GMRFLib_ai_store_tp *ai_store_reference = (GMRFLib_openmp->max_threads_outer > 1 ?
+	GMRFLib_ai_store_tp *ai_store_reference = (GMRFLib_openmp->max_threads_outer > 1 || GMRFLib_openmp->autotune ?
 						   GMRFLib_duplicate_ai_store(G.ai_store, GMRFLib_TRUE, GMRFLib_TRUE, GMRFLib_FALSE) : NULL);
 	double *mode_reference = Calloc(G.graph->n, double);
 	GMRFLib_opt_get_latent(mode_reference);
@@ -727,6 +733,7 @@ int GMRFLib_opt_estimate_hessian(double *hessian, double *x, double *log_dens_mo
 		order[1 + i + n] = i + n;
 	}
 
+	double tref = GMRFLib_timer();
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
 	for (int ii = 0; ii < 2 * n + 1; ii++) {
 		int i = order[ii];
@@ -791,6 +798,9 @@ int GMRFLib_opt_estimate_hessian(double *hessian, double *x, double *log_dens_mo
 	}
 
 	Free(order);
+	if (!early_stop) {
+		GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_HESSIAN, GMRFLib_timer() - tref, 2 * n + 1);
+	}
 
 	if (early_stop && (G.ai_par->fp_log || debug))
 		fprintf((G.ai_par->fp_log ? G.ai_par->fp_log : stderr), "exit diagonal hessian due to early_stop\n");
@@ -909,6 +919,7 @@ int GMRFLib_opt_estimate_hessian(double *hessian, double *x, double *log_dens_mo
 
 			early_stop = 0;
 			int enable_early_stop = 1;	       /* this must be enabled for early_stop to work here */
+			tref = GMRFLib_timer();
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
 			for (int k = 0; k < nn; k++) {
 				int thread_id = omp_get_thread_num();
@@ -1003,6 +1014,11 @@ int GMRFLib_opt_estimate_hessian(double *hessian, double *x, double *log_dens_mo
 				}
 			}
 			Free(idx);
+			if (!early_stop) {
+				// units are function evaluations, as in the loop above
+				GMRFLib_openmp_autotune_record(GMRFLib_OPENMP_PLACES_HESSIAN, GMRFLib_timer() - tref,
+							       (G.ai_par->hessian_forward_finite_difference ? nn : 4 * nn));
+			}
 		}
 #undef CHECK_FOR_EARLY_STOP
 
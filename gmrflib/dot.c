@@ -32,6 +32,24 @@
 #include "GMRFLib/GMRFLibP.h"
 #include "GMRFLib/dot.h"
 
+#include <strings.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define GMRFLib_DOT_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * GMRFLib_ddot_idx() and GMRFLib_dsum_idx() dispatch to one of these kernels, which is chosen in GMRFLib_dot_init() from what the CPU
+ * supports. until then, or if there is no AVX2, the generic kernels are used.
+ */
+typedef double GMRFLib_ddot_idx_func_tp(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
+typedef double GMRFLib_dsum_idx_func_tp(int n, double *__restrict a, int *__restrict idx);
+
+static GMRFLib_ddot_idx_func_tp *ddot_idx_func = GMRFLib_ddot_idx_generic;
+static GMRFLib_dsum_idx_func_tp *dsum_idx_func = GMRFLib_dsum_idx_generic;
+static const char *dot_kernel_name = "generic";
+
 double GMRFLib_dot_product(GMRFLib_idxval_tp *__restrict ELM_, double *__restrict ARR_)
 {
 	if (ELM_->dot_product_func) {
@@ -162,6 +180,16 @@ double GMRFLib_ddot(int n, double *x, double *y)
 }
 
 double GMRFLib_dsum_idx(int n, double *__restrict a, int *__restrict idx)
+{
+	return dsum_idx_func(n, a, idx);
+}
+
+double GMRFLib_ddot_idx(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
+{
+	return ddot_idx_func(n, v, a, idx);
+}
+
+double GMRFLib_dsum_idx_generic(int n, double *__restrict a, int *__restrict idx)
 {
 	const int roll = 8L;
 	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
@@ -191,8 +219,7 @@ double GMRFLib_dsum_idx(int n, double *__restrict a, int *__restrict idx)
 	return s0 + s1 + s2 + s3;
 }
 
-
-double GMRFLib_ddot_idx(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
+double GMRFLib_ddot_idx_generic(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
 {
 	const int roll = 8L;
 	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
@@ -223,6 +250,176 @@ double GMRFLib_ddot_idx(int n, double *__restrict v, double *__restrict a, int *
 	return s0 + s1 + s2 + s3;
 }
 
+#if defined(GMRFLib_DOT_X86)
+
+/*
+ * the kernels below are compiled with a function-level target, so the rest of the library does not need -mavx2. the tail (n % 8 or n %
+ * 16) is done serially.
+ */
+__attribute__((target("avx2,fma")))
+static double ddot_idx_avx2(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
+{
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m128i i0 = _mm_loadu_si128((const __m128i *) (idx + i));
+		__m128i i1 = _mm_loadu_si128((const __m128i *) (idx + i + 4));
+		s0 = _mm256_fmadd_pd(_mm256_loadu_pd(v + i), _mm256_i32gather_pd(a, i0, 8), s0);
+		s1 = _mm256_fmadd_pd(_mm256_loadu_pd(v + i + 4), _mm256_i32gather_pd(a, i1, 8), s1);
+	}
+	s0 = _mm256_add_pd(s0, s1);
+	__m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+	double s = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+
+	for (; i < n; i++) {
+		s += v[i] * a[idx[i]];
+	}
+	return s;
+}
+
+__attribute__((target("avx2")))
+static double dsum_idx_avx2(int n, double *__restrict a, int *__restrict idx)
+{
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m128i i0 = _mm_loadu_si128((const __m128i *) (idx + i));
+		__m128i i1 = _mm_loadu_si128((const __m128i *) (idx + i + 4));
+		s0 = _mm256_add_pd(_mm256_i32gather_pd(a, i0, 8), s0);
+		s1 = _mm256_add_pd(_mm256_i32gather_pd(a, i1, 8), s1);
+	}
+	s0 = _mm256_add_pd(s0, s1);
+	__m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+	double s = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+
+	for (; i < n; i++) {
+		s += a[idx[i]];
+	}
+	return s;
+}
+
+__attribute__((target("avx512f")))
+static double ddot_idx_avx512(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
+{
+	__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+		__m256i i1 = _mm256_loadu_si256((const __m256i *) (idx + i + 8));
+		s0 = _mm512_fmadd_pd(_mm512_loadu_pd(v + i), _mm512_i32gather_pd(i0, a, 8), s0);
+		s1 = _mm512_fmadd_pd(_mm512_loadu_pd(v + i + 8), _mm512_i32gather_pd(i1, a, 8), s1);
+	}
+	if (i + 8 <= n) {
+		__m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+		s0 = _mm512_fmadd_pd(_mm512_loadu_pd(v + i), _mm512_i32gather_pd(i0, a, 8), s0);
+		i += 8;
+	}
+	double s = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+	for (; i < n; i++) {
+		s += v[i] * a[idx[i]];
+	}
+	return s;
+}
+
+__attribute__((target("avx512f")))
+static double dsum_idx_avx512(int n, double *__restrict a, int *__restrict idx)
+{
+	__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+		__m256i i1 = _mm256_loadu_si256((const __m256i *) (idx + i + 8));
+		s0 = _mm512_add_pd(_mm512_i32gather_pd(i0, a, 8), s0);
+		s1 = _mm512_add_pd(_mm512_i32gather_pd(i1, a, 8), s1);
+	}
+	if (i + 8 <= n) {
+		__m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+		s0 = _mm512_add_pd(_mm512_i32gather_pd(i0, a, 8), s0);
+		i += 8;
+	}
+	double s = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+	for (; i < n; i++) {
+		s += a[idx[i]];
+	}
+	return s;
+}
+#endif							       /* defined(GMRFLib_DOT_X86) */
+
+int GMRFLib_dot_init(void)
+{
+	/*
+	 * chose the kernels for GMRFLib_ddot_idx() and GMRFLib_dsum_idx(). this is to be called once at startup, before going parallel. the
+	 * environment variable INLA_DOT_KERNEL=generic|avx2|avx512 can be used to limit the choice.
+	 */
+
+	ddot_idx_func = GMRFLib_ddot_idx_generic;
+	dsum_idx_func = GMRFLib_dsum_idx_generic;
+	dot_kernel_name = "generic";
+
+#if defined(GMRFLib_DOT_X86)
+	const char *req = getenv("INLA_DOT_KERNEL");
+	int allow_avx512 = (!req || !strcasecmp(req, "avx512"));
+	int allow_avx2 = (allow_avx512 || !strcasecmp(req, "avx2"));
+
+	__builtin_cpu_init();
+	if (allow_avx512 && __builtin_cpu_supports("avx512f")) {
+		ddot_idx_func = ddot_idx_avx512;
+		dsum_idx_func = dsum_idx_avx512;
+		dot_kernel_name = "avx512";
+	} else if (allow_avx2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		ddot_idx_func = ddot_idx_avx2;
+		dsum_idx_func = dsum_idx_avx2;
+		dot_kernel_name = "avx2";
+	}
+#endif
+
+	return GMRFLib_SUCCESS;
+}
+
+const char *GMRFLib_dot_kernel(void)
+{
+	return dot_kernel_name;
+}
+
+int GMRFLib_dot_set_kernel(const char *name)
+{
+	/*
+	 * select the kernel by name, as stored in a tuning profile. returns !GMRFLib_SUCCESS and leaves the current choice untouched, if the
+	 * kernel is unknown or not supported by this CPU.
+	 */
+	if (!name) {
+		return !GMRFLib_SUCCESS;
+	}
+	if (!strcasecmp(name, "generic")) {
+		ddot_idx_func = GMRFLib_ddot_idx_generic;
+		dsum_idx_func = GMRFLib_dsum_idx_generic;
+		dot_kernel_name = "generic";
+		return GMRFLib_SUCCESS;
+	}
+#if defined(GMRFLib_DOT_X86)
+	__builtin_cpu_init();
+	if (!strcasecmp(name, "avx512") && __builtin_cpu_supports("avx512f")) {
+		ddot_idx_func = ddot_idx_avx512;
+		dsum_idx_func = dsum_idx_avx512;
+		dot_kernel_name = "avx512";
+		return GMRFLib_SUCCESS;
+	}
+	if (!strcasecmp(name, "avx2") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		ddot_idx_func = ddot_idx_avx2;
+		dsum_idx_func = dsum_idx_avx2;
+		dot_kernel_name = "avx2";
+		return GMRFLib_SUCCESS;
+	}
+#endif
+	return !GMRFLib_SUCCESS;
+}
+
 #if defined(INLA_WITH_MKL)
 
 double GMRFLib_ddot_idx_mkl_alt(int n, double *__restrict v, double *__restrict a, int *__restrict idx)
@@ -57,6 +57,7 @@ double GMRFLib_dsum(int n, double *x);
 int GMRFLib_isum(int n, int *ix);
 double GMRFLib_ddot(int n, double *x, double *y);
 double GMRFLib_ddot_idx(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
+double GMRFLib_ddot_idx_generic(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
 double GMRFLib_ddot_idx_mkl(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
 double GMRFLib_ddot_idx_mkl_alt(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
 double GMRFLib_ddot_idx_mkl_alt(int n, double *__restrict v, double *__restrict a, int *__restrict idx);
@@ -68,6 +69,10 @@ double GMRFLib_dot_product_serial(GMRFLib_idxval_tp * __restrict ELM_, double *_
 double GMRFLib_dot_product_serial_mkl(GMRFLib_idxval_tp * __restrict ELM_, double *__restrict ARR_);
 double GMRFLib_dot_product_serial_mkl_alt(GMRFLib_idxval_tp * __restrict ELM_, double *__restrict ARR_);
 double GMRFLib_dsum_idx(int n, double *__restrict a, int *__restrict idx);
+double GMRFLib_dsum_idx_generic(int n, double *__restrict a, int *__restrict idx);
+int GMRFLib_dot_init(void);
+const char *GMRFLib_dot_kernel(void);
+int GMRFLib_dot_set_kernel(const char *name);
 void GMRFLib_dsum_measure_time(double *tused);
 void GMRFLib_isum_measure_time(double *tused);
 void GMRFLib_chose_threshold_ddot(void);
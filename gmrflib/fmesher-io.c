@@ -29,9 +29,16 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "GMRFLib/GMRFLib.h"
 #include "GMRFLib/GMRFLibP.h"
@@ -154,12 +161,17 @@ GMRFLib_matrix_tp *GMRFLib_read_fmesher_file(const char *filename, long int offs
 	M->elems = elems;
 
 	int rowmajor = (storagetype == 0);
+	int csr = (storagetype == GMRFLib_FMESHER_STORAGE_CSR);
 	int integer = (valuetype == 0);
 	int dense = (datatype == 0);
 	int general = (matrixtype == 0);
 	int symmetric = (matrixtype == 1);
 	int diagonal = (matrixtype == 2);
 
+	if (csr && (dense || !general || integer)) {
+		ERROR("The CSR storage is only implemented for (sparse && general && double).");
+	}
+
 	if (dense) {
 		if (symmetric || diagonal) {
 			ERROR(" (dense && (symmetric || diagonal)) is not yet implemented.");
@@ -219,6 +231,18 @@ GMRFLib_matrix_tp *GMRFLib_read_fmesher_file(const char *filename, long int offs
 		/*
 		 * sparse 
 		 */
+		int64_t *ia = NULL;
+		if (csr) {
+			ia = Calloc(nrow + 1, int64_t);
+			READ(ia, nrow + 1, int64_t);
+			if (ia[nrow] > (int64_t) INT_MAX) {
+				GMRFLib_sprintf(&msg, "File [%s] has %" PRId64 " elements, which is too many to read into memory; use the out-of-core interface",
+						filename, ia[nrow]);
+				ERROR(msg);
+			}
+			elems = M->elems = (int) ia[nrow];
+		}
+
 		M->i = Calloc(elems, int);
 		M->j = Calloc(elems, int);
 		M->values = Calloc(elems, double);
@@ -226,7 +250,20 @@ GMRFLib_matrix_tp *GMRFLib_read_fmesher_file(const char *filename, long int offs
 			M->ivalues = Calloc(elems, int);
 		}
 
-		if (rowmajor) {
+		if (csr) {
+			for (i = 0; i < nrow; i++) {
+				for (int64_t kk = ia[i]; kk < ia[i + 1]; kk++) {
+					M->i[kk] = i;
+				}
+			}
+			Free(ia);
+			READ(M->j, elems, int);
+			if (elems % 2) {
+				int pad = 0;
+				READ(&pad, 1, int);
+			}
+			READ(M->values, elems, double);
+		} else if (rowmajor) {
 			for (k = 0; k < elems; k++) {
 				READ(&(M->i[k]), 1, int);
 				READ(&(M->j[k]), 1, int);
@@ -305,7 +342,7 @@ GMRFLib_matrix_tp *GMRFLib_read_fmesher_file(const char *filename, long int offs
 			}
 		}
 
-		GMRFLib_matrix_add_graph_and_hash(M);
+		GMRFLib_matrix_add_graph_and_index(M);
 
 		if (debug) {
 			double *A = Calloc(M->nrow * M->nrow, double);
@@ -480,98 +517,100 @@ int GMRFLib_write_fmesher_file(GMRFLib_matrix_tp *M, const char *filename, long
 	return (0);
 }
 
-int GMRFLib_matrix_add_graph_and_hash(GMRFLib_matrix_tp *M)
+int GMRFLib_matrix_add_graph_and_index(GMRFLib_matrix_tp *M)
 {
 	/*
-	 * add further info if this is a sparse matrix: the graph and the array of hash tables for the values. we slightly misuse the graph_tp and extend it to the
-	 * non-square matrix case. we just set n = nrow.
+	 * add further info if this is a sparse matrix: the graph and the CSR index for the values. we slightly misuse the graph_tp and extend it
+	 * to the non-square matrix case. we just set n = nrow.
+	 *
+	 * in the CSR index, the columns within each row are sorted, so elements are found by bisection. if (i,j) is given more than once, the last
+	 * one is used.
 	 */
 	if (!(M->i)) {
 		return GMRFLib_SUCCESS;
 	}
 
-	int i, j, k;
-	int nhold = 0, *hold = NULL, offset = 0;
-	GMRFLib_graph_tp *g = Calloc(1, GMRFLib_graph_tp);
-
-	g->n = M->nrow;
-	g->nbs = Calloc(g->n, int *);
-	g->nnbs = Calloc(g->n, int);
+	int nrow = M->nrow, elems = M->elems;
+	int *ptr = Calloc(nrow + 1, int);
+	int *pos = Calloc(nrow, int);
+	int *col = Calloc(IMAX(1, elems), int);
+	int *kidx = Calloc(IMAX(1, elems), int);
 
-	for (k = 0; k < M->elems; k++) {
-		if (M->i[k] != M->j[k]) {
-			g->nnbs[M->i[k]]++;
-		}
+	/*
+	 * bucket the elements by row, keeping the order in which they are given, and then sort each row by column
+	 */
+	for (int k = 0; k < elems; k++) {
+		ptr[M->i[k] + 1]++;
 	}
-
-	nhold = M->elems;
-	hold = Calloc(nhold, int);
-	offset = 0;
-	for (k = 0; k < M->nrow; k++) {
-		if (g->nnbs[k] == 0) {
-			g->nbs[k] = NULL;
-		} else {
-			g->nbs[k] = &hold[offset];
-			offset += g->nnbs[k];
-		}
+	for (int i = 0; i < nrow; i++) {
+		ptr[i + 1] += ptr[i];
 	}
-	assert(offset <= nhold);
-
-	for (k = 0; k < M->nrow; k++) {
-		g->nnbs[k] = 0;				       /* will use this array for counting and build it again */
+	Memcpy(pos, ptr, nrow * sizeof(int));
+	for (int k = 0; k < elems; k++) {
+		int kk = pos[M->i[k]]++;
+		col[kk] = M->j[k];
+		kidx[kk] = k;
 	}
+	Free(pos);
+
+	M->row_ptr = Calloc(nrow + 1, int);
+	M->col_idx = Calloc(IMAX(1, elems), int);
+	M->row_val = Calloc(IMAX(1, elems), double);
 
-	for (k = 0; k < M->elems; k++) {
-		if (M->i[k] != M->j[k]) {
-			i = M->i[k];
-			j = M->j[k];
-			g->nbs[i][g->nnbs[i]] = j;
-			g->nnbs[i]++;
+	int nnz = 0;
+	for (int i = 0; i < nrow; i++) {
+		int len = ptr[i + 1] - ptr[i];
+		int *c = col + ptr[i];
+		int *kk = kidx + ptr[i];
+
+		if (len > 1 && !GMRFLib_is_sorted_iinc(len, c)) {
+			my_sort2_ii(c, kk, len);
+		}
+		M->row_ptr[i] = nnz;
+		for (int r = 0; r < len; r++) {
+			int klast = kk[r];
+			while (r + 1 < len && c[r + 1] == c[r]) {
+				r++;
+				klast = IMAX(klast, kk[r]);
+			}
+			M->col_idx[nnz] = c[r];
+			M->row_val[nnz] = M->values[klast];
+			nnz++;
 		}
 	}
-
-	GMRFLib_graph_prepare(g);
-	M->graph = g;
+	M->row_ptr[nrow] = nnz;
+	Free(ptr);
+	Free(col);
+	Free(kidx);
 
 	/*
-	 * build the has table for quick retrival of values. use row or column indexed hash-table?
+	 * the graph are the off-diagonal elements
 	 */
-	if (M->nrow >= M->ncol || 1) {
-		// FORCE THIS TO HAPPEN
-		M->htable_column_order = 0;
-	} else {
-		M->htable_column_order = 1;
-	}
-	if (M->htable_column_order) {
-		/*
-		 *   need to count, as we cannot use g->nnbs
-		 */
-		int *nnbs_r = Calloc(M->ncol, int);
-		for (k = 0; k < M->elems; k++) {
-			if (M->i[k] != M->j[k]) {
-				nnbs_r[M->j[k]]++;
-			}
-		}
+	GMRFLib_graph_tp *g = Calloc(1, GMRFLib_graph_tp);
+	int *hold = Calloc(IMAX(1, nnz), int);
+	int offset = 0;
 
-		M->htable = Calloc(M->ncol, map_id *);
-		for (k = 0; k < M->ncol; k++) {
-			M->htable[k] = Calloc(1, map_id);
-			map_id_init_hint(M->htable[k], nnbs_r[k] + 1);
-		}
-		for (k = 0; k < M->elems; k++) {
-			map_id_set(M->htable[M->j[k]], M->i[k], M->values[k]);
-		}
-		Free(nnbs_r);
-	} else {
-		M->htable = Calloc(M->nrow, map_id *);
-		for (k = 0; k < M->nrow; k++) {
-			M->htable[k] = Calloc(1, map_id);
-			map_id_init_hint(M->htable[k], g->nnbs[k] + 1);
+	g->n = nrow;
+	g->nbs = Calloc(g->n, int *);
+	g->nnbs = Calloc(g->n, int);
+	for (int i = 0; i < nrow; i++) {
+		g->nbs[i] = &hold[offset];
+		for (int k = M->row_ptr[i]; k < M->row_ptr[i + 1]; k++) {
+			if (M->col_idx[k] != i) {
+				g->nbs[i][g->nnbs[i]++] = M->col_idx[k];
+			}
 		}
-		for (k = 0; k < M->elems; k++) {
-			map_id_set(M->htable[M->i[k]], M->j[k], M->values[k]);
+		offset += g->nnbs[i];
+		if (g->nnbs[i] == 0) {
+			g->nbs[i] = NULL;
 		}
 	}
+	if (offset == 0) {
+		Free(hold);
+	}
+
+	GMRFLib_graph_prepare(g);
+	M->graph = g;
 
 	return GMRFLib_SUCCESS;
 }
@@ -620,13 +659,9 @@ double GMRFLib_matrix_get(int i, int j, GMRFLib_matrix_tp *M)
 		assert(LEGAL(j, M->ncol));
 	}
 	if (M->i) {
-		double *d;
-		if (M->htable_column_order) {
-			d = map_id_ptr(M->htable[j], i);
-		} else {
-			d = map_id_ptr(M->htable[i], j);
-		}
-		return (d ? *d : 0.0);
+		int off = M->row_ptr[i];
+		int k = GMRFLib_iwhich_sorted(j, M->col_idx + off, M->row_ptr[i + 1] - off);
+		return (k >= 0 ? M->row_val[off + k] : 0.0);
 	} else {
 		int idx = i + j * M->nrow;
 		return (M->A ? M->A[idx] : (double) M->iA[idx]);
@@ -636,7 +671,7 @@ double GMRFLib_matrix_get(int i, int j, GMRFLib_matrix_tp *M)
 int GMRFLib_matrix_get_row(double *values, int i, GMRFLib_matrix_tp *M)
 {
 	/*
-	 * fill the i-th row in 'values'. THIS IS SLOW FOR SPARSE, FAST FOR DENSE!!
+	 * fill the i-th row in 'values'.
 	 */
 
 	int j;
@@ -646,32 +681,8 @@ int GMRFLib_matrix_get_row(double *values, int i, GMRFLib_matrix_tp *M)
 		/*
 		 * sparse-matrix 
 		 */
-		double *d;
-
-		if (M->htable_column_order) {
-
-			FIXME("column order should not be used");
-			assert(0 == 1);
-
-			for (j = 0; j < M->ncol; j++) {
-				d = map_id_ptr(M->htable[j], i);
-				values[j] = (d ? *d : 0.0);
-			}
-		} else {
-			if (0) {
-				// old and very slow
-				for (j = 0; j < M->ncol; j++) {
-					d = map_id_ptr(M->htable[i], j);
-					values[j] = (d ? *d : 0.0);
-				}
-			} else {
-				// much better
-				map_id_storage *ptr;
-				for (ptr = NULL; (ptr = map_id_nextptr(M->htable[i], ptr)) != NULL;) {
-					j = ptr->key;
-					values[j] = ptr->value;
-				}
-			}
+		for (int k = M->row_ptr[i]; k < M->row_ptr[i + 1]; k++) {
+			values[M->col_idx[k]] = M->row_val[k];
 		}
 	} else {
 		int idx = i;
@@ -691,28 +702,20 @@ int GMRFLib_matrix_get_row(double *values, int i, GMRFLib_matrix_tp *M)
 	return GMRFLib_SUCCESS;
 }
 
-int GMRFLib_matrix_get_row_idxval(GMRFLib_idxval_tp **row, int i, GMRFLib_matrix_tp *M, int sort)
+int GMRFLib_matrix_get_row_idxval(GMRFLib_idxval_tp **row, int i, GMRFLib_matrix_tp *M, int UNUSED(sort))
 {
 	/*
-	 * store values in 'row', must be NULL on entry. 
+	 * store values in 'row', must be NULL on entry. the row is always sorted, as the CSR index is.
 	 */
 
 	assert(*row == NULL);
 	if (M->i) {
-		if (M->htable_column_order) {
-			FIXME("column order should not be used");
-			assert(0 == 1);
-		} else {
-			map_id_storage *ptr;
-			for (ptr = NULL; (ptr = map_id_nextptr(M->htable[i], ptr)) != NULL;) {
-				GMRFLib_idxval_add(row, ptr->key, ptr->value);
-			}
-			if (sort) {
-				if (!GMRFLib_is_sorted_iinc((*row)->n, (*row)->idx)) {
-					GMRFLib_idxval_sort(*row);
-				}
-			}
-		}
+		int off = M->row_ptr[i];
+		int len = M->row_ptr[i + 1] - off;
+		GMRFLib_idxval_create_x(row, IMAX(1, len));
+		Memcpy((*row)->idx, M->col_idx + off, len * sizeof(int));
+		Memcpy((*row)->val, M->row_val + off, len * sizeof(double));
+		(*row)->n = len;
 	} else {
 		FIXME("NOT IMPLEMENTED");
 		assert(0 == 1);
@@ -732,26 +735,10 @@ int GMRFLib_matrix_free(GMRFLib_matrix_tp *M)
 		Free(M->iA);
 		Free(M->filename);
 
+		Free(M->row_ptr);
+		Free(M->col_idx);
+		Free(M->row_val);
 		GMRFLib_graph_free(M->graph);
-		if (M->htable) {
-			int k;
-			if (M->htable_column_order) {
-				for (k = 0; k < M->ncol; k++) {
-					if (M->htable[k]) {
-						map_id_free(M->htable[k]);
-					}
-					Free(M->htable[k]);
-				}
-			} else {
-				for (k = 0; k < M->nrow; k++) {
-					if (M->htable[k]) {
-						map_id_free(M->htable[k]);
-					}
-					Free(M->htable[k]);
-				}
-			}
-			Free(M->htable);
-		}
 
 		Free(M);
 	}
@@ -847,7 +834,7 @@ GMRFLib_matrix_tp *GMRFLib_matrix_transpose(GMRFLib_matrix_tp *M)
 		}
 	}
 
-	GMRFLib_matrix_add_graph_and_hash(N);
+	GMRFLib_matrix_add_graph_and_index(N);
 
 	N->filename = Strdup(M->filename);
 	N->offset = M->offset;
@@ -880,7 +867,203 @@ int GMRFLib_idxval_to_matrix(GMRFLib_matrix_tp **M, GMRFLib_idxval_tp **idxval,
 			(*M)->values[k] = idxval[i]->val[jj];
 		}
 	}
-	GMRFLib_matrix_add_graph_and_hash(*M);
+	GMRFLib_matrix_add_graph_and_index(*M);
+
+	return GMRFLib_SUCCESS;
+}
+
+GMRFLib_matrix_mmap_tp *GMRFLib_matrix_mmap_open(const char *filename)
+{
+	/*
+	 * map a fmesher-file with CSR storage into memory. return NULL if the file is not of this type. The data are not read but paged in
+	 * by the OS when accessed, so the matrix can be much larger than what we can hold in RAM.
+	 */
+
+	FILE *fp = fopen(filename, "rb");
+	if (!fp) {
+		return NULL;
+	}
+
+	int len_header = 0, header[8];
+	size_t nread = fread((void *) &len_header, sizeof(int), (size_t) 1, fp);
+	if (nread != 1 || len_header < 8 || len_header % 2 == 0) {
+		// an even length of the header makes 'ia' unaligned in the file, so then this file is read into memory instead
+		fclose(fp);
+		return NULL;
+	}
+	nread = fread((void *) header, sizeof(int), (size_t) 8, fp);
+	fclose(fp);
+	if (nread != 8 || header[4] != 1 || header[5] != 1 || header[6] != 0 || header[7] != GMRFLib_FMESHER_STORAGE_CSR) {
+		return NULL;
+	}
+
+	GMRFLib_matrix_mmap_tp *M = Calloc(1, GMRFLib_matrix_mmap_tp);
+	M->nrow = header[2];
+	M->ncol = header[3];
+	M->filename = Strdup(filename);
+
+	size_t off_ia = (size_t) (1 + len_header) * sizeof(int);
+
+#if defined(WINDOWS)
+	fp = fopen(filename, "rb");
+	fseek(fp, 0L, SEEK_END);
+	M->map_len = (size_t) ftell(fp);
+	rewind(fp);
+	M->map = Malloc(M->map_len, char);
+	nread = fread(M->map, (size_t) 1, M->map_len, fp);
+	fclose(fp);
+	assert(nread == M->map_len);
+#else
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		if (fd >= 0) {
+			close(fd);
+		}
+		GMRFLib_matrix_mmap_free(M);
+		return NULL;
+	}
+	M->map_len = (size_t) st.st_size;
+	M->map = mmap(NULL, M->map_len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (M->map == MAP_FAILED) {
+		M->map = NULL;
+		GMRFLib_matrix_mmap_free(M);
+		return NULL;
+	}
+#endif
+
+	/*
+	 * ia is int64_t, then comes ja (int), padded to an even length, and a (double). the map is page-aligned and the header and its
+	 * length is an even number of int's, so both 'ia' and 'a' are 8-byte aligned.
+	 */
+	char *base = (char *) M->map;
+	if (off_ia + (size_t) (M->nrow + 1) * sizeof(int64_t) > M->map_len) {
+		GMRFLib_matrix_mmap_free(M);
+		return NULL;
+	}
+	M->ia = (const int64_t *) (base + off_ia);
+	M->nnz = M->ia[M->nrow];
+	M->ja = (const int *) (base + off_ia + (size_t) (M->nrow + 1) * sizeof(int64_t));
+	M->a = (const double *) ((const char *) M->ja + (size_t) (M->nnz + M->nnz % 2) * sizeof(int));
+
+	size_t len = (size_t) ((const char *) (M->a + M->nnz) - base);
+	if (len > M->map_len) {
+		char *msg = NULL;
+		GMRFLib_sprintf(&msg, "File [%s] is truncated: expected %zu bytes, got %zu", filename, len, M->map_len);
+		GMRFLib_ERROR_MSG_NO_RETURN(GMRFLib_EMISC, msg);
+		GMRFLib_matrix_mmap_free(M);
+		return NULL;
+	}
+
+	return M;
+}
+
+int GMRFLib_matrix_mmap_free(GMRFLib_matrix_mmap_tp *M)
+{
+	if (M) {
+		if (M->map) {
+#if defined(WINDOWS)
+			Free(M->map);
+#else
+			munmap(M->map, M->map_len);
+#endif
+		}
+		Free(M->filename);
+		Free(M);
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_matrix_mmap_advise(GMRFLib_matrix_mmap_tp *M, int row_from, int row_to, int willneed)
+{
+	/*
+	 * tell the OS that rows [row_from, row_to) are needed soon, or not needed anymore, so that streaming through the matrix in
+	 * row-blocks, does not keep more than one block resident.
+	 */
+
+#if !defined(WINDOWS)
+	if (!M || row_from >= row_to) {
+		return GMRFLib_SUCCESS;
+	}
+
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+	int advice = (willneed ? MADV_WILLNEED : MADV_DONTNEED);
+	const char *base = (const char *) M->map;
+	const char *ranges[2][2] = {
+		{(const char *) (M->ja + M->ia[row_from]), (const char *) (M->ja + M->ia[row_to])},
+		{(const char *) (M->a + M->ia[row_from]), (const char *) (M->a + M->ia[row_to])}
+	};
+
+	for (int r = 0; r < 2; r++) {
+		size_t from = (size_t) (ranges[r][0] - base);
+		size_t to = (size_t) (ranges[r][1] - base);
+		// round inwards for DONTNEED, so we do not drop the pages of the neighbouring blocks
+		from = (willneed ? (from / page) * page : ((from + page - 1) / page) * page);
+		to = (willneed ? ((to + page - 1) / page) * page : (to / page) * page);
+		to = (to > M->map_len ? M->map_len : to);
+		if (to > from) {
+			madvise((void *) (base + from), to - from, advice);
+		}
+	}
+#endif
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_matrix_mmap_get_row_idxval(GMRFLib_idxval_tp **row, int i, GMRFLib_matrix_mmap_tp *M, int sort)
+{
+	/*
+	 * set 'row' to row 'i' of 'M'. if 'row' is non-NULL on entry, its storage is reused and its old content is lost.
+	 */
+
+	if (*row) {
+		(*row)->n = 0;
+	}
+	for (int64_t k = M->ia[i]; k < M->ia[i + 1]; k++) {
+		GMRFLib_idxval_add(row, M->ja[k], M->a[k]);
+	}
+	if (!*row) {
+		GMRFLib_idxval_create(row);
+	}
+	if (sort) {
+		if (!GMRFLib_is_sorted_iinc((*row)->n, (*row)->idx)) {
+			GMRFLib_idxval_sort(*row);
+		}
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_matrix_mmap_write(GMRFLib_matrix_mmap_tp *M, const char *filename)
+{
+	/*
+	 * write a copy of the mapped file, one block at the time
+	 */
+
+	if (!M) {
+		return GMRFLib_SUCCESS;
+	}
+
+	FILE *fp = fopen(filename, "wb");
+	if (!fp) {
+		char *msg = NULL;
+		GMRFLib_sprintf(&msg, "Failed to open file [%s]", filename);
+		GMRFLib_ERROR_MSG(GMRFLib_EOPENFILE, msg);
+	}
+
+	const size_t block = 64L * 1024L * 1024L;
+	const char *base = (const char *) M->map;
+	for (size_t off = 0; off < M->map_len; off += block) {
+		size_t len = (M->map_len - off < block ? M->map_len - off : block);
+		size_t nwrite = fwrite((const void *) (base + off), (size_t) 1, len, fp);
+		if (nwrite != len) {
+			fclose(fp);
+			char *msg = NULL;
+			GMRFLib_sprintf(&msg, "Failed to write [%zu] bytes to file [%s]", len, filename);
+			GMRFLib_ERROR_MSG(GMRFLib_EMISC, msg);
+		}
+	}
+	fclose(fp);
 
 	return GMRFLib_SUCCESS;
 }
@@ -57,9 +57,10 @@ __BEGIN_DECLS
 	/*
 	 * these are only defined if the matrix is sparse 
 	 */
-	int htable_column_order;			       /* stored by column or row? default is row which is = 0 */
 	GMRFLib_graph_tp *graph;			       /* (possibly nonsymmetric) graph */
-	map_id **htable;				       /* array of hash-tables for the values */
+	int *row_ptr;					       /* CSR index: row i is in [row_ptr[i], row_ptr[i+1]) */
+	int *col_idx;					       /* with increasing column index */
+	double *row_val;
 
 	/*
 	 * on reading; 'values' are always set. on writing; only one of these can be set. 
@@ -82,6 +83,33 @@ __BEGIN_DECLS
 	long int tell;					       /* the position where this matrix ended */
 } GMRFLib_matrix_tp;
 
+/* 
+   storagetype = 2 is a sparse general matrix of doubles stored in CSR format, with header[1] = -1 if the number of elements does not fit
+   in an int. after the header comes 'int64_t ia[nrow+1]', 'int ja[nnz]' and 'double a[nnz]'. the rows of a block [r0,r1) are in
+   ja[ia[r0]...ia[r1]-1] and a[ia[r0]...ia[r1]-1], so this format can be memory-mapped and streamed in row-blocks. to keep 'ia' and 'a'
+   8-byte aligned in the file, the header has an odd length (so the header and its length is an even number of int's), and 'ja' is
+   followed by one int of padding if nnz is odd.
+ */
+#define GMRFLib_FMESHER_STORAGE_CSR (2)
+
+/* 
+   the number of rows in each block, when reading a memory-mapped matrix. this is only used to read pA while pA %*% A is built
+ */
+#define GMRFLib_MATRIX_MMAP_BLOCK (65536)
+
+typedef struct {
+	int nrow;
+	int ncol;
+	int64_t nnz;
+	const int64_t *ia;
+	const int *ja;
+	const double *a;
+
+	char *filename;
+	void *map;
+	size_t map_len;
+} GMRFLib_matrix_mmap_tp;
+
 GMRFLib_matrix_tp *GMRFLib_matrix_1(int n);
 GMRFLib_matrix_tp *GMRFLib_read_fmesher_file(const char *filename, long int offset, int whence);
 GMRFLib_matrix_tp *GMRFLib_matrix_transpose(GMRFLib_matrix_tp * M);
@@ -91,10 +119,16 @@ int GMRFLib_file_exists(const char *filename, const char *mode);
 int GMRFLib_is_fmesher_file(const char *filename, long int offset, int whence);
 int GMRFLib_matrix_free(GMRFLib_matrix_tp * M);
 int GMRFLib_write_fmesher_file(GMRFLib_matrix_tp * M, const char *filename, long int offset, int whence);
-int GMRFLib_matrix_add_graph_and_hash(GMRFLib_matrix_tp * M);
+int GMRFLib_matrix_add_graph_and_index(GMRFLib_matrix_tp * M);
 int GMRFLib_matrix_get_row(double *values, int i, GMRFLib_matrix_tp * M);
 int GMRFLib_matrix_get_row_idxval(GMRFLib_idxval_tp ** row, int i, GMRFLib_matrix_tp * M, int sort);
 int GMRFLib_idxval_to_matrix(GMRFLib_matrix_tp ** M, GMRFLib_idxval_tp ** idxval, int nrow, int ncol);
 
+GMRFLib_matrix_mmap_tp *GMRFLib_matrix_mmap_open(const char *filename);
+int GMRFLib_matrix_mmap_advise(GMRFLib_matrix_mmap_tp * M, int row_from, int row_to, int willneed);
+int GMRFLib_matrix_mmap_free(GMRFLib_matrix_mmap_tp * M);
+int GMRFLib_matrix_mmap_get_row_idxval(GMRFLib_idxval_tp ** row, int i, GMRFLib_matrix_mmap_tp * M, int sort);
+int GMRFLib_matrix_mmap_write(GMRFLib_matrix_mmap_tp * M, const char *filename);
+
 __END_DECLS
 #endif
@@ -167,6 +167,10 @@ int GMRFLib_sort2_id_cut_off = 50;
 int GMRFLib_sort2_dd_cut_off = 70;
 int GMRFLib_internal_opt = 1;
 int GMRFLib_save_memory = 0;
+int GMRFLib_arena_enable = 1;				       // use per-thread arenas for workspaces
+int GMRFLib_profile_level = 0;				       // set from INLA_PROFILE, see profile.c
+size_t GMRFLib_factorise_count = 0;			       // number of factorisations, see bench.c
+int GMRFLib_memacct_dump = 0;				       // write the memory accounting report, see memacct.c
 
 int GMRFLib_write_state = 0;
 int GMRFLib_gaussian_data = 0;
@@ -134,6 +134,10 @@ extern double **GMRFLib_dot_product_optim_report;
 extern double GMRFLib_dot_product_gain;			       // set to < 0 to disable it
 extern int GMRFLib_internal_opt;
 extern int GMRFLib_save_memory;
+extern int GMRFLib_arena_enable;
+extern int GMRFLib_profile_level;
+extern size_t GMRFLib_factorise_count;
+extern int GMRFLib_memacct_dump;
 
 extern int GMRFLib_sort2_id_cut_off;
 extern int GMRFLib_sort2_dd_cut_off;
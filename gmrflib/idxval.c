@@ -1163,8 +1163,10 @@ int GMRFLib_val_free(GMRFLib_val_tp *hold)
 int GMRFLib_idxval_free(GMRFLib_idxval_tp *hold)
 {
 	if (hold) {
-		Free(hold->idx);
-		Free(hold->val);
+		if (!hold->csr_view) {
+			Free(hold->idx);
+			Free(hold->val);
+		}
 		Free(hold->g_idx);
 		Free(hold->g_val);
 		Free(hold->g_len);
@@ -1296,6 +1298,7 @@ int GMRFLib_idxval_add(GMRFLib_idxval_tp **hold, int idx, double val)
 		GMRFLib_idxval_create(hold);
 	}
 	if ((*hold)->n == (*hold)->n_alloc) {
+		GMRFLib_ASSERT(!(*hold)->csr_view, GMRFLib_EPARAMETER);
 		(*hold)->n_alloc += IDX_ALLOC_INCREASE;
 		(*hold)->idx = Realloc((*hold)->idx, (*hold)->n_alloc, int);
 		(*hold)->val = Realloc((*hold)->val, (*hold)->n_alloc, double);
@@ -1342,6 +1345,7 @@ int GMRFLib_idxval_addto(GMRFLib_idxval_tp **hold, int idx, double val)
 	}
 
 	if ((*hold)->n == (*hold)->n_alloc) {
+		GMRFLib_ASSERT(!(*hold)->csr_view, GMRFLib_EPARAMETER);
 		(*hold)->n_alloc += IDX_ALLOC_INCREASE;
 		(*hold)->idx = Realloc((*hold)->idx, (*hold)->n_alloc, int);
 		(*hold)->val = Realloc((*hold)->val, (*hold)->n_alloc, double);
@@ -1352,3 +1356,115 @@ int GMRFLib_idxval_addto(GMRFLib_idxval_tp **hold, int idx, double val)
 
 	return GMRFLib_SUCCESS;
 }
+
+GMRFLib_idxval_csr_tp *GMRFLib_idxval_csr_create(GMRFLib_idxval_tp **rows, int nrow, int ncol, int npart)
+{
+	/*
+	 * compress the idxval 'rows' into a CSR-matrix. rows[i] can be NULL. the rows are split into 'npart' partitions
+	 * with about the same number of non-zeros, so they can be done in parallel with the same amount of work.
+	 */
+	GMRFLib_idxval_csr_tp *M = Calloc(1, GMRFLib_idxval_csr_tp);
+
+	M->nrow = nrow;
+	M->ncol = ncol;
+	M->ia = Calloc(nrow + 1, int);
+	for (int i = 0; i < nrow; i++) {
+		M->ia[i + 1] = M->ia[i] + (rows[i] ? rows[i]->n : 0);
+	}
+
+	int nnz = M->ia[nrow];
+	M->ja = Calloc(IMAX(1, nnz), int);
+	M->a = Calloc(IMAX(1, nnz), double);
+	for (int i = 0; i < nrow; i++) {
+		if (rows[i] && rows[i]->n) {
+			Memcpy(M->ja + M->ia[i], rows[i]->idx, rows[i]->n * sizeof(int));
+			Memcpy(M->a + M->ia[i], rows[i]->val, rows[i]->n * sizeof(double));
+		}
+	}
+
+	npart = IMAX(1, IMIN(npart, nrow));
+	M->npart = npart;
+	M->part = Calloc(npart + 1, int);
+	for (int k = 1, i = 0; k < npart; k++) {
+		size_t target = ((size_t) nnz * k) / npart;
+		while (i < nrow && (size_t) M->ia[i] < target) {
+			i++;
+		}
+		M->part[k] = IMAX(i, M->part[k - 1]);
+	}
+	M->part[npart] = nrow;
+
+	return M;
+}
+
+int GMRFLib_idxval_csr_share(GMRFLib_idxval_csr_tp *M, GMRFLib_idxval_tp **rows)
+{
+	/*
+	 * let the 'rows' that 'M' was created from use the storage in 'M' for their idx and val, and free their own. the rows
+	 * must not be changed after this, and 'M' must not be free'd before the rows.
+	 */
+	for (int i = 0; i < M->nrow; i++) {
+		GMRFLib_idxval_tp *h = rows[i];
+		if (h && !h->csr_view) {
+			Free(h->idx);
+			Free(h->val);
+			h->idx = M->ja + M->ia[i];
+			h->val = M->a + M->ia[i];
+			h->n_alloc = h->n;
+			h->iaddto = 0;
+			h->csr_view = 1;
+		}
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_idxval_csr_free(GMRFLib_idxval_csr_tp *M)
+{
+	if (M) {
+		Free(M->part);
+		Free(M->ia);
+		Free(M->ja);
+		Free(M->a);
+		Free(M);
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_idxval_csr_mv(double *y, GMRFLib_idxval_csr_tp *M, double *x)
+{
+	/*
+	 * y = M x, in parallel over the partitions
+	 */
+	int *ia = M->ia, *ja = M->ja;
+	double *a = M->a;
+
+#define CODE_BLOCK							\
+	for (int k = 0; k < M->npart; k++) {				\
+		int i = M->part[k];					\
+		int i_end = M->part[k + 1];				\
+		while (i < i_end) {					\
+			int j = ia[i];					\
+			/* rows with one non-zero are common, do them four at the time */ \
+			if (i + 3 < i_end && ia[i + 1] - j == 1 && ia[i + 2] - j == 2 && ia[i + 3] - j == 3 && ia[i + 4] - j == 4) { \
+				y[i + 0] = a[j + 0] * x[ja[j + 0]];	\
+				y[i + 1] = a[j + 1] * x[ja[j + 1]];	\
+				y[i + 2] = a[j + 2] * x[ja[j + 2]];	\
+				y[i + 3] = a[j + 3] * x[ja[j + 3]];	\
+				i += 4;					\
+			} else {					\
+				double s = 0.0;				\
+				_Pragma("omp simd reduction(+: s)")	\
+					for (int jj = j; jj < ia[i + 1]; jj++) { \
+						s += a[jj] * x[ja[jj]];	\
+					}				\
+				y[i] = s;				\
+				i++;					\
+			}						\
+		}							\
+	}
+
+	RUN_CODE_BLOCK(M->npart, 0, 0);
+#undef CODE_BLOCK
+
+	return GMRFLib_SUCCESS;
+}
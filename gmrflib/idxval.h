@@ -94,6 +94,7 @@ typedef struct {
 	int n;
 	int n_alloc;
 	int iaddto;
+	int csr_view;					       /* idx and val point into a GMRFLib_idxval_csr_tp and are not free'd here */
 	int g_n;					       /* number of groups with sequential indices */
 	int g_n_mem;
 	int *idx;
@@ -108,6 +109,20 @@ typedef struct {
 	GMRFLib_dot_product_tp *dot_product_func;
 } GMRFLib_idxval_tp;
 
+/*
+ * a set of idxval-rows compressed into one CSR-matrix, for the matrix-vector product. the rows are split into 'npart'
+ * partitions with about the same number of non-zeros, rows part[k]...part[k+1]-1 are in partition k.
+ */
+typedef struct {
+	int nrow;
+	int ncol;
+	int npart;
+	int *part;
+	int *ia;					       /* length nrow+1 */
+	int *ja;					       /* length nnz */
+	double *a;					       /* length nnz */
+} GMRFLib_idxval_csr_tp;
+
 typedef struct {
 	int submat_id;
 	int submat_row;
@@ -133,6 +148,8 @@ GMRFLib_idx2_tp **GMRFLib_idx2_ncreate_x(int n, int len);
 GMRFLib_idx_tp **GMRFLib_idx_ncreate(int n);
 GMRFLib_idx_tp **GMRFLib_idx_ncreate(int n);
 GMRFLib_idx_tp **GMRFLib_idx_ncreate_x(int n, int len);
+GMRFLib_idxval_csr_tp *GMRFLib_idxval_csr_create(GMRFLib_idxval_tp ** rows, int nrow, int ncol, int npart);
+int GMRFLib_idxval_csr_share(GMRFLib_idxval_csr_tp * M, GMRFLib_idxval_tp ** rows);
 GMRFLib_idxval_tp **GMRFLib_idxval_ncreate(int n);
 GMRFLib_idxval_tp **GMRFLib_idxval_ncreate_x(int n, int len);
 GMRFLib_val_tp **GMRFLib_val_ncreate(int n);
@@ -162,6 +179,8 @@ int GMRFLib_idx_uniq(GMRFLib_idx_tp * hold);
 int GMRFLib_idxval_add(GMRFLib_idxval_tp ** hold, int idx, double val);
 int GMRFLib_idxval_addto(GMRFLib_idxval_tp ** hold, int idx, double val);
 int GMRFLib_idxval_create(GMRFLib_idxval_tp ** hold);
+int GMRFLib_idxval_csr_free(GMRFLib_idxval_csr_tp * M);
+int GMRFLib_idxval_csr_mv(double *y, GMRFLib_idxval_csr_tp * M, double *x);
 int GMRFLib_idxval_create_x(GMRFLib_idxval_tp ** hold, int len);
 int GMRFLib_idxval_create_x(GMRFLib_idxval_tp ** hold, int len);
 int GMRFLib_idxval_free(GMRFLib_idxval_tp * hold);
@@ -0,0 +1,343 @@
+
+/* memacct.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+/*
+ * Memory accounting per subsystem. If compiled with -DGMRFLib_MEMORY_ACCOUNTING (for both gmrflib and inlaprog), then Calloc(),
+ * Malloc(), Realloc() and Free() go through GMRFLib_calloc() and friends, which call GMRFLib_memacct_alloc() and GMRFLib_memacct_free().
+ * Each allocation is tagged from its call site: functions with 'Qinv' or 'config' in their name give 'Qinv' and 'configs', otherwise
+ * the source file decides (see memacct_files[]). Generic containers, like the maps in smap.c, inherit the tag the caller has set
+ * with GMRFLib_memacct_scope() for the current thread, or 'other' if none is set. The tag of each live pointer is kept in a sharded hash-table, and its size is what
+ * the allocator reports as usable, so we account for what is actually used. Memory allocated by external libraries, or by Strdup(),
+ * is not accounted for.
+ *
+ * The current and peak bytes for each tag are written by GMRFLib_memacct_report(). A report is also written to stderr every
+ * $INLA_MEMACCT seconds, and after the signal SIGUSR2 (which sets GMRFLib_memacct_dump). These are checked once a second by a
+ * separate thread, so they also appear while the computations do not allocate.
+ *
+ * To enable, add -DGMRFLib_MEMORY_ACCOUNTING to FLAGS in both gmrflib/Makefile and inlaprog/Makefile and rebuild both. Without it,
+ * this costs nothing and the report only says that the accounting is disabled.
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/hashP.h"
+#include "GMRFLib/memacct.h"
+
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#define MEMACCT_NSHARD (64)
+#define MEMACCT_NCACHE (256)
+#define MEMACCT_INHERIT (-1)
+
+typedef struct {
+	size_t current;
+	size_t peak;
+	size_t nalloc;
+} memacct_count_tp;
+
+typedef struct {
+	const char *file;
+	const char *funcname;
+	int tag;
+} memacct_cache_tp;
+
+static const struct {
+	const char *file;
+	int tag;
+} memacct_files[] = {
+	{ "graph.c", GMRFLib_MEMTAG_GRAPH },
+	{ "graph-edit.c", GMRFLib_MEMTAG_GRAPH },
+	{ "inla-graph.c", GMRFLib_MEMTAG_GRAPH },
+	{ "sparse-interface.c", GMRFLib_MEMTAG_FACTOR },
+	{ "smtp-band.c", GMRFLib_MEMTAG_FACTOR },
+	{ "smtp-taucs.c", GMRFLib_MEMTAG_FACTOR },
+	{ "smtp-pardiso.c", GMRFLib_MEMTAG_FACTOR },
+	{ "problem-setup.c", GMRFLib_MEMTAG_FACTOR },
+	{ "tabulate-Qfunc.c", GMRFLib_MEMTAG_FACTOR },
+	{ "smap.c", MEMACCT_INHERIT },
+	{ "density.c", GMRFLib_MEMTAG_DENSITIES },
+	{ "density-pool.c", GMRFLib_MEMTAG_DENSITIES },
+	{ "pre-opt.c", GMRFLib_MEMTAG_PREOPT },
+	{ "approx-inference.c", GMRFLib_MEMTAG_AI_STORE },
+	{ "approx-inference--classic.c", GMRFLib_MEMTAG_AI_STORE },
+	{ "config-stream.c", GMRFLib_MEMTAG_CONFIGS },
+	{ "inla-read.c", GMRFLib_MEMTAG_DATA },
+	{ "inla-parse.c", GMRFLib_MEMTAG_DATA },
+	{ "iniparser.c", GMRFLib_MEMTAG_DATA },
+	{ "dictionary.c", GMRFLib_MEMTAG_DATA },
+	{ "arena.c", GMRFLib_MEMTAG_WORKSPACE }
+};
+
+static memacct_count_tp memacct_count[GMRFLib_MEMTAG_N + 1];   /* the last one is the total */
+static map_vpi memacct_map[MEMACCT_NSHARD];
+static omp_lock_t memacct_lock[MEMACCT_NSHARD];
+static int memacct_ready = 0;
+static double memacct_period = 0.0;
+static double memacct_tref = 0.0;
+
+static memacct_cache_tp *memacct_cache = NULL;
+static int memacct_scope = MEMACCT_INHERIT;
+#pragma omp threadprivate(memacct_cache, memacct_scope)
+
+static void *memacct_watch(void *UNUSED(arg))
+{
+	/*
+	 * write a report if requested by the signal, or if its time for the periodic one. runs in its own thread, so this does not
+	 * depend on anyone allocating
+	 */
+	while (1) {
+		sleep(1);
+
+		int dump = 0;
+		if (GMRFLib_memacct_dump) {
+			dump = 1;
+		} else if (memacct_period > 0.0) {
+			dump = (GMRFLib_timer() - memacct_tref >= memacct_period);
+		}
+
+		if (dump) {
+			GMRFLib_memacct_dump = 0;
+			memacct_tref = GMRFLib_timer();
+			GMRFLib_memacct_report(stderr);
+		}
+	}
+	return NULL;
+}
+
+static void memacct_init(void)
+{
+#pragma omp critical (Name_11a0777a9c4f636efdc3fffb0001d910d4c0c4f9)
+	{
+		if (!memacct_ready) {
+			for (int i = 0; i < MEMACCT_NSHARD; i++) {
+				map_vpi_init_hint(&memacct_map[i], (mapkit_size_t) 1024);
+				omp_init_lock(&memacct_lock[i]);
+			}
+			char *period = getenv("INLA_MEMACCT");
+			memacct_period = (period ? atof(period) : 0.0);
+			memacct_tref = GMRFLib_timer();
+
+			pthread_t thread;
+			if (!pthread_create(&thread, NULL, memacct_watch, NULL)) {
+				pthread_detach(thread);
+			}
+#pragma omp flush
+			memacct_ready = 1;
+		}
+	}
+}
+
+static size_t memacct_size(void *ptr)
+{
+#if defined(__APPLE__)
+	return malloc_size(ptr);
+#elif defined(WINDOWS)
+	return _msize(ptr);
+#else
+	return malloc_usable_size(ptr);
+#endif
+}
+
+static int memacct_shard(void *ptr)
+{
+	uintptr_t p = (uintptr_t) ptr;
+	return (int) (((p >> 4) ^ (p >> 12)) % MEMACCT_NSHARD);
+}
+
+static int memacct_tag(const char *file, const char *funcname)
+{
+	/*
+	 * the tag of a call site is cached on the addresses of the strings for the file and function name, as they are static
+	 */
+	if (!memacct_cache) {
+		memacct_cache = (memacct_cache_tp *) calloc(MEMACCT_NCACHE, sizeof(memacct_cache_tp));
+	}
+
+	uintptr_t h = ((uintptr_t) funcname >> 3) ^ ((uintptr_t) file >> 7);
+	memacct_cache_tp *c = &memacct_cache[h % MEMACCT_NCACHE];
+	if (c->file == file && c->funcname == funcname) {
+		return (c->tag == MEMACCT_INHERIT ? (memacct_scope >= 0 ? memacct_scope : GMRFLib_MEMTAG_OTHER) : c->tag);
+	}
+
+	int tag = GMRFLib_MEMTAG_OTHER;
+	if (funcname && strstr(funcname, "Qinv")) {
+		tag = GMRFLib_MEMTAG_QINV;
+	} else if (funcname && strstr(funcname, "config")) {
+		tag = GMRFLib_MEMTAG_CONFIGS;
+	} else if (file) {
+		const char *base = strrchr(file, '/');
+		base = (base ? base + 1 : file);
+		for (size_t i = 0; i < sizeof(memacct_files) / sizeof(memacct_files[0]); i++) {
+			if (!strcmp(base, memacct_files[i].file)) {
+				tag = memacct_files[i].tag;
+				break;
+			}
+		}
+	}
+	c->file = file;
+	c->funcname = funcname;
+	c->tag = tag;
+
+	return (tag == MEMACCT_INHERIT ? (memacct_scope >= 0 ? memacct_scope : GMRFLib_MEMTAG_OTHER) : tag);
+}
+
+static void memacct_add(int tag, size_t size)
+{
+	size_t cur, tcur;
+
+#pragma omp atomic capture
+	cur = memacct_count[tag].current += size;
+#pragma omp atomic capture
+	tcur = memacct_count[GMRFLib_MEMTAG_N].current += size;
+#pragma omp atomic
+	memacct_count[tag].nalloc++;
+#pragma omp atomic
+	memacct_count[GMRFLib_MEMTAG_N].nalloc++;
+
+	if (cur > memacct_count[tag].peak || tcur > memacct_count[GMRFLib_MEMTAG_N].peak) {
+#pragma omp critical (Name_b28e640154b623c8451316ea43a61f47c4c082fb)
+		{
+			if (cur > memacct_count[tag].peak) {
+				memacct_count[tag].peak = cur;
+			}
+			if (tcur > memacct_count[GMRFLib_MEMTAG_N].peak) {
+				memacct_count[GMRFLib_MEMTAG_N].peak = tcur;
+			}
+		}
+	}
+}
+#endif
+
+int GMRFLib_memacct_enabled(void)
+{
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	return GMRFLib_TRUE;
+#else
+	return GMRFLib_FALSE;
+#endif
+}
+
+int GMRFLib_memacct_scope(int tag)
+{
+	/*
+	 * set the tag for the allocations in smap.c (and friends) for this thread, and return the previous one
+	 */
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	int old = memacct_scope;
+	memacct_scope = tag;
+	return old;
+#else
+	return -1;
+#endif
+}
+
+void GMRFLib_memacct_alloc(void *ptr, const char *file, const char *funcname)
+{
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	if (!ptr) {
+		return;
+	}
+	if (!memacct_ready) {
+		memacct_init();
+	}
+
+	int tag = memacct_tag(file, funcname);
+	int s = memacct_shard(ptr);
+
+	omp_set_lock(&memacct_lock[s]);
+	map_vpi_set(&memacct_map[s], ptr, tag);
+	omp_unset_lock(&memacct_lock[s]);
+
+	memacct_add(tag, memacct_size(ptr));
+#endif
+}
+
+void GMRFLib_memacct_free(void *ptr)
+{
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	if (!ptr || !memacct_ready) {
+		return;
+	}
+
+	int s = memacct_shard(ptr);
+	int *tag_ptr = NULL, tag = -1;
+
+	omp_set_lock(&memacct_lock[s]);
+	tag_ptr = map_vpi_ptr(&memacct_map[s], ptr);
+	if (tag_ptr) {
+		tag = *tag_ptr;
+		map_vpi_removeptr(&memacct_map[s], tag_ptr);
+	}
+	omp_unset_lock(&memacct_lock[s]);
+
+	// not allocated by us, so it is not accounted for
+	if (tag < 0) {
+		return;
+	}
+
+	size_t size = memacct_size(ptr);
+#pragma omp atomic
+	memacct_count[tag].current -= size;
+#pragma omp atomic
+	memacct_count[GMRFLib_MEMTAG_N].current -= size;
+#endif
+}
+
+int GMRFLib_memacct_report(FILE *fp)
+{
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	fp = (fp ? fp : stdout);
+	fprintf(fp, "\nMemory accounting (Mb)\n");
+	fprintf(fp, "\t%-10s %12s %12s %12s\n", "tag", "current", "peak", "nalloc");
+	for (int tag = 0; tag <= GMRFLib_MEMTAG_N; tag++) {
+		memacct_count_tp *c = &memacct_count[tag];
+		if (c->peak > 0 || tag == GMRFLib_MEMTAG_N) {
+			fprintf(fp, "\t%-10s %12.1f %12.1f %12zu\n", (tag == GMRFLib_MEMTAG_N ? "total" : GMRFLib_MEMTAG_NAME(tag)),
+				c->current / 1048576.0, c->peak / 1048576.0, c->nalloc);
+		}
+	}
+	fprintf(fp, "\n");
+	fflush(fp);
+#else
+	fp = (fp ? fp : stdout);
+	fprintf(fp, "\nMemory accounting is disabled; rebuild gmrflib and inlaprog with -DGMRFLib_MEMORY_ACCOUNTING to enable it\n\n");
+	fflush(fp);
+#endif
+	return GMRFLib_SUCCESS;
+}
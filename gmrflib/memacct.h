@@ -0,0 +1,101 @@
+
+/* memacct.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file memacct.h
+  \brief Typedefs for \ref memacct.c
+*/
+
+#ifndef __GMRFLib_MEMACCT_H__
+#define __GMRFLib_MEMACCT_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+/*
+ * the subsystems that the allocations are accounted to. see memacct.c for how an allocation is tagged
+ */
+typedef enum {
+	GMRFLib_MEMTAG_OTHER = 0,
+	GMRFLib_MEMTAG_GRAPH,
+	GMRFLib_MEMTAG_FACTOR,
+	GMRFLib_MEMTAG_QINV,
+	GMRFLib_MEMTAG_DENSITIES,
+	GMRFLib_MEMTAG_PREOPT,
+	GMRFLib_MEMTAG_AI_STORE,
+	GMRFLib_MEMTAG_CONFIGS,
+	GMRFLib_MEMTAG_DATA,
+	GMRFLib_MEMTAG_WORKSPACE,
+	GMRFLib_MEMTAG_N
+} GMRFLib_memtag_tp;
+
+#define GMRFLib_MEMTAG_NAME(tag)					\
+	((tag) == GMRFLib_MEMTAG_GRAPH ? "graph" :			\
+	 ((tag) == GMRFLib_MEMTAG_FACTOR ? "factor" :			\
+	  ((tag) == GMRFLib_MEMTAG_QINV ? "Qinv" :			\
+	   ((tag) == GMRFLib_MEMTAG_DENSITIES ? "densities" :		\
+	    ((tag) == GMRFLib_MEMTAG_PREOPT ? "preopt" :		\
+	     ((tag) == GMRFLib_MEMTAG_AI_STORE ? "ai_store" :		\
+	      ((tag) == GMRFLib_MEMTAG_CONFIGS ? "configs" :		\
+	       ((tag) == GMRFLib_MEMTAG_DATA ? "data" :			\
+		((tag) == GMRFLib_MEMTAG_WORKSPACE ? "workspace" : "other")))))))))
+
+/*
+ * GMRFLib_memacct_scope() sets the tag that allocations in smap.c are accounted to, for the calling thread, and returns the previous
+ * one, which is to be restored afterwards:
+ *
+ *     int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
+ *     ...
+ *     GMRFLib_memacct_scope(memtag);
+ *
+ * accounting is enabled by compiling gmrflib and inlaprog with -DGMRFLib_MEMORY_ACCOUNTING; see memacct.c.
+ */
+int GMRFLib_memacct_enabled(void);
+int GMRFLib_memacct_scope(int tag);
+int GMRFLib_memacct_report(FILE * fp);
+void GMRFLib_memacct_alloc(void *ptr, const char *file, const char *funcname);
+void GMRFLib_memacct_free(void *ptr);
+
+__END_DECLS
+#endif
@@ -59,6 +59,128 @@ int GMRFLib_openmp_implement_strategy_special(int outer, int inner)
 	return GMRFLib_SUCCESS;
 }
 
+static GMRFLib_openmp_autotune_tp *openmp_autotune_get(GMRFLib_openmp_place_tp place)
+{
+	// the state for the places that are autotuned, or NULL. the state is kept for the whole run
+	static GMRFLib_openmp_autotune_tp at[GMRFLib_OPENMP_PLACES_NONE + 1];
+
+	switch (place) {
+	case GMRFLib_OPENMP_PLACES_OPTIMIZE:
+	case GMRFLib_OPENMP_PLACES_HESSIAN:
+	case GMRFLib_OPENMP_PLACES_INTEGRATE_HYPERPAR:
+	case GMRFLib_OPENMP_PLACES_COMBINE:
+		return &at[place];
+	default:
+		return NULL;
+	}
+}
+
+static void openmp_autotune_add(GMRFLib_openmp_autotune_tp *at, int outer, int inner)
+{
+	outer = IMAX(1, outer);
+	inner = IMAX(1, inner);
+	if (at->ncand == GMRFLib_OPENMP_AUTOTUNE_MAX) {
+		return;
+	}
+	for (int k = 0; k < at->ncand; k++) {
+		if (at->outer[k] == outer && at->inner[k] == inner) {
+			return;
+		}
+	}
+	at->outer[at->ncand] = outer;
+	at->inner[at->ncand] = inner;
+	at->ncand++;
+}
+
+static void openmp_autotune_apply(GMRFLib_openmp_autotune_tp *at)
+{
+	int k = (at->best >= 0 ? at->best : at->trial);
+
+	GMRFLib_openmp->max_threads_outer = at->outer[k];
+	GMRFLib_openmp->max_threads_inner = at->inner[k];
+	if (at->inner[k] > 1 && !omp_get_nested()) {
+		omp_set_nested(1);
+	}
+	omp_set_num_threads(GMRFLib_openmp->max_threads_outer);
+}
+
+static void openmp_autotune_select(GMRFLib_openmp_place_tp place)
+{
+	// the first time a place is visited, the candidates are the split from the tables and then splits with fewer threads in the outer
+	// loop and more in the inner one, and finally all threads in the outer loop.
+	GMRFLib_openmp_autotune_tp *at = openmp_autotune_get(place);
+	if (!at) {
+		return;
+	}
+
+	if (at->ncand == 0) {
+		int ntmax = GMRFLib_MAX_THREADS();
+		int outer = GMRFLib_openmp->max_threads_outer;
+
+		openmp_autotune_add(at, outer, GMRFLib_openmp->max_threads_inner);
+		for (int o = outer / 2; o >= 1; o /= 2) {
+			openmp_autotune_add(at, o, ntmax / o);
+		}
+		openmp_autotune_add(at, ntmax, 1);
+		at->trial = 0;
+		at->best = (at->ncand == 1 ? 0 : -1);
+	}
+	openmp_autotune_apply(at);
+}
+
+int GMRFLib_openmp_autotune_next(GMRFLib_openmp_place_tp place, int first, int n)
+{
+	// return 'last' for the next chunk [first, last) of the 'n' units of work at 'place'. while the candidates are measured the chunks
+	// are small, so they are measured on the first units of work. otherwise, the chunk is the rest.
+
+	GMRFLib_openmp_autotune_tp *at = (GMRFLib_openmp->autotune && GMRFLib_openmp->place == place ? openmp_autotune_get(place) : NULL);
+	if (!at || at->ncand == 0 || at->best >= 0) {
+		return n;
+	}
+
+	int len = IMAX(at->outer[at->trial], n / (4 * at->ncand));
+	return IMIN(n, first + len);
+}
+
+int GMRFLib_openmp_autotune_record(GMRFLib_openmp_place_tp place, double time_used, int units)
+{
+	// record the wall-clock time used for 'units' of work with the current candidate. when each candidate have been measured using at
+	// least one unit for each thread in the outer loop, then choose the one with the highest throughput.
+
+	GMRFLib_openmp_autotune_tp *at = (GMRFLib_openmp->autotune && GMRFLib_openmp->place == place ? openmp_autotune_get(place) : NULL);
+	if (!at || at->ncand == 0 || at->best >= 0 || units <= 0) {
+		return GMRFLib_SUCCESS;
+	}
+
+	int k = at->trial;
+	at->time[k] += time_used;
+	at->units[k] += units;
+	if (at->units[k] < at->outer[k]) {
+		return GMRFLib_SUCCESS;
+	}
+
+	if (++(at->trial) == at->ncand) {
+		double rate_best = -1.0;
+		for (int kk = 0; kk < at->ncand; kk++) {
+			double rate = at->units[kk] / DMAX(DBL_EPSILON, at->time[kk]);
+			if (rate > rate_best) {
+				rate_best = rate;
+				at->best = kk;
+			}
+		}
+		if (GMRFLib_openmp->autotune_verbose) {
+			printf("\tOpenMP autotune place[%s]:", GMRFLib_OPENMP_PLACE_NAME(place));
+			for (int kk = 0; kk < at->ncand; kk++) {
+				printf(" %1dx%1d[%.3g/s]", at->outer[kk], at->inner[kk], at->units[kk] / DMAX(DBL_EPSILON, at->time[kk]));
+			}
+			printf(" use %1dx%1d\n", at->outer[at->best], at->inner[at->best]);
+		}
+	}
+	openmp_autotune_apply(at);
+
+	return GMRFLib_SUCCESS;
+}
+
 int GMRFLib_openmp_implement_strategy(GMRFLib_openmp_place_tp place, void *arg, GMRFLib_smtp_tp *smtp)
 {
 	GMRFLib_DEBUG_INIT();
@@ -404,6 +526,13 @@ int GMRFLib_openmp_implement_strategy(GMRFLib_openmp_place_tp place, void *arg,
 	}
 	}
 
+	GMRFLib_profile_place(GMRFLib_OPENMP_PLACE_NAME(place));
+	GMRFLib_bench_place(place);
+
+	if (GMRFLib_openmp->autotune && openmp_autotune_get(place)) {
+		openmp_autotune_select(place);
+		nested = (nested || GMRFLib_openmp->max_threads_inner > 1);
+	}
 	// only set if changed
 	if ((nested && !omp_get_nested()) || (!nested && omp_get_nested())) {
 		omp_set_nested(nested);
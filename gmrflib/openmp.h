@@ -110,8 +110,24 @@ typedef struct {
 	int max_threads_inner;
 	// when this is TRUE, then do PARDISO is parallel if the function call is serial
 	int adaptive;
+	// when this is TRUE, then measure the (outer x inner) split at the places that are autotuned and use the best one
+	int autotune;
+	int autotune_verbose;
 } GMRFLib_openmp_tp;
 
+// max number of (outer x inner) splits tried at each place
+#define GMRFLib_OPENMP_AUTOTUNE_MAX (4)
+
+typedef struct {
+	int ncand;					       /* number of candidates */
+	int outer[GMRFLib_OPENMP_AUTOTUNE_MAX];
+	int inner[GMRFLib_OPENMP_AUTOTUNE_MAX];
+	double time[GMRFLib_OPENMP_AUTOTUNE_MAX];	       /* accumulated wall-clock time */
+	double units[GMRFLib_OPENMP_AUTOTUNE_MAX];	       /* accumulated units of work */
+	int trial;					       /* the candidate in use while measuring */
+	int best;					       /* the chosen one, or -1 if not yet decided */
+} GMRFLib_openmp_autotune_tp;
+
 #define GMRFLib_MAX_THREADS() (GMRFLib_openmp->max_threads)
 
 // Might replace `4' in the generic pardiso control statement later (if that happens)
@@ -128,6 +144,8 @@ int GMRFLib_set_blas_num_threads(int threads);
 int GMRFLib_openmp_nested_fix(void);
 int GMRFLib_openmp_implement_strategy(GMRFLib_openmp_place_tp place, void *arg, GMRFLib_smtp_tp * smtp);
 int GMRFLib_openmp_implement_strategy_special(int outer, int inner);
+int GMRFLib_openmp_autotune_next(GMRFLib_openmp_place_tp place, int first, int n);
+int GMRFLib_openmp_autotune_record(GMRFLib_openmp_place_tp place, double time_used, int units);
 
 #if defined(INLA_WITH_MKL)
 void MKL_Set_Num_Threads(int);
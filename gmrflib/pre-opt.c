@@ -73,6 +73,7 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 	GMRFLib_idxval_tp **pA_idxval = NULL;
 	GMRFLib_idxval_tp *elm = NULL;
 	GMRFLib_matrix_tp *pA = NULL;
+	GMRFLib_matrix_mmap_tp *pA_mm = NULL;
 
 	ww = Calloc(nf, double *);
 	for (int i = 0; i < nf; i++) {
@@ -365,10 +366,24 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 	}
 
 	if (pA_fnm) {
-		pA = GMRFLib_read_fmesher_file(pA_fnm, (long int) 0, -1);
-		assert(pA);
+		// if pA is stored in CSR format, then we map it into memory and read it in row-blocks while pA %*% A is built, without
+		// creating pA or pA_idxval. this saves the memory for pA only, so it is not an out-of-core mode: pA %*% A is kept in memory,
+		// in pAA_idxval and pAA_csr, and the predictor and everything else use that one.
+		pA_mm = GMRFLib_matrix_mmap_open(pA_fnm);
+		if (pA_mm) {
+			nrow = pA_mm->nrow;
+			ncol = pA_mm->ncol;
+			if (debug) {
+				printf("\t\tGMRFLib_preopt_init: map pA from [%s], nrow %d ncol %d nnz %" PRId64 "\n", pA_fnm, nrow, ncol, pA_mm->nnz);
+			}
+		} else {
+			pA = GMRFLib_read_fmesher_file(pA_fnm, (long int) 0, -1);
+			assert(pA);
+			nrow = pA->nrow;
+			ncol = pA->ncol;
+		}
 
-		if (debug_detailed) {
+		if (debug_detailed && pA) {
 			printf("read pA from [%s]\n", pA_fnm);
 			printf("\tnrow %d ncol %d nelms %d\n", pA->nrow, pA->ncol, pA->elems);
 			for (int i = 0; i < pA->elems; i++) {
@@ -376,61 +391,77 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 			}
 		}
 
-		nrow = pA->nrow;
-		ncol = pA->ncol;
 		assert(ncol == npred);
 		SHOW_TIME("read pA");
 
-		// this is need to compute the linear predictor later
-		pA_idxval = GMRFLib_idxval_ncreate(nrow);
-		for (int k = 0; k < pA->elems; k++) {
-			int i = pA->i[k];
-			int j = pA->j[k];
-			GMRFLib_idxval_add(&(pA_idxval[i]), j, pA->values[k]);
-		}
-		GMRFLib_idxval_prepare(pA_idxval, nrow, GMRFLib_MAX_THREADS());
-		if (do_prune) {
-			GMRFLib_idxval_nprune(pA_idxval, nrow, GMRFLib_MAX_THREADS());
+		if (pA) {
+			// this is need to compute the linear predictor later
+			pA_idxval = GMRFLib_idxval_ncreate(nrow);
+			for (int k = 0; k < pA->elems; k++) {
+				int i = pA->i[k];
+				int j = pA->j[k];
+				GMRFLib_idxval_add(&(pA_idxval[i]), j, pA->values[k]);
+			}
+			GMRFLib_idxval_prepare(pA_idxval, nrow, GMRFLib_MAX_THREADS());
+			if (do_prune) {
+				GMRFLib_idxval_nprune(pA_idxval, nrow, GMRFLib_MAX_THREADS());
+			}
 		}
 		(*preopt)->pA = pA;
+		(*preopt)->pA_mmap = pA_mm;
 		SHOW_TIME("create pA_idxval");
 
+		// the row-blocks we stream pA in. if pA is in memory, there is only one
+		int pA_block = (pA_mm ? GMRFLib_MATRIX_MMAP_BLOCK : IMAX(1, nrow));
+
+#define PA_GET_ROW(row_, i_, sort_)					\
+		if (pA_mm) {						\
+			GMRFLib_matrix_mmap_get_row_idxval(&(row_), i_, pA_mm, sort_); \
+		} else {						\
+			GMRFLib_matrix_get_row_idxval(&(row_), i_, pA, sort_); \
+		}
+
 		// to avoid to much 'realloc', I can compute the the length in 'm' and then add terms
 		pAA_pattern = Calloc(nrow, GMRFLib_idx_tp *);
 
 		// this will keep the working 'idxval' within the thread, and we can free it at the end
 		GMRFLib_idxval_tp **row_idxval_hold = Calloc(GMRFLib_MAX_THREADS(), GMRFLib_idxval_tp *);
 
+		for (int ib = 0; ib < nrow; ib += pA_block) {
+			int ie = IMIN(nrow, ib + pA_block);
+			GMRFLib_matrix_mmap_advise(pA_mm, ib, ie, 1);
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
-		for (int i = 0; i < nrow; i++) {
-			int thread = omp_get_thread_num();
-			GMRFLib_idxval_tp *row_idxval = row_idxval_hold[thread];
-			if (row_idxval) {
-				// we do not free it, we can just pretend its empty and use it again
-				row_idxval->n = 0;
-			}
-			// last argument = 0, as we do not need to sort it
-			GMRFLib_matrix_get_row_idxval(&row_idxval, i, pA, 0);
-
-			// total length
-			int m = 0;
-			for (int jj = 0; jj < row_idxval->n; jj++) {
-				int j = row_idxval->idx[jj];
-				m += A_idxval[j]->n;
-			}
-			GMRFLib_idx_create_x(&(pAA_pattern[i]), m);
-
-			for (int jj = 0; jj < row_idxval->n; jj++) {
-				int j = row_idxval->idx[jj];
-				// use the _nadd to append a whole vector
-				GMRFLib_idx_nadd(&(pAA_pattern[i]), A_idxval[j]->n, A_idxval[j]->idx);
-				// instead of this old code
-				// for (int kk = 0; kk < A_idxval[j]->n; kk++) {
-				// int k = A_idxval[j]->idx[kk];
-				// GMRFLib_idx_add(&(pAA_pattern[i]), k); }
+			for (int i = ib; i < ie; i++) {
+				int thread = omp_get_thread_num();
+				GMRFLib_idxval_tp *row_idxval = row_idxval_hold[thread];
+				if (row_idxval) {
+					// we do not free it, we can just pretend its empty and use it again
+					row_idxval->n = 0;
+				}
+				// last argument = 0, as we do not need to sort it
+				PA_GET_ROW(row_idxval, i, 0);
+
+				// total length
+				int m = 0;
+				for (int jj = 0; jj < row_idxval->n; jj++) {
+					int j = row_idxval->idx[jj];
+					m += A_idxval[j]->n;
+				}
+				GMRFLib_idx_create_x(&(pAA_pattern[i]), m);
+
+				for (int jj = 0; jj < row_idxval->n; jj++) {
+					int j = row_idxval->idx[jj];
+					// use the _nadd to append a whole vector
+					GMRFLib_idx_nadd(&(pAA_pattern[i]), A_idxval[j]->n, A_idxval[j]->idx);
+					// instead of this old code
+					// for (int kk = 0; kk < A_idxval[j]->n; kk++) {
+					// int k = A_idxval[j]->idx[kk];
+					// GMRFLib_idx_add(&(pAA_pattern[i]), k); }
+				}
+				GMRFLib_idx_uniq(pAA_pattern[i]);      /* this also sorts */
+				GMRFLib_idxval_free(row_idxval);
 			}
-			GMRFLib_idx_uniq(pAA_pattern[i]);      /* this also sorts */
-			GMRFLib_idxval_free(row_idxval);
+			GMRFLib_matrix_mmap_advise(pA_mm, ib, ie, 0);
 		}
 
 		for (int i = 0; i < GMRFLib_MAX_THREADS(); i++) {
@@ -469,59 +500,65 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 
 		SHOW_TIME("init pAA_idxval");
 
+		for (int ib = 0; ib < nrow; ib += pA_block) {
+			int ie = IMIN(nrow, ib + pA_block);
+			GMRFLib_matrix_mmap_advise(pA_mm, ib, ie, 1);
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
-		for (int i = 0; i < nrow; i++) {
-			int step;
-			int steps[] = { 262144, 32768, 4096, 512, 64, 8, 1 };
-			int nsteps = sizeof(steps) / sizeof(int);
-			int row_n;
-			GMRFLib_idxval_tp *row_idxval = NULL;
-			GMRFLib_idxval_tp *row_elm = NULL;
-
-			GMRFLib_matrix_get_row_idxval(&row_idxval, i, pA, 1);
-			row_elm = row_idxval;
-			row_n = row_idxval->n;
-
-			for (int jj = 0; jj < pAA_pattern[i]->n; jj++) {
-				int j = pAA_pattern[i]->idx[jj];
-				GMRFLib_idxval_tp *At_elm = At_idxval[j];
-				int At_n = At_idxval[j]->n;
-				int irow = 0;
-				int iAt = 0;
-				while (irow < row_n && iAt < At_n) {
-					int k = row_elm->idx[irow];
-					int kk = At_elm->idx[iAt];
-					if (k < kk) {
-						irow++;
-						for (int s = 0; s < nsteps; s++) {
-							step = steps[s];
-							if (step < row_n) {
-								int ia = irow + step;
-								while (ia < row_n && row_elm->idx[ia] < kk)
-									ia += step;
-								irow = ia - step;
+			for (int i = ib; i < ie; i++) {
+				int step;
+				int steps[] = { 262144, 32768, 4096, 512, 64, 8, 1 };
+				int nsteps = sizeof(steps) / sizeof(int);
+				int row_n;
+				GMRFLib_idxval_tp *row_idxval = NULL;
+				GMRFLib_idxval_tp *row_elm = NULL;
+
+				PA_GET_ROW(row_idxval, i, 1);
+				row_elm = row_idxval;
+				row_n = row_idxval->n;
+
+				for (int jj = 0; jj < pAA_pattern[i]->n; jj++) {
+					int j = pAA_pattern[i]->idx[jj];
+					GMRFLib_idxval_tp *At_elm = At_idxval[j];
+					int At_n = At_idxval[j]->n;
+					int irow = 0;
+					int iAt = 0;
+					while (irow < row_n && iAt < At_n) {
+						int k = row_elm->idx[irow];
+						int kk = At_elm->idx[iAt];
+						if (k < kk) {
+							irow++;
+							for (int s = 0; s < nsteps; s++) {
+								step = steps[s];
+								if (step < row_n) {
+									int ia = irow + step;
+									while (ia < row_n && row_elm->idx[ia] < kk)
+										ia += step;
+									irow = ia - step;
+								}
 							}
-						}
-					} else if (k > kk) {
-						iAt++;
-						for (int s = 0; s < nsteps; s++) {
-							step = steps[s];
-							if (step < At_n) {
-								int ia = iAt + step;
-								while (ia < At_n && At_elm->idx[ia] < k)
-									ia += step;
-								iAt = ia - step;
+						} else if (k > kk) {
+							iAt++;
+							for (int s = 0; s < nsteps; s++) {
+								step = steps[s];
+								if (step < At_n) {
+									int ia = iAt + step;
+									while (ia < At_n && At_elm->idx[ia] < k)
+										ia += step;
+									iAt = ia - step;
+								}
 							}
+						} else {
+							GMRFLib_idxval_addto(&(pAA_idxval[i]), j, row_elm->val[irow] * At_elm->val[iAt]);
+							irow++;
+							iAt++;
 						}
-					} else {
-						GMRFLib_idxval_addto(&(pAA_idxval[i]), j, row_elm->val[irow] * At_elm->val[iAt]);
-						irow++;
-						iAt++;
 					}
 				}
+				GMRFLib_idxval_free(row_idxval);
 			}
-			GMRFLib_idxval_free(row_idxval);
+			GMRFLib_matrix_mmap_advise(pA_mm, ib, ie, 0);
 		}
+#undef PA_GET_ROW
 		GMRFLib_idxval_prepare(pAA_idxval, nrow, GMRFLib_MAX_THREADS());
 		if (do_prune) {
 			GMRFLib_idxval_nprune(pAA_idxval, nrow, GMRFLib_MAX_THREADS());
@@ -675,10 +712,8 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 	}
 #pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_outer)
 	for (int i = 0; i < g->n; i++) {
-		GMRFLib_idxval_prepare(AtA_idxval[i], 1 + g->lnnbs[i], 1);
-		if (do_prune) {
-			GMRFLib_idxval_nprune(AtA_idxval[i], 1 + g->lnnbs[i], 1);
-		}
+		// only sort and accumulate, the rows are only used to build AtA_csr below
+		GMRFLib_idxval_nsort_x(AtA_idxval[i], 1 + g->lnnbs[i], 1, 0, 1);
 	}
 	SHOW_TIME("sort AtA_idxval");
 
@@ -687,10 +722,44 @@ int GMRFLib_preopt_init(GMRFLib_preopt_tp **preopt, int npred, int nf, int **c,
 	(*preopt)->pA_idxval = pA_idxval;
 	(*preopt)->pAA_idxval = pAA_idxval;
 	(*preopt)->pAAt_idxval = pAAt_idxval;
-	(*preopt)->AtA_idxval = AtA_idxval;
+	/*
+	 * the rows in A_idxval and pAA_idxval are still used by the data-rich strategy, lincombs and VB, so they are kept, but
+	 * they share idx and val with the CSR-matrices so the non-zeros are only stored once
+	 */
+	(*preopt)->A_csr = GMRFLib_idxval_csr_create(A_idxval, npred, N, GMRFLib_MAX_THREADS());
+	GMRFLib_idxval_csr_share((*preopt)->A_csr, A_idxval);
+	if (pAA_idxval) {
+		(*preopt)->pAA_csr = GMRFLib_idxval_csr_create(pAA_idxval, nrow, N, GMRFLib_MAX_THREADS());
+		GMRFLib_idxval_csr_share((*preopt)->pAA_csr, pAA_idxval);
+	}
+	SHOW_TIME("A_csr and pAA_csr");
+
+	/*
+	 * the symbolic part of the AtA-update. All AtA_idxval[i][k] are stacked as rows in one CSR-matrix, so that the numeric part, which is
+	 * like_Q = AtA %*% like_c, is one sparse matrix-vector product in GMRFLib_preopt_update(). AtA_idxval is not needed after this.
+	 */
+	(*preopt)->AtA_offset = Calloc(N + 1, int);
+	for (int i = 0; i < N; i++) {
+		(*preopt)->AtA_offset[i + 1] = (*preopt)->AtA_offset[i] + 1 + g->lnnbs[i];
+	}
+	GMRFLib_idxval_tp **AtA_rows = Calloc(IMAX(1, (*preopt)->AtA_offset[N]), GMRFLib_idxval_tp *);
+	for (int i = 0; i < N; i++) {
+		Memcpy(AtA_rows + (*preopt)->AtA_offset[i], AtA_idxval[i], (1 + g->lnnbs[i]) * sizeof(GMRFLib_idxval_tp *));
+	}
+	(*preopt)->AtA_csr = GMRFLib_idxval_csr_create(AtA_rows, (*preopt)->AtA_offset[N], (*preopt)->Npred, GMRFLib_MAX_THREADS());
+	for (int i = 0; i < (*preopt)->AtA_offset[N]; i++) {
+		GMRFLib_idxval_free(AtA_rows[i]);
+	}
+	for (int i = 0; i < N; i++) {
+		Free(AtA_idxval[i]);
+	}
+	Free(AtA_idxval);
+	Free(AtA_rows);
+	SHOW_TIME("AtA_csr");
 
 	(*preopt)->like_graph = g;
 	(*preopt)->like_c = Calloc(GMRFLib_MAX_THREADS(), double *);
+	(*preopt)->like_Q = Calloc(GMRFLib_MAX_THREADS(), double *);
 	(*preopt)->like_b = Calloc(GMRFLib_MAX_THREADS(), double *);
 	(*preopt)->total_b = Calloc(GMRFLib_MAX_THREADS(), double *);
 
@@ -860,25 +929,13 @@ double GMRFLib_preopt_like_Qfunc(int thread_id, int node, int nnode, double *UNU
 	 * this is Qfunction for the likelihood part in preopt
 	 */
 	GMRFLib_preopt_tp *a = (GMRFLib_preopt_tp *) arg;
-	GMRFLib_idxval_tp *elm = NULL;
-	double *lc = a->like_c[thread_id], value = 0.0;
 
-	if (!lc) {
+	// like_Q is set in GMRFLib_preopt_update() together with like_c
+	if (!(a->like_Q[thread_id])) {
 		return 0.0;
 	}
-	// imin = node; imax = nnode;
-	if (node == nnode) {
-		elm = a->AtA_idxval[node][0];
-		// value = GMRFLib_dot_product(elm, lc);
-		GMRFLib_dot_product_INLINE(value, elm, lc);
-	} else {
-		int k = 1 + GMRFLib_iwhich_sorted(nnode, a->like_graph->lnbs[node], a->like_graph->lnnbs[node]);
-		elm = a->AtA_idxval[node][k];
-		// value = GMRFLib_dot_product(elm, lc);
-		GMRFLib_dot_product_INLINE(value, elm, lc);
-	}
-
-	return value;
+	int k = (node == nnode ? 0 : 1 + GMRFLib_iwhich_sorted(nnode, a->like_graph->lnbs[node], a->like_graph->lnnbs[node]));
+	return a->like_Q[thread_id][a->AtA_offset[node] + k];
 }
 
 double GMRFLib_preopt_like_Qfunc_k(int thread_id, int node, int k, double *UNUSED(values), void *arg)
@@ -887,15 +944,8 @@ double GMRFLib_preopt_like_Qfunc_k(int thread_id, int node, int k, double *UNUSE
 	 * Special version without the need to 'iwhich_sorted' as we know what 'k' is. 
 	 */
 	GMRFLib_preopt_tp *a = (GMRFLib_preopt_tp *) arg;
-	double *lc = a->like_c[thread_id];
-	double value = 0.0;
 
-	if (lc) {
-		GMRFLib_idxval_tp *elm = a->AtA_idxval[node][k];
-		// value = GMRFLib_dot_product(elm, lc);
-		GMRFLib_dot_product_INLINE(value, elm, lc);
-	}
-	return value;
+	return (a->like_Q[thread_id] ? a->like_Q[thread_id][a->AtA_offset[node] + k] : 0.0);
 }
 
 double GMRFLib_preopt_Qfunc_OLD(int thread_id, int node, int nnode, double *values, void *arg)
@@ -1050,7 +1100,7 @@ int GMRFLib_preopt_bnew_like(double *bnew, double *blike, GMRFLib_preopt_tp *pre
 
 	GMRFLib_idxval_tp **A = NULL;
 
-	if (preopt->pA_idxval) {
+	if (preopt->mpred) {
 		A = preopt->pAAt_idxval;
 		assert(preopt->mpred > 0);
 	} else {
@@ -1097,7 +1147,7 @@ int GMRFLib_preopt_predictor_core(double *predictor, double *latent, GMRFLib_pre
 	// int data_rich_case = (IMAX(preopt->mpred, preopt->npred) > preopt->n);
 	int offset = 0;
 
-	if (preopt->pA_idxval) {
+	if (preopt->mpred) {
 		offset = preopt->mpred;
 		assert(preopt->mpred > 0);
 	} else {
@@ -1108,7 +1158,7 @@ int GMRFLib_preopt_predictor_core(double *predictor, double *latent, GMRFLib_pre
 
 		// data-rich case
 
-		if (preopt->pA_idxval) {
+		if (preopt->mpred) {
 			// both loops
 			double *pred_offset = pred + offset;
 #define CODE_BLOCK							\
@@ -1150,7 +1200,13 @@ int GMRFLib_preopt_predictor_core(double *predictor, double *latent, GMRFLib_pre
 
 		// not data-rich case
 
-		if (preopt->pA_idxval) {
+		if (preopt->A_csr) {
+			// the CSR kernels are parallel within, so do them one after the other
+			GMRFLib_idxval_csr_mv(pred + offset, preopt->A_csr, latent);
+			if (preopt->pAA_csr) {
+				GMRFLib_idxval_csr_mv(pred, preopt->pAA_csr, latent);
+			}
+		} else if (preopt->mpred) {
 			// both loops
 			double *pred_offset = pred + offset;
 
@@ -1230,7 +1286,7 @@ int GMRFLib_preopt_predictor_moments(double *mean, double *variance, GMRFLib_pre
 		return GMRFLib_SUCCESS;
 	}
 
-	if (preopt->pA) {
+	if (preopt->mpred) {
 		if (compute_mean && !compute_variance) {
 
 			// mean only
@@ -1377,6 +1433,11 @@ int GMRFLib_preopt_update(int thread_id, GMRFLib_preopt_tp *preopt, double *like
 	Memcpy(preopt->like_b[thread_id], like_b, np * sizeof(double));
 	Memcpy(preopt->like_c[thread_id], like_c, np * sizeof(double));
 
+	if (!(preopt->like_Q[thread_id])) {
+		preopt->like_Q[thread_id] = Calloc(IMAX(1, preopt->AtA_offset[preopt->n]), double);
+	}
+	GMRFLib_idxval_csr_mv(preopt->like_Q[thread_id], preopt->AtA_csr, preopt->like_c[thread_id]);
+
 	if (!(preopt->total_b[thread_id])) {
 		preopt->total_b[thread_id] = Calloc(preopt->n, double);
 	}
@@ -1401,17 +1462,12 @@ int GMRFLib_preopt_free(GMRFLib_preopt_tp *preopt)
 				}
 				Free(preopt->pAA_idxval);
 			}
-			for (int i = 0; i < preopt->n; i++) {
-				GMRFLib_idxval_free(preopt->AtA_idxval[i][0]);
-				for (int jj = 0; jj < preopt->like_graph->lnnbs[i]; jj++) {
-					GMRFLib_idxval_free(preopt->AtA_idxval[i][1 + jj]);
-				}
-			}
-			Free(preopt->AtA_idxval);
 			if (preopt->pA_idxval) {
 				for (int i = 0; i < preopt->mpred; i++) {
 					GMRFLib_idxval_free(preopt->pA_idxval[i]);
 				}
+			}
+			if (preopt->pAAt_idxval) {
 				for (int i = 0; i < preopt->n; i++) {
 					GMRFLib_idxval_free(preopt->pAAt_idxval[i]);
 				}
@@ -1422,12 +1478,17 @@ int GMRFLib_preopt_free(GMRFLib_preopt_tp *preopt)
 			for (int i = 0; i < preopt->n; i++) {
 				GMRFLib_idxval_free(preopt->At_idxval[i]);
 			}
+			GMRFLib_idxval_csr_free(preopt->A_csr);
+			GMRFLib_idxval_csr_free(preopt->pAA_csr);
+			GMRFLib_idxval_csr_free(preopt->AtA_csr);
+			Free(preopt->AtA_offset);
 		}
 
 #pragma omp section
 		{
 			GMRFLib_matrix_free(preopt->A);
 			GMRFLib_matrix_free(preopt->pA);
+			GMRFLib_matrix_mmap_free(preopt->pA_mmap);
 
 			Free(preopt->idx_map_f);
 			Free(preopt->idx_map_beta);
@@ -1436,10 +1497,12 @@ int GMRFLib_preopt_free(GMRFLib_preopt_tp *preopt)
 			for (int i = 0; i < GMRFLib_MAX_THREADS(); i++) {
 				Free(preopt->like_b[i]);
 				Free(preopt->like_c[i]);
+				Free(preopt->like_Q[i]);
 				Free(preopt->total_b[i]);
 			}
 			Free(preopt->like_b);
 			Free(preopt->like_c);
+			Free(preopt->like_Q);
 			Free(preopt->total_b);
 
 			for (int i = 0; i < preopt->preopt_graph->n; i++) {
@@ -118,6 +118,7 @@ typedef struct {
 
 	GMRFLib_bfunc_tp **bfunc;
 	double **like_c;
+	double **like_Q;				       /* per thread, like_Q = AtA %*% like_c, stored as AtA_csr rows */
 	double **like_b;
 	double **total_b;
 	double *total_const;
@@ -141,10 +142,14 @@ typedef struct {
 	GMRFLib_idxval_tp **pAAt_idxval;
 	GMRFLib_idxval_tp **A_idxval;
 	GMRFLib_idxval_tp **At_idxval;
-	GMRFLib_idxval_tp ***AtA_idxval;		       /* this is the total (pA%*%A)^T%*%(pA%*%A) */
+	GMRFLib_idxval_csr_tp *A_csr;			       /* A_idxval and pAA_idxval in CSR format, sharing idx and val with them */
+	GMRFLib_idxval_csr_tp *pAA_csr;
+	GMRFLib_idxval_csr_tp *AtA_csr;			       /* the total (pA%*%A)^T%*%(pA%*%A), one row for each (i,j) in like_graph, starting at row AtA_offset[i] */
+	int *AtA_offset;
 
 	GMRFLib_matrix_tp *A;				       /* the model matrix to construct Predictor */
 	GMRFLib_matrix_tp *pA;				       /* the matrix to construct APredictor from Predictor */
+	GMRFLib_matrix_mmap_tp *pA_mmap;		       /* or, if pA is stored in CSR format, its memory-map (then pA = NULL) */
 
 	double *mode_theta;
 	double *mode_x;
@@ -374,6 +374,57 @@ int GMRFLib_Qsolve(double *x, double *b, GMRFLib_problem_tp *problem, int idx)
 	return GMRFLib_SUCCESS;
 }
 
+int GMRFLib_Qsolve_multi(double *x, double *b, int nrhs, GMRFLib_problem_tp *problem, int *idx)
+{
+	// as GMRFLib_Qsolve(), but for 'nrhs' right hand sides stored columnwise in 'b'. all are solved in one call so the factor is
+	// traversed once per block of rhs's, and the constraint correction is one dgemm. 'x' and 'b' can be the same.
+	//
+	// if 'idx' is non-NULL, then column k of 'b' is zero except for a 1 at idx[k]. for BAND, and for TAUCS with few rhs's (where
+	// GMRFLib_solve_llt_sparse_matrix() also solves them one by one), the solves that make use of this are used.
+
+	GMRFLib_ENTER_ROUTINE;
+
+	int n = problem->sub_graph->n;
+	size_t len = (size_t) n * nrhs;
+
+	if (x != b) {
+		Memcpy(x, b, len * sizeof(double));
+	}
+
+	int ntt = (omp_get_level() == 0 ? GMRFLib_PARDISO_MAX_NUM_THREADS() : GMRFLib_openmp->max_threads_inner);
+	if (idx && (problem->sub_sm_fact.smtp == GMRFLib_SMTP_BAND ||
+		    (problem->sub_sm_fact.smtp == GMRFLib_SMTP_TAUCS && nrhs <= 4 * ntt))) {
+		// the special solves use the per-level caches, which only allow two levels of nesting. from a nested caller, like the
+		// RUN_CODE_BLOCK's in the VB corrections, the caller provides the parallelism
+		if (omp_get_level() < 2) {
+#pragma omp parallel for num_threads(IMAX(1, IMIN(nrhs, ntt)))
+			for (int k = 0; k < nrhs; k++) {
+				GMRFLib_solve_llt_sparse_matrix_special(x + (size_t) k * n, &(problem->sub_sm_fact), problem->sub_graph, idx[k]);
+			}
+		} else {
+			for (int k = 0; k < nrhs; k++) {
+				GMRFLib_solve_llt_sparse_matrix_special(x + (size_t) k * n, &(problem->sub_sm_fact), problem->sub_graph, idx[k]);
+			}
+		}
+	} else {
+		GMRFLib_solve_llt_sparse_matrix(x, nrhs, &(problem->sub_sm_fact), problem->sub_graph);
+	}
+
+	if ((problem->sub_constr && problem->sub_constr->nc > 0)) {
+		int nc = problem->sub_constr->nc;
+		double alpha = 1.0, beta = 0.0, malpha = -1.0, one = 1.0;
+		double *t_matrix = Calloc(nc * nrhs, double);
+
+		// t = A x, and then x := x - constr_m t
+		dgemm_("N", "N", &nc, &nrhs, &n, &alpha, problem->sub_constr->a_matrix, &nc, x, &n, &beta, t_matrix, &nc, F_ONE, F_ONE);
+		dgemm_("N", "N", &n, &nrhs, &nc, &malpha, problem->constr_m, &n, t_matrix, &nc, &one, x, &n, F_ONE, F_ONE);
+		Free(t_matrix);
+	}
+
+	GMRFLib_LEAVE_ROUTINE;
+	return GMRFLib_SUCCESS;
+}
+
 int GMRFLib_init_problem(int thread_id, GMRFLib_problem_tp **problem,
 			 double *x,
 			 double *b,
@@ -925,6 +976,132 @@ int GMRFLib_sample(GMRFLib_problem_tp *problem)
 	return GMRFLib_SUCCESS;
 }
 
+int GMRFLib_sample_block(GMRFLib_problem_tp *problem, int nsamples, int block_size, double *samples, double *logdens)
+{
+	/*
+	 * Draw 'nsamples' samples at once. 'samples' is (n x nsamples) column-wise with n = problem->sub_graph->n, and
+	 * 'logdens' (if non-NULL) is of length 'nsamples'.
+	 *
+	 * The samples are drawn in blocks of 'block_size' columns, each block doing one multi-rhs solve with L^T and correcting
+	 * for the constraints with level-3 BLAS. Sample k uses stream k of the counter-based RNG, with a seed drawn from
+	 * GMRFLib_rng, so the result depends neither on the number of threads nor on the block size.
+	 */
+
+	if (!problem || nsamples <= 0) {
+		return GMRFLib_SUCCESS;
+	}
+	GMRFLib_ENTER_ROUTINE;
+
+	int n = problem->sub_graph->n;
+	int nc = (problem->sub_constr ? problem->sub_constr->nc : 0);
+	int nblock;
+	uint64_t seed;
+
+	if (block_size <= 0) {
+		block_size = GMRFLib_SAMPLE_BLOCK_SIZE;
+	}
+	block_size = IMIN(block_size, nsamples);
+	nblock = nsamples / block_size + (nsamples % block_size != 0);
+	seed = (uint64_t) gsl_rng_get(GMRFLib_rng) << 32;
+	seed ^= (uint64_t) gsl_rng_get(GMRFLib_rng);
+
+	/*
+	 * PARDISO is parallel itself, and we do not want to call it from within a parallel region 
+	 */
+	int nt = (problem->sub_sm_fact.smtp == GMRFLib_SMTP_PARDISO ? 1 : IMIN(nblock, GMRFLib_openmp->max_threads_outer));
+
+#pragma omp parallel for num_threads(nt)
+	for (int iblock = 0; iblock < nblock; iblock++) {
+		int first = iblock * block_size;
+		int nb = IMIN(block_size, nsamples - first);
+		double *x = samples + (size_t) first * n;
+		double *sqrterm = Calloc(nb, double);
+
+		for (int k = 0; k < nb; k++) {
+			double *xx = x + (size_t) k * n;
+			GMRFLib_crng_normal(xx, n, seed, (uint64_t) (first + k), 0);
+			sqrterm[k] = GMRFLib_ddot(n, xx, xx);
+		}
+
+		GMRFLib_solve_lt_sparse_matrix(x, nb, &(problem->sub_sm_fact), problem->sub_graph);
+		for (int k = 0; k < nb; k++) {
+			GMRFLib_daddto(n, problem->sub_mean, x + (size_t) k * n);
+		}
+
+		if (nc == 0) {
+			if (logdens) {
+				for (int k = 0; k < nb; k++) {
+					logdens[first + k] = -0.5 * n * log(2.0 * M_PI) + problem->log_normc - 0.5 * sqrterm[k];
+				}
+			}
+		} else {
+			/*
+			 * T = A X - e, then X := X - constr_m T, for the whole block 
+			 */
+			double one = 1.0, mone = -1.0, zero = 0.0;
+			double *T = Calloc(nc * nb, double);
+
+			dgemm_("N", "N", &nc, &nb, &n, &one, problem->sub_constr->a_matrix, &nc, x, &n, &zero, T, &nc, F_ONE, F_ONE);
+			for (int k = 0; k < nb; k++) {
+				for (int j = 0; j < nc; j++) {
+					T[j + k * nc] -= problem->sub_constr->e_vector[j];
+				}
+			}
+			dgemm_("N", "N", &n, &nb, &nc, &mone, problem->constr_m, &n, T, &nc, &one, x, &n, F_ONE, F_ONE);
+			Free(T);
+
+			if (logdens) {
+				double *work = Calloc(2 * n, double);
+				for (int k = 0; k < nb; k++) {
+					logdens[first + k] = GMRFLib_evaluate_sample(problem, x + (size_t) k * n, work);
+				}
+				Free(work);
+			}
+		}
+		Free(sqrterm);
+	}
+
+	GMRFLib_LEAVE_ROUTINE;
+	return GMRFLib_SUCCESS;
+}
+
+double GMRFLib_evaluate_sample(GMRFLib_problem_tp *problem, double *x, double *work)
+{
+	/*
+	 * as GMRFLib_evaluate(), but evaluate the log-density in 'x' (subgraph) without touching 'problem', so it can be
+	 * called in parallel. 'work' is of length 2n or NULL.
+	 */
+
+	int n = problem->sub_graph->n;
+	int free_work = (work == NULL);
+	double sqrterm, ldens, *xx = NULL, *yy = NULL;
+
+	if (free_work) {
+		work = Calloc(2 * n, double);
+	}
+	xx = work;
+	yy = work + n;
+
+#pragma omp simd
+	for (int i = 0; i < n; i++) {
+		xx[i] = x[i] - problem->sub_mean[i];
+	}
+	GMRFLib_Qx(-1, yy, xx, problem->sub_graph, problem->tab->Qfunc, (void *) problem->tab->Qfunc_arg);
+	sqrterm = GMRFLib_ddot(n, yy, xx);
+	if (free_work) {
+		Free(work);
+	}
+
+	ldens = -0.5 * n * log(2.0 * M_PI) + problem->log_normc - 0.5 * sqrterm;
+	if (problem->sub_constr && problem->sub_constr->nc > 0) {
+		int nc = problem->sub_constr->nc;
+		ldens += (-0.5 * problem->logdet_aat)	       /* [Ax|x] */
+		    -(-0.5 * nc * log(2.0 * M_PI) - 0.5 * problem->logdet_aqat - 0.5 * problem->exp_corr);	/* [Ax] */
+	}
+
+	return ldens;
+}
+
 int GMRFLib_evaluate(GMRFLib_problem_tp *problem)
 {
 	GMRFLib_ENTER_ROUTINE;
@@ -1036,10 +1213,14 @@ int GMRFLib_free_problem(GMRFLib_problem_tp *problem)
 	Free(problem->l_aqat_m);
 	Free(problem->inv_aqat_m);
 	Free(problem->qi_at_m);
-	GMRFLib_graph_free(problem->sub_graph);
+	if (GMRFLib_shared_unref(problem->sub_graph)) {
+		GMRFLib_graph_free(problem->sub_graph);
+	}
 	GMRFLib_free_tabulate_Qfunc(problem->tab);
 
-	GMRFLib_free_constr(problem->sub_constr);
+	if (GMRFLib_shared_unref(problem->sub_constr)) {
+		GMRFLib_free_constr(problem->sub_constr);
+	}
 	problem->sub_constr = NULL;
 
 	Free(problem);
@@ -1052,7 +1233,7 @@ int GMRFLib_free_Qinv(GMRFLib_problem_tp *problem)
 		int i, n = problem->sub_graph->n;
 
 		for (i = 0; i < n; i++) {
-			map_id_free(problem->sub_inverse->Qinv[i]);
+			smap_id_free(problem->sub_inverse->Qinv[i]);
 			Free(problem->sub_inverse->Qinv[i]);
 		}
 		Free(problem->sub_inverse->Qinv);
@@ -1135,14 +1316,14 @@ double *GMRFLib_Qinv_get(GMRFLib_problem_tp *problem, int i, int j)
 {
 	int ii = problem->sub_inverse->mapping[i];
 	int jj = problem->sub_inverse->mapping[j];
-	return map_id_ptr(problem->sub_inverse->Qinv[IMIN(ii, jj)], IMAX(ii, jj));
+	return smap_id_ptr(problem->sub_inverse->Qinv[IMIN(ii, jj)], IMAX(ii, jj));
 }
 
 double GMRFLib_Qinv_get0(GMRFLib_problem_tp *problem, int i, int j)
 {
 	int ii = problem->sub_inverse->mapping[i];
 	int jj = problem->sub_inverse->mapping[j];
-	double *d = map_id_ptr(problem->sub_inverse->Qinv[IMIN(ii, jj)], IMAX(ii, jj));
+	double *d = smap_id_ptr(problem->sub_inverse->Qinv[IMIN(ii, jj)], IMAX(ii, jj));
 	if (d == NULL)
 		printf("i j NULL %d %d\n", i, j);
 	return (d ? *d : 0.0);
@@ -1640,9 +1821,15 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 	DUPLICATE(sub_mean_constr, ns, double, skeleton);
 
 	/*
-	 * duplicate the sparse-matrix factorisation 
+	 * duplicate the sparse-matrix factorisation. with 'copy_ptr', the parts that do not change (the reordering, the symbolic
+	 * factorisation, the graph and the constraints) are shared with 'problem' and reference counted, and only the numerical
+	 * factorisation and the work vectors are copied.
 	 */
-	DUPLICATE(sub_sm_fact.remap, ns, int, 0);
+	if (copy_ptr) {
+		np->sub_sm_fact.remap = GMRFLib_shared_ref(problem->sub_sm_fact.remap);
+	} else {
+		DUPLICATE(sub_sm_fact.remap, ns, int, 0);
+	}
 	DUPLICATE(sub_sm_fact.bchol, ns * (problem->sub_sm_fact.bandwidth + 1), double, 0);
 
 	COPY(sub_sm_fact.bandwidth);
@@ -1659,7 +1846,11 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 	} else {
 		np->sub_sm_fact.TAUCS_L_inv_diag = NULL;
 	}
-	np->sub_sm_fact.TAUCS_symb_fact = GMRFLib_sm_fact_duplicate_TAUCS(problem->sub_sm_fact.TAUCS_symb_fact);
+	if (copy_ptr) {
+		np->sub_sm_fact.TAUCS_symb_fact = GMRFLib_shared_ref(problem->sub_sm_fact.TAUCS_symb_fact);
+	} else {
+		np->sub_sm_fact.TAUCS_symb_fact = GMRFLib_sm_fact_duplicate_TAUCS(problem->sub_sm_fact.TAUCS_symb_fact);
+	}
 	np->sub_sm_fact.TAUCS_cache = GMRFLib_taucs_cache_duplicate(problem->sub_sm_fact.TAUCS_cache);
 	COPY(sub_sm_fact.finfo);
 
@@ -1674,7 +1865,9 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 	if (skeleton) {
 		np->sub_constr = NULL;
 	} else {
-		if (problem->sub_constr) {
+		if (problem->sub_constr && copy_ptr) {
+			np->sub_constr = GMRFLib_shared_ref(problem->sub_constr);
+		} else if (problem->sub_constr) {
 			// this will make use of the cache
 			GMRFLib_duplicate_constr(&(np->sub_constr), problem->sub_constr, problem->sub_graph);
 		} else {
@@ -1692,7 +1885,11 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 	COPY(logdet_aqat);
 	COPY(log_normc);
 	COPY(exp_corr);
-	GMRFLib_graph_duplicate(&(np->sub_graph), problem->sub_graph);
+	if (copy_ptr) {
+		np->sub_graph = GMRFLib_shared_ref(problem->sub_graph);
+	} else {
+		GMRFLib_graph_duplicate(&(np->sub_graph), problem->sub_graph);
+	}
 
 	/*
 	 * copy the tab 
@@ -1712,10 +1909,14 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 			}
 		}
 		if (tmp->values) {
-			Qfunc_arg->values = Calloc(ns, map_id *);
+			Qfunc_arg->values = Calloc(ns, smap_id *);
+			int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_FACTOR);
+			smap_id *work = Calloc(ns, smap_id);
 			for (i = 0; i < ns; i++) {
-				Qfunc_arg->values[i] = GMRFLib_duplicate_map_id(tmp->values[i]);
+				Qfunc_arg->values[i] = work + i;
+				smap_id_copy(Qfunc_arg->values[i], tmp->values[i]);
 			}
+			GMRFLib_memacct_scope(memtag);
 		} else {
 			Qfunc_arg->values = NULL;
 		}
@@ -1734,11 +1935,14 @@ GMRFLib_problem_tp *GMRFLib_duplicate_problem(GMRFLib_problem_tp *problem, int s
 	 */
 	if (problem->sub_inverse && !skeleton) {
 		np->sub_inverse = Calloc(1, GMRFLib_Qinv_tp);
-		map_id **Qinv = Calloc(n, map_id *);
+		smap_id **Qinv = Calloc(n, smap_id *);
 
+		int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
 		for (i = 0; i < n; i++) {
-			Qinv[i] = GMRFLib_duplicate_map_id(problem->sub_inverse->Qinv[i]);
+			Qinv[i] = Calloc(1, smap_id);
+			smap_id_copy(Qinv[i], problem->sub_inverse->Qinv[i]);
 		}
+		GMRFLib_memacct_scope(memtag);
 		np->sub_inverse->Qinv = Qinv;
 		np->sub_inverse->mapping = Calloc(n, int);
 		Memcpy(np->sub_inverse->mapping, problem->sub_inverse->mapping, n * sizeof(int));
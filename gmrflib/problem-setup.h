@@ -41,6 +41,7 @@
 #include <math.h>
 
 #include "GMRFLib/hashP.h"
+#include "GMRFLib/smap.h"
 
 #undef __BEGIN_DECLS
 #undef __END_DECLS
@@ -151,7 +152,7 @@ typedef struct {
 	 * of \$S_{ij}\$ are store in internal (reordered) coordinates.
 	 * 
 	 */
-	map_id **Qinv;
+	smap_id **Qinv;
 
 	/**
 	 *  \brief The mapping used to lookup values in \a Qinv 
@@ -365,6 +366,11 @@ struct GMRFLib_problem_struct {
 */
 #define GMRFLib_STORE_REJECT (2)
 
+/*!
+  \brief Default number of samples pr block in GMRFLib_sample_block()
+*/
+#define GMRFLib_SAMPLE_BLOCK_SIZE (16)
+
 /*!
   \struct GMRFLib_store_tp problem-setup.h
   \brief The structure to store intermediate calculations
@@ -403,12 +409,14 @@ double GMRFLib_Qfunc_generic(int thread_id, int i, int j, double *values, void *
 double GMRFLib_Qfunc_wrapper(int thread_id, int sub_node, int sub_nnode, double *values, void *arguments);
 int GMRFLib_Qinv(GMRFLib_problem_tp * problem);
 int GMRFLib_Qsolve(double *x, double *b, GMRFLib_problem_tp * problem, int idx);
+int GMRFLib_Qsolve_multi(double *x, double *b, int nrhs, GMRFLib_problem_tp * problem, int *idx);
 int GMRFLib_constr_add_sha(GMRFLib_constr_tp * constr, GMRFLib_graph_tp * graph);
 int GMRFLib_duplicate_constr(GMRFLib_constr_tp ** new_constr, GMRFLib_constr_tp * constr, GMRFLib_graph_tp * graph);
 int GMRFLib_eval_constr(double *value, double *sqr_value, double *x, GMRFLib_constr_tp * constr, GMRFLib_graph_tp * graph);
 int GMRFLib_eval_constr0(double *value, double *sqr_value, double *x, GMRFLib_constr_tp * constr, GMRFLib_graph_tp * graph);
 int GMRFLib_evaluate(GMRFLib_problem_tp * problem);
 int GMRFLib_evaluate__intern(GMRFLib_problem_tp * problem, int compute_const);
+double GMRFLib_evaluate_sample(GMRFLib_problem_tp * problem, double *x, double *work);
 int GMRFLib_fact_info_report(FILE * fp, GMRFLib_sm_fact_tp * sm_fact);
 int GMRFLib_free_Qinv(GMRFLib_problem_tp * problem);
 int GMRFLib_free_constr(GMRFLib_constr_tp * constr);
@@ -430,6 +438,7 @@ int GMRFLib_print_problem(FILE * fp, GMRFLib_problem_tp * problem);
 int GMRFLib_recomp_constr(GMRFLib_constr_tp ** new_constr, GMRFLib_constr_tp * constr, double *x, double *b_add,
 			  char *mask, GMRFLib_graph_tp * graph, GMRFLib_graph_tp * sub_graph);
 int GMRFLib_sample(GMRFLib_problem_tp * problem);
+int GMRFLib_sample_block(GMRFLib_problem_tp * problem, int nsamples, int block_size, double *samples, double *logdens);
 int dgemm_special(int m, int n, double *C, double *A, double *B, GMRFLib_constr_tp * constr);
 int dgemm_special2(int m, double *C, double *A, GMRFLib_constr_tp * constr);
 int dgemv_special(double *res, double *x, GMRFLib_constr_tp * constr);
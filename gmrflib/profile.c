@@ -0,0 +1,351 @@
+
+/* profile.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+/*
+ * A profiler with nested scopes and per-thread timelines. It is enabled at runtime with INLA_PROFILE=1, which records the OpenMP places,
+ * each configuration of theta, the Newton iterations, the factorisations, solves, Qinv and the likelihood evaluations in the Newton
+ * iterations. INLA_PROFILE=2 also records all routines with GMRFLib_ENTER_ROUTINE. Each thread (also in nested OpenMP teams) has its own
+ * buffer, so there is no locking when recording. GMRFLib_profile_write() writes a Chrome trace-event file (to be opened with
+ * chrome://tracing or https://ui.perfetto.dev) and an aggregated summary.
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/profile.h"
+
+static GMRFLib_profile_thread_tp *profile = NULL;
+#pragma omp threadprivate(profile)
+
+// all thread buffers, for the output
+static GMRFLib_profile_thread_tp **profile_all = NULL;
+static int profile_nall = 0;
+static double profile_tstart = 0.0;
+
+int GMRFLib_profile_init(void)
+{
+	char *def = getenv("INLA_PROFILE");
+	if (def) {
+		GMRFLib_profile_level = IMAX(0, atoi(def));
+		profile_tstart = GMRFLib_timer();
+	}
+	return GMRFLib_SUCCESS;
+}
+
+static GMRFLib_profile_thread_tp *profile_get(void)
+{
+	if (!profile) {
+		profile = Calloc(1, GMRFLib_profile_thread_tp);
+		profile->hash_size = 256;
+		profile->hash = Calloc(profile->hash_size, int);
+#pragma omp critical (Name_7d0713faf285d8dfd6cefc426bee51557097d9ef)
+		{
+			profile->id = profile_nall;
+			profile_all = Realloc(profile_all, profile_nall + 1, GMRFLib_profile_thread_tp *);
+			profile_all[profile_nall++] = profile;
+		}
+	}
+	return profile;
+}
+
+static int profile_hash_idx(GMRFLib_profile_thread_tp * p, const char *name, int kind)
+{
+	uintptr_t h = (((uintptr_t) name >> 3) ^ (uintptr_t) kind) * (uintptr_t) 0x9E3779B97F4A7C15ULL;
+	return (int) ((h >> 16) & (uintptr_t) (p->hash_size - 1));
+}
+
+static int profile_stat(GMRFLib_profile_thread_tp * p, const char *name, int kind)
+{
+	// return the index in 'stat' for (name, kind). 'name' is either __func__ or a literal, so the pointer is the key
+	int i = profile_hash_idx(p, name, kind);
+	while (p->hash[i]) {
+		GMRFLib_profile_stat_tp *s = &(p->stat[p->hash[i] - 1]);
+		if (s->name == name && s->kind == kind) {
+			return p->hash[i] - 1;
+		}
+		i = (i + 1) & (p->hash_size - 1);
+	}
+
+	if (p->nstat == p->nstat_alloc) {
+		p->nstat_alloc = IMAX(64, 2 * p->nstat_alloc);
+		p->stat = Realloc(p->stat, p->nstat_alloc, GMRFLib_profile_stat_tp);
+	}
+	int k = p->nstat++;
+	GMRFLib_profile_stat_tp *s = &(p->stat[k]);
+	s->name = name;
+	s->kind = kind;
+	s->ncall = s->total = s->self = 0.0;
+	s->tmin = DBL_MAX;
+	s->tmax = 0.0;
+	p->hash[i] = k + 1;
+
+	if (2 * p->nstat > p->hash_size) {
+		Free(p->hash);
+		p->hash_size *= 2;
+		p->hash = Calloc(p->hash_size, int);
+		for (int j = 0; j < p->nstat; j++) {
+			int ii = profile_hash_idx(p, p->stat[j].name, p->stat[j].kind);
+			while (p->hash[ii]) {
+				ii = (ii + 1) & (p->hash_size - 1);
+			}
+			p->hash[ii] = j + 1;
+		}
+	}
+	return k;
+}
+
+static void profile_pop(GMRFLib_profile_thread_tp * p, double now)
+{
+	GMRFLib_profile_scope_tp *sc = &(p->stack[--(p->depth)]);
+	double dur = now - sc->t0;
+
+	GMRFLib_profile_stat_tp *s = &(p->stat[sc->stat]);
+	s->ncall++;
+	s->total += dur;
+	s->self += dur - sc->child;
+	s->tmin = DMIN(s->tmin, dur);
+	s->tmax = DMAX(s->tmax, dur);
+	if (p->depth > 0) {
+		p->stack[p->depth - 1].child += dur;
+	}
+
+	if (p->nevent < GMRFLib_PROFILE_EVENTS_MAX) {
+		if (p->nevent == p->nevent_alloc) {
+			p->nevent_alloc = IMIN(GMRFLib_PROFILE_EVENTS_MAX, IMAX(1024, 2 * p->nevent_alloc));
+			p->event = Realloc(p->event, p->nevent_alloc, GMRFLib_profile_event_tp);
+		}
+		GMRFLib_profile_event_tp *e = &(p->event[p->nevent++]);
+		e->name = sc->name;
+		e->kind = sc->kind;
+		e->level = omp_get_level();
+		e->team_thread = omp_get_thread_num();
+		e->depth = p->depth;
+		e->t0 = sc->t0 - profile_tstart;
+		e->dur = dur;
+	} else {
+		p->ndropped++;
+	}
+}
+
+int GMRFLib_profile_begin(GMRFLib_profile_kind_tp kind, const char *name)
+{
+	if (!GMRFLib_profile_level || (kind == GMRFLib_PROFILE_FUNCTION && GMRFLib_profile_level < 2)) {
+		return GMRFLib_SUCCESS;
+	}
+
+	GMRFLib_profile_thread_tp *p = profile_get();
+	if (p->depth == GMRFLib_PROFILE_DEPTH_MAX) {
+		// too deep, then drop this scope. its end will not find it and is ignored
+		p->ndropped++;
+		return GMRFLib_SUCCESS;
+	}
+
+	GMRFLib_profile_scope_tp *sc = &(p->stack[p->depth++]);
+	sc->name = name;
+	sc->kind = kind;
+	sc->stat = profile_stat(p, name, kind);
+	sc->child = 0.0;
+	sc->t0 = GMRFLib_timer();
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_profile_end(const char *name)
+{
+	// end the innermost scope with this name. scopes above it that are still open (like a routine that returned without
+	// GMRFLib_LEAVE_ROUTINE) are ended as well. if there is no such scope, do nothing.
+
+	GMRFLib_profile_thread_tp *p = profile;
+	if (!p) {
+		return GMRFLib_SUCCESS;
+	}
+
+	int k;
+	for (k = p->depth - 1; k >= 0; k--) {
+		if (p->stack[k].name == name || !strcmp(p->stack[k].name, name)) {
+			break;
+		}
+	}
+	if (k < 0) {
+		return GMRFLib_SUCCESS;
+	}
+
+	double now = GMRFLib_timer();
+	while (p->depth > k) {
+		profile_pop(p, now);
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_profile_place(const char *name)
+{
+	// the places are changed in the main thread only, and they do not nest: a new place ends the current one
+	if (!GMRFLib_profile_level || omp_get_level() > 0) {
+		return GMRFLib_SUCCESS;
+	}
+
+	GMRFLib_profile_thread_tp *p = profile_get();
+	int k;
+	for (k = 0; k < p->depth; k++) {
+		if (p->stack[k].kind == GMRFLib_PROFILE_PLACE) {
+			break;
+		}
+	}
+	if (k < p->depth) {
+		if (!strcmp(p->stack[k].name, name)) {
+			return GMRFLib_SUCCESS;
+		}
+		double now = GMRFLib_timer();
+		while (p->depth > k) {
+			profile_pop(p, now);
+		}
+	}
+
+	return GMRFLib_profile_begin(GMRFLib_PROFILE_PLACE, name);
+}
+
+static void profile_fprint_name(FILE * fp, const char *name)
+{
+	fputc('"', fp);
+	for (const char *c = name; *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', fp);
+		}
+		fputc(*c, fp);
+	}
+	fputc('"', fp);
+}
+
+static int profile_cmp_total(const void *a, const void *b)
+{
+	const GMRFLib_profile_stat_tp *sa = (const GMRFLib_profile_stat_tp *) a;
+	const GMRFLib_profile_stat_tp *sb = (const GMRFLib_profile_stat_tp *) b;
+	return (sa->total < sb->total ? 1 : (sa->total > sb->total ? -1 : 0));
+}
+
+int GMRFLib_profile_write(const char *dir)
+{
+	// write 'dir/profile-trace.json' and 'dir/profile-summary.txt'. must be called outside parallel regions, and scopes still open
+	// in this thread are ended.
+
+	if (!GMRFLib_profile_level || !profile_nall) {
+		return GMRFLib_SUCCESS;
+	}
+	GMRFLib_ASSERT(omp_get_level() == 0, GMRFLib_ESNH);
+
+	if (profile) {
+		double now = GMRFLib_timer();
+		while (profile->depth > 0) {
+			profile_pop(profile, now);
+		}
+	}
+	double wall = GMRFLib_timer() - profile_tstart;
+
+	char *fnm = NULL;
+	FILE *fp = NULL;
+	size_t ndropped = 0;
+
+	GMRFLib_sprintf(&fnm, "%s/profile-trace.json", (dir ? dir : "."));
+	fp = fopen(fnm, "w");
+	if (!fp) {
+		GMRFLib_ERROR_MSG(GMRFLib_EOPENFILE, fnm);
+	}
+	fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	int first = 1;
+	for (int i = 0; i < profile_nall; i++) {
+		GMRFLib_profile_thread_tp *p = profile_all[i];
+		ndropped += p->ndropped;
+		fprintf(fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %1d, \"args\": {\"name\": \"thread %1d\"}}",
+			(first ? "" : ",\n"), p->id, p->id);
+		first = 0;
+		for (int j = 0; j < p->nevent; j++) {
+			GMRFLib_profile_event_tp *e = &(p->event[j]);
+			fprintf(fp, ",\n{\"name\": ");
+			profile_fprint_name(fp, e->name);
+			fprintf(fp, ", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %1d, "
+				"\"args\": {\"level\": %1d, \"team_thread\": %1d, \"depth\": %1d}}",
+				GMRFLib_PROFILE_KIND_NAME(e->kind), e->t0 * 1.0E6, e->dur * 1.0E6, p->id, e->level, e->team_thread, e->depth);
+		}
+	}
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+	Free(fnm);
+
+	// merge the statistics of all threads, using the name as the key as the same literal can have different addresses
+	int nstat = 0;
+	GMRFLib_profile_stat_tp *stat = NULL;
+	for (int i = 0; i < profile_nall; i++) {
+		GMRFLib_profile_thread_tp *p = profile_all[i];
+		for (int j = 0; j < p->nstat; j++) {
+			GMRFLib_profile_stat_tp *s = &(p->stat[j]);
+			int k;
+			for (k = 0; k < nstat; k++) {
+				if (stat[k].kind == s->kind && !strcmp(stat[k].name, s->name)) {
+					break;
+				}
+			}
+			if (k == nstat) {
+				stat = Realloc(stat, nstat + 1, GMRFLib_profile_stat_tp);
+				stat[nstat++] = *s;
+			} else {
+				stat[k].ncall += s->ncall;
+				stat[k].total += s->total;
+				stat[k].self += s->self;
+				stat[k].tmin = DMIN(stat[k].tmin, s->tmin);
+				stat[k].tmax = DMAX(stat[k].tmax, s->tmax);
+			}
+		}
+	}
+	if (nstat) {
+		qsort((void *) stat, (size_t) nstat, sizeof(GMRFLib_profile_stat_tp), profile_cmp_total);
+	}
+
+	GMRFLib_sprintf(&fnm, "%s/profile-summary.txt", (dir ? dir : "."));
+	fp = fopen(fnm, "w");
+	if (!fp) {
+		GMRFLib_ERROR_MSG(GMRFLib_EOPENFILE, fnm);
+	}
+	fprintf(fp, "Profile level %1d, wall-clock %.3fs, threads %1d, dropped events %zu\n", GMRFLib_profile_level, wall, profile_nall,
+		ndropped);
+	fprintf(fp, "Times are summed over threads, so 'total' can be larger than the wall-clock time\n\n");
+	fprintf(fp, "%-10s %-48s %10s %12s %12s %12s %12s %12s\n", "kind", "name", "ncall", "total(s)", "self(s)", "mean(ms)", "min(ms)",
+		"max(ms)");
+	for (int k = 0; k < nstat; k++) {
+		GMRFLib_profile_stat_tp *s = &(stat[k]);
+		fprintf(fp, "%-10s %-48s %10.0f %12.4f %12.4f %12.4f %12.4f %12.4f\n", GMRFLib_PROFILE_KIND_NAME(s->kind),
+			GMRFLib_function_name_strip(s->name), s->ncall, s->total, s->self, 1.0E3 * s->total / DMAX(1.0, s->ncall),
+			1.0E3 * s->tmin, 1.0E3 * s->tmax);
+	}
+	fclose(fp);
+	Free(fnm);
+	Free(stat);
+
+	return GMRFLib_SUCCESS;
+}
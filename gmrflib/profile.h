@@ -0,0 +1,139 @@
+
+/* profile.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file profile.h
+  \brief Typedefs for \ref profile.c
+*/
+
+#ifndef __GMRFLib_PROFILE_H__
+#define __GMRFLib_PROFILE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+typedef enum {
+	GMRFLib_PROFILE_PLACE = 0,			       /* the OpenMP places, see openmp.h */
+	GMRFLib_PROFILE_THETA,				       /* one configuration of theta */
+	GMRFLib_PROFILE_NEWTON,				       /* one Newton iteration for the mode */
+	GMRFLib_PROFILE_FACTORISE,
+	GMRFLib_PROFILE_SOLVE,
+	GMRFLib_PROFILE_QINV,
+	GMRFLib_PROFILE_LIKELIHOOD,
+	GMRFLib_PROFILE_FUNCTION,			       /* any routine with GMRFLib_ENTER_ROUTINE, only for level 2 */
+	GMRFLib_PROFILE_NKIND
+} GMRFLib_profile_kind_tp;
+
+#define GMRFLib_PROFILE_KIND_NAME(k_)					\
+	((k_) == GMRFLib_PROFILE_PLACE ? "place" :			\
+	 ((k_) == GMRFLib_PROFILE_THETA ? "theta" :			\
+	  ((k_) == GMRFLib_PROFILE_NEWTON ? "newton" :			\
+	   ((k_) == GMRFLib_PROFILE_FACTORISE ? "factorise" :		\
+	    ((k_) == GMRFLib_PROFILE_SOLVE ? "solve" :			\
+	     ((k_) == GMRFLib_PROFILE_QINV ? "qinv" :			\
+	      ((k_) == GMRFLib_PROFILE_LIKELIHOOD ? "likelihood" :	\
+	       ((k_) == GMRFLib_PROFILE_FUNCTION ? "function" : "THIS SHOULD NOT HAPPEN"))))))))
+
+// max depth of nested scopes in one thread, and max number of events kept for the trace in one thread. the summary is always complete
+#define GMRFLib_PROFILE_DEPTH_MAX (64)
+#define GMRFLib_PROFILE_EVENTS_MAX (1024 * 1024)
+
+typedef struct {
+	const char *name;
+	int kind;
+	int level;					       /* omp_get_level() */
+	int team_thread;				       /* omp_get_thread_num() */
+	int depth;
+	double t0;					       /* seconds since start */
+	double dur;
+} GMRFLib_profile_event_tp;
+
+typedef struct {
+	const char *name;
+	int kind;
+	double ncall;
+	double total;					       /* inclusive time */
+	double self;					       /* exclusive time */
+	double tmin;
+	double tmax;
+} GMRFLib_profile_stat_tp;
+
+typedef struct {
+	const char *name;
+	int kind;
+	int stat;					       /* index into 'stat' */
+	double t0;
+	double child;					       /* time used in child scopes */
+} GMRFLib_profile_scope_tp;
+
+typedef struct {
+	int id;
+	int depth;
+	GMRFLib_profile_scope_tp stack[GMRFLib_PROFILE_DEPTH_MAX];
+
+	int nevent;
+	int nevent_alloc;
+	GMRFLib_profile_event_tp *event;
+	size_t ndropped;
+
+	int nstat;
+	int nstat_alloc;
+	GMRFLib_profile_stat_tp *stat;
+	int hash_size;					       /* power of 2 */
+	int *hash;					       /* name ptr -> stat index + 1 */
+} GMRFLib_profile_thread_tp;
+
+// these are no-ops unless profiling is enabled with INLA_PROFILE=1 (or 2, to include all routines with GMRFLib_ENTER_ROUTINE)
+#define GMRFLib_PROFILE_BEGIN(kind_, name_) if (GMRFLib_profile_level) { GMRFLib_profile_begin(kind_, name_); }
+#define GMRFLib_PROFILE_END(name_) if (GMRFLib_profile_level) { GMRFLib_profile_end(name_); }
+#define GMRFLib_PROFILE_NEXT(kind_, name_) if (GMRFLib_profile_level) { GMRFLib_profile_end(name_); GMRFLib_profile_begin(kind_, name_); }
+
+int GMRFLib_profile_begin(GMRFLib_profile_kind_tp kind, const char *name);
+int GMRFLib_profile_end(const char *name);
+int GMRFLib_profile_init(void);
+int GMRFLib_profile_place(const char *name);
+int GMRFLib_profile_write(const char *dir);
+
+__END_DECLS
+#endif
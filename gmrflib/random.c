@@ -33,6 +33,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -148,3 +149,102 @@ int GMRFLib_rng_setstate(void *saved_state)
 	}
 	return GMRFLib_SUCCESS;
 }
+
+/*
+ * Counter-based RNG (Philox4x32-10, Salmon et al. 2011). The output is a pure function of (seed, stream, counter), so
+ * independent streams are obtained just by choosing different 'stream' keys, and any part of a stream can be generated
+ * without generating what comes before it. This makes parallel sampling reproducible whatever the number of threads.
+ */
+#define PHILOX_M0 UINT32_C(0xD2511F53)
+#define PHILOX_M1 UINT32_C(0xCD9E8D57)
+#define PHILOX_W0 UINT32_C(0x9E3779B9)
+#define PHILOX_W1 UINT32_C(0xBB67AE85)
+
+static inline void GMRFLib_philox4x32_10(uint32_t *ctr, const uint32_t *key_in)
+{
+	uint32_t key[2] = { key_in[0], key_in[1] };
+
+	for (int r = 0; r < 10; r++) {
+		uint64_t p0 = (uint64_t) PHILOX_M0 * ctr[0];
+		uint64_t p1 = (uint64_t) PHILOX_M1 * ctr[2];
+		uint32_t hi0 = (uint32_t) (p0 >> 32), lo0 = (uint32_t) p0;
+		uint32_t hi1 = (uint32_t) (p1 >> 32), lo1 = (uint32_t) p1;
+
+		ctr[0] = hi1 ^ ctr[1] ^ key[0];
+		ctr[1] = lo1;
+		ctr[2] = hi0 ^ ctr[3] ^ key[1];
+		ctr[3] = lo0;
+		key[0] += PHILOX_W0;
+		key[1] += PHILOX_W1;
+	}
+}
+
+#undef PHILOX_M0
+#undef PHILOX_M1
+#undef PHILOX_W0
+#undef PHILOX_W1
+
+int GMRFLib_crng_uniform(double *u, int n, uint64_t seed, uint64_t stream, uint64_t offset)
+{
+	/*
+	 * fill u[0..n-1] with Uniform(0,1) (never 0 or 1) from stream 'stream' and 'seed', starting at position 'offset'
+	 * in the stream. each counter gives two values, so 'offset' should be even to line up with a previous call.
+	 */
+	const double scale = 1.0 / 9007199254740992.0;	       /* 2^-53 */
+	uint32_t key[2] = { (uint32_t) seed, (uint32_t) (seed >> 32) };
+	uint64_t c0 = offset / 2;
+
+	for (int i = 0; i < n; i += 2) {
+		uint64_t c = c0 + (uint64_t) (i / 2);
+		uint32_t ctr[4] = { (uint32_t) c, (uint32_t) (c >> 32), (uint32_t) stream, (uint32_t) (stream >> 32) };
+
+		GMRFLib_philox4x32_10(ctr, key);
+		uint64_t b0 = (((uint64_t) ctr[0] << 32) | ctr[1]) >> 11;
+		uint64_t b1 = (((uint64_t) ctr[2] << 32) | ctr[3]) >> 11;
+		u[i] = ((double) b0 + 0.5) * scale;
+		if (i + 1 < n) {
+			u[i + 1] = ((double) b1 + 0.5) * scale;
+		}
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_crng_normal(double *z, int n, uint64_t seed, uint64_t stream, uint64_t offset)
+{
+	/*
+	 * fill z[0..n-1] with N(0,1) from stream 'stream' and 'seed', starting at position 'offset' in the stream, using
+	 * Box-Muller on pairs of uniforms. 
+	 */
+	int m = n + (n % 2);
+	double *u = NULL;
+	double uu[2];
+
+	if (n <= 0) {
+		return GMRFLib_SUCCESS;
+	}
+
+	/*
+	 * use 'z' as storage for the uniforms, except for the last odd one 
+	 */
+	u = z;
+	GMRFLib_crng_uniform(u, m - 2, seed, stream, offset);
+	GMRFLib_crng_uniform(uu, 2, seed, stream, offset + m - 2);
+
+#pragma omp simd
+	for (int i = 0; i < m - 2; i += 2) {
+		double r = sqrt(-2.0 * log(u[i]));
+		double a = 2.0 * M_PI * u[i + 1];
+		z[i] = r * cos(a);
+		z[i + 1] = r * sin(a);
+	}
+
+	double r = sqrt(-2.0 * log(uu[0]));
+	double a = 2.0 * M_PI * uu[1];
+	z[m - 2] = r * cos(a);
+	if (m == n) {
+		z[m - 1] = r * sin(a);
+	}
+
+	return GMRFLib_SUCCESS;
+}
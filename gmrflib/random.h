@@ -57,6 +57,8 @@ double GMRFLib_rng_uniform(void);
 int GMRFLib_rng_init(unsigned long int seed);
 int GMRFLib_rng_set_default_seed(void);
 int GMRFLib_rng_setstate(void *saved_state);
+int GMRFLib_crng_normal(double *z, int n, uint64_t seed, uint64_t stream, uint64_t offset);
+int GMRFLib_crng_uniform(double *u, int n, uint64_t seed, uint64_t stream, uint64_t offset);
 void *GMRFLib_rng_getstate(size_t *siz);
 
 __END_DECLS
@@ -0,0 +1,360 @@
+
+/* smap.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/smap.h"
+
+static mapkit_size_t smap_size(mapkit_size_t used)
+{
+	// the smallest size that can hold 'used' elements
+	mapkit_size_t size = SMAP_GROUP;
+	while (SMAP_MAXFILL(size) < used) {
+		size *= 2;
+	}
+	return size;
+}
+
+/*
+  Implementation for smap_ii (int -> int)
+*/
+
+mapkit_error smap_ii_init(smap_ii *spm)
+{
+	return smap_ii_init_hint(spm, SMAP_GROUP);
+}
+
+mapkit_error smap_ii_init_hint(smap_ii *spm, mapkit_size_t used)
+{
+	mapkit_size_t size = smap_size(used);
+
+	spm->size = size;
+	spm->fill = 0;
+	spm->used = 0;
+	spm->maxfill = SMAP_MAXFILL(size);
+	spm->defaultvalue = 0;
+	spm->ctrl = Calloc(size, signed char);
+	spm->contents = Calloc(size, smap_ii_storage);
+	memset((void *) spm->ctrl, SMAP_EMPTY, (size_t) size);
+
+	return MAPKIT_OK;
+}
+
+void smap_ii_free(smap_ii *spm)
+{
+	Free(spm->ctrl);
+	Free(spm->contents);
+	spm->size = spm->fill = spm->used = spm->maxfill = 0;
+}
+
+mapkit_error smap_ii_copy(smap_ii *to, smap_ii *from)
+{
+	Memcpy((void *) to, (void *) from, sizeof(smap_ii));
+	to->ctrl = Calloc(from->size, signed char);
+	to->contents = Calloc(from->size, smap_ii_storage);
+	Memcpy((void *) to->ctrl, (void *) from->ctrl, (size_t) from->size * sizeof(signed char));
+	Memcpy((void *) to->contents, (void *) from->contents, (size_t) from->size * sizeof(smap_ii_storage));
+
+	return MAPKIT_OK;
+}
+
+static smap_ii_storage *smap_ii_insertslot(smap_ii *spm, int key, int *was_empty)
+{
+	/*
+	 * return the first empty or deleted slot in the probe sequence for 'key', which must not be in the map
+	 */
+	uint64_t h = smap_hash(key);
+	mapkit_size_t mask = spm->size / SMAP_GROUP - 1;
+	mapkit_size_t g = SMAP_H1(h) & mask;
+
+	for (mapkit_size_t step = 1;; step++) {
+		signed char *ctrl = spm->ctrl + g * SMAP_GROUP;
+		unsigned int m = smap_match_free(ctrl);
+		if (m) {
+			mapkit_size_t idx = g * SMAP_GROUP + __builtin_ctz(m);
+			*was_empty = (spm->ctrl[idx] == SMAP_EMPTY);
+			spm->ctrl[idx] = SMAP_H2(h);
+			return spm->contents + idx;
+		}
+		g = (g + step) & mask;
+	}
+}
+
+mapkit_error smap_ii_reallocate(smap_ii *spm, mapkit_size_t used)
+{
+	/*
+	 * rehash into a table that can hold at least 'used' elements. this also clears all deleted slots
+	 */
+	smap_ii old = *spm;
+	mapkit_size_t size = smap_size(used > old.used ? used : old.used);
+	int was_empty;
+
+	spm->size = size;
+	spm->fill = old.used;
+	spm->used = old.used;
+	spm->maxfill = SMAP_MAXFILL(size);
+	spm->ctrl = Calloc(size, signed char);
+	spm->contents = Calloc(size, smap_ii_storage);
+	memset((void *) spm->ctrl, SMAP_EMPTY, (size_t) size);
+
+	for (mapkit_size_t i = 0; i < old.size; i++) {
+		if (old.ctrl[i] >= 0) {
+			*smap_ii_insertslot(spm, old.contents[i].key, &was_empty) = old.contents[i];
+		}
+	}
+	Free(old.ctrl);
+	Free(old.contents);
+
+	return MAPKIT_OK;
+}
+
+mapkit_error smap_ii_adjustcapacity(smap_ii *spm)
+{
+	return smap_ii_reallocate(spm, spm->used);
+}
+
+int *smap_ii_insertptr(smap_ii *spm, int key)
+{
+	smap_ii_storage *s = smap_ii_find(spm, key);
+	int was_empty = 0;
+
+	if (s) {
+		return &(s->value);
+	}
+	if (spm->fill >= spm->maxfill) {
+		// double the size if at least half of the slots are in use, otherwise just reclaim the deleted slots
+		smap_ii_reallocate(spm, (2 * spm->used >= spm->maxfill ? SMAP_MAXFILL(2 * spm->size) : spm->used + 1));
+	}
+
+	s = smap_ii_insertslot(spm, key, &was_empty);
+	s->key = key;
+	s->value = spm->defaultvalue;
+	spm->used++;
+	spm->fill += was_empty;
+
+	return &(s->value);
+}
+
+mapkit_error smap_ii_set(smap_ii *spm, int key, int value)
+{
+	*smap_ii_insertptr(spm, key) = value;
+	return MAPKIT_OK;
+}
+
+mapkit_error smap_ii_remove(smap_ii *spm, int key)
+{
+	smap_ii_storage *s = smap_ii_find(spm, key);
+	if (!s) {
+		MAPKIT_ERROR(MAPKIT_EKEYNOTFOUND);
+	}
+
+	mapkit_size_t idx = s - spm->contents;
+	signed char *ctrl = spm->ctrl + (idx / SMAP_GROUP) * SMAP_GROUP;
+
+	// a lookup stops at the first group with an empty slot. if this group has one already, this slot can be marked empty
+	if (smap_match(ctrl, SMAP_EMPTY)) {
+		spm->ctrl[idx] = SMAP_EMPTY;
+		spm->fill--;
+	} else {
+		spm->ctrl[idx] = SMAP_DELETED;
+	}
+	spm->used--;
+
+	return MAPKIT_OK;
+}
+
+mapkit_size_t smap_ii_next(smap_ii *spm, mapkit_size_t iindex)
+{
+	for (mapkit_size_t i = iindex + 1; i < spm->size; i++) {
+		if (spm->ctrl[i] >= 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+  Implementation for smap_id (int -> double)
+*/
+
+mapkit_error smap_id_init(smap_id *spm)
+{
+	return smap_id_init_hint(spm, SMAP_GROUP);
+}
+
+mapkit_error smap_id_init_hint(smap_id *spm, mapkit_size_t used)
+{
+	mapkit_size_t size = smap_size(used);
+
+	spm->size = size;
+	spm->fill = 0;
+	spm->used = 0;
+	spm->maxfill = SMAP_MAXFILL(size);
+	spm->defaultvalue = 0.0;
+	spm->ctrl = Calloc(size, signed char);
+	spm->contents = Calloc(size, smap_id_storage);
+	memset((void *) spm->ctrl, SMAP_EMPTY, (size_t) size);
+
+	return MAPKIT_OK;
+}
+
+void smap_id_free(smap_id *spm)
+{
+	Free(spm->ctrl);
+	Free(spm->contents);
+	spm->size = spm->fill = spm->used = spm->maxfill = 0;
+}
+
+mapkit_error smap_id_copy(smap_id *to, smap_id *from)
+{
+	Memcpy((void *) to, (void *) from, sizeof(smap_id));
+	to->ctrl = Calloc(from->size, signed char);
+	to->contents = Calloc(from->size, smap_id_storage);
+	Memcpy((void *) to->ctrl, (void *) from->ctrl, (size_t) from->size * sizeof(signed char));
+	Memcpy((void *) to->contents, (void *) from->contents, (size_t) from->size * sizeof(smap_id_storage));
+
+	return MAPKIT_OK;
+}
+
+static smap_id_storage *smap_id_insertslot(smap_id *spm, int key, int *was_empty)
+{
+	/*
+	 * return the first empty or deleted slot in the probe sequence for 'key', which must not be in the map
+	 */
+	uint64_t h = smap_hash(key);
+	mapkit_size_t mask = spm->size / SMAP_GROUP - 1;
+	mapkit_size_t g = SMAP_H1(h) & mask;
+
+	for (mapkit_size_t step = 1;; step++) {
+		signed char *ctrl = spm->ctrl + g * SMAP_GROUP;
+		unsigned int m = smap_match_free(ctrl);
+		if (m) {
+			mapkit_size_t idx = g * SMAP_GROUP + __builtin_ctz(m);
+			*was_empty = (spm->ctrl[idx] == SMAP_EMPTY);
+			spm->ctrl[idx] = SMAP_H2(h);
+			return spm->contents + idx;
+		}
+		g = (g + step) & mask;
+	}
+}
+
+mapkit_error smap_id_reallocate(smap_id *spm, mapkit_size_t used)
+{
+	/*
+	 * rehash into a table that can hold at least 'used' elements. this also clears all deleted slots
+	 */
+	smap_id old = *spm;
+	mapkit_size_t size = smap_size(used > old.used ? used : old.used);
+	int was_empty;
+
+	spm->size = size;
+	spm->fill = old.used;
+	spm->used = old.used;
+	spm->maxfill = SMAP_MAXFILL(size);
+	spm->ctrl = Calloc(size, signed char);
+	spm->contents = Calloc(size, smap_id_storage);
+	memset((void *) spm->ctrl, SMAP_EMPTY, (size_t) size);
+
+	for (mapkit_size_t i = 0; i < old.size; i++) {
+		if (old.ctrl[i] >= 0) {
+			*smap_id_insertslot(spm, old.contents[i].key, &was_empty) = old.contents[i];
+		}
+	}
+	Free(old.ctrl);
+	Free(old.contents);
+
+	return MAPKIT_OK;
+}
+
+mapkit_error smap_id_adjustcapacity(smap_id *spm)
+{
+	return smap_id_reallocate(spm, spm->used);
+}
+
+double *smap_id_insertptr(smap_id *spm, int key)
+{
+	smap_id_storage *s = smap_id_find(spm, key);
+	int was_empty = 0;
+
+	if (s) {
+		return &(s->value);
+	}
+	if (spm->fill >= spm->maxfill) {
+		// double the size if at least half of the slots are in use, otherwise just reclaim the deleted slots
+		smap_id_reallocate(spm, (2 * spm->used >= spm->maxfill ? SMAP_MAXFILL(2 * spm->size) : spm->used + 1));
+	}
+
+	s = smap_id_insertslot(spm, key, &was_empty);
+	s->key = key;
+	s->value = spm->defaultvalue;
+	spm->used++;
+	spm->fill += was_empty;
+
+	return &(s->value);
+}
+
+mapkit_error smap_id_set(smap_id *spm, int key, double value)
+{
+	*smap_id_insertptr(spm, key) = value;
+	return MAPKIT_OK;
+}
+
+mapkit_error smap_id_remove(smap_id *spm, int key)
+{
+	smap_id_storage *s = smap_id_find(spm, key);
+	if (!s) {
+		MAPKIT_ERROR(MAPKIT_EKEYNOTFOUND);
+	}
+
+	mapkit_size_t idx = s - spm->contents;
+	signed char *ctrl = spm->ctrl + (idx / SMAP_GROUP) * SMAP_GROUP;
+
+	// a lookup stops at the first group with an empty slot. if this group has one already, this slot can be marked empty
+	if (smap_match(ctrl, SMAP_EMPTY)) {
+		spm->ctrl[idx] = SMAP_EMPTY;
+		spm->fill--;
+	} else {
+		spm->ctrl[idx] = SMAP_DELETED;
+	}
+	spm->used--;
+
+	return MAPKIT_OK;
+}
+
+mapkit_size_t smap_id_next(smap_id *spm, mapkit_size_t iindex)
+{
+	for (mapkit_size_t i = iindex + 1; i < spm->size; i++) {
+		if (spm->ctrl[i] >= 0) {
+			return i;
+		}
+	}
+	return -1;
+}
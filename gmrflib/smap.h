@@ -0,0 +1,273 @@
+
+/* smap.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file smap.h
+  \brief Typedefs for \ref smap.c
+*/
+
+#ifndef __GMRFLib_SMAP_H__
+#define __GMRFLib_SMAP_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/hashP.h"
+
+/*
+ * Open addressing hash maps int -> int and int -> double, in the style of the 'swiss tables'. Each slot has a control byte which is
+ * either empty, deleted, or full with 7 bits of the hash of the key. The slots come in groups of SMAP_GROUP, and a lookup compares the
+ * control bytes of a whole group against the 7 bits using SSE2, so the keys are only read for the (few) slots that match.
+ *
+ * smap_ii and smap_id have the same API as map_ii and map_id for the functions we use, so the type and the prefix are all that needs
+ * to change. The scan 'for (i = -1; (i = smap_id_next(m, i)) != -1;)' with m->contents[i].key and m->contents[i].value works as
+ * before. There is no 'alwaysdefault'.
+ */
+
+#define SMAP_GROUP (16)
+#define SMAP_EMPTY ((signed char) -128)
+#define SMAP_DELETED ((signed char) -2)
+#define SMAP_MAXFILL(size_) ((size_) - (size_) / 8)
+#define SMAP_H1(h_) ((mapkit_size_t) ((h_) >> 7))
+#define SMAP_H2(h_) ((signed char) ((h_) & 0x7f))
+
+static inline uint64_t smap_hash(int key)
+{
+	uint64_t h = (uint64_t) (uint32_t) key * UINT64_C(0x9E3779B97F4A7C15);
+	return h ^ (h >> 32);
+}
+
+static inline unsigned int smap_match(signed char *ctrl, signed char h2)
+{
+	// bit i is set if ctrl[i] == h2
+#if defined(__SSE2__)
+	__m128i g = _mm_loadu_si128((const __m128i *) ctrl);
+	return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h2)));
+#else
+	unsigned int m = 0;
+	for (int i = 0; i < SMAP_GROUP; i++) {
+		m |= (unsigned int) (ctrl[i] == h2) << i;
+	}
+	return m;
+#endif
+}
+
+static inline unsigned int smap_match_free(signed char *ctrl)
+{
+	// bit i is set if slot i is empty or deleted
+#if defined(__SSE2__)
+	return (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+#else
+	unsigned int m = 0;
+	for (int i = 0; i < SMAP_GROUP; i++) {
+		m |= (unsigned int) (ctrl[i] < 0) << i;
+	}
+	return m;
+#endif
+}
+
+/*
+  Prototypes for smap_ii (int -> int)
+  Default value : 0
+*/
+
+typedef struct {
+	int key;
+	int value;
+} smap_ii_storage;
+
+typedef struct {
+	mapkit_size_t size,			       /* # of slots, a power of 2 and a multiple of SMAP_GROUP */
+	 fill,					       /* # of full and deleted slots */
+	 used,					       /* # of full slots */
+	 maxfill;				       /* max # of full and deleted slots before rehash */
+
+	int defaultvalue;			       /* value for new keys from smap_ii_insertptr() and missing keys in smap_ii_value() */
+
+	signed char *ctrl;			       /* one control byte for each slot */
+	smap_ii_storage *contents;
+} smap_ii;
+
+#define smap_ii_(spm, key) (*(smap_ii_insertptr(spm, key)))
+#define smap_ii_haskey(spm, key) ((smap_ii_ptr(spm, key)) != NULL)
+
+mapkit_error smap_ii_init(smap_ii * spm);
+mapkit_error smap_ii_init_hint(smap_ii * spm, mapkit_size_t used);
+void smap_ii_free(smap_ii * spm);
+mapkit_error smap_ii_copy(smap_ii * to, smap_ii * from);
+mapkit_error smap_ii_reallocate(smap_ii * spm, mapkit_size_t used);
+mapkit_error smap_ii_adjustcapacity(smap_ii * spm);
+int *smap_ii_insertptr(smap_ii * spm, int key);
+mapkit_error smap_ii_set(smap_ii * spm, int key, int value);
+mapkit_error smap_ii_remove(smap_ii * spm, int key);
+mapkit_size_t smap_ii_next(smap_ii * spm, mapkit_size_t iindex);
+
+static inline smap_ii_storage *smap_ii_find(smap_ii * spm, int key)
+{
+	uint64_t h = smap_hash(key);
+	signed char h2 = SMAP_H2(h);
+	mapkit_size_t mask = spm->size / SMAP_GROUP - 1;
+	mapkit_size_t g = SMAP_H1(h) & mask;
+
+	for (mapkit_size_t step = 1;; step++) {
+		signed char *ctrl = spm->ctrl + g * SMAP_GROUP;
+		for (unsigned int m = smap_match(ctrl, h2); m; m &= m - 1) {
+			smap_ii_storage *s = spm->contents + g * SMAP_GROUP + __builtin_ctz(m);
+			if (s->key == key) {
+				return s;
+			}
+		}
+		if (smap_match(ctrl, SMAP_EMPTY)) {
+			return NULL;
+		}
+		g = (g + step) & mask;
+	}
+}
+
+static inline int *smap_ii_ptr(smap_ii * spm, int key)
+{
+	smap_ii_storage *s = smap_ii_find(spm, key);
+	return (s ? &(s->value) : NULL);
+}
+
+static inline mapkit_error smap_ii_get(smap_ii * spm, int key, int *value)
+{
+	smap_ii_storage *s = smap_ii_find(spm, key);
+	if (!s) {
+		MAPKIT_ERROR(MAPKIT_EKEYNOTFOUND);
+	}
+	*value = s->value;
+	return MAPKIT_OK;
+}
+
+static inline int smap_ii_value(smap_ii * spm, int key)
+{
+	smap_ii_storage *s = smap_ii_find(spm, key);
+	return (s ? s->value : spm->defaultvalue);
+}
+
+/*
+  Prototypes for smap_id (int -> double)
+  Default value : 0.0
+*/
+
+typedef struct {
+	int key;
+	double value;
+} smap_id_storage;
+
+typedef struct {
+	mapkit_size_t size,			       /* # of slots, a power of 2 and a multiple of SMAP_GROUP */
+	 fill,					       /* # of full and deleted slots */
+	 used,					       /* # of full slots */
+	 maxfill;				       /* max # of full and deleted slots before rehash */
+
+	double defaultvalue;			       /* value for new keys from smap_id_insertptr() and missing keys in smap_id_value() */
+
+	signed char *ctrl;			       /* one control byte for each slot */
+	smap_id_storage *contents;
+} smap_id;
+
+#define smap_id_(spm, key) (*(smap_id_insertptr(spm, key)))
+#define smap_id_haskey(spm, key) ((smap_id_ptr(spm, key)) != NULL)
+
+mapkit_error smap_id_init(smap_id * spm);
+mapkit_error smap_id_init_hint(smap_id * spm, mapkit_size_t used);
+void smap_id_free(smap_id * spm);
+mapkit_error smap_id_copy(smap_id * to, smap_id * from);
+mapkit_error smap_id_reallocate(smap_id * spm, mapkit_size_t used);
+mapkit_error smap_id_adjustcapacity(smap_id * spm);
+double *smap_id_insertptr(smap_id * spm, int key);
+mapkit_error smap_id_set(smap_id * spm, int key, double value);
+mapkit_error smap_id_remove(smap_id * spm, int key);
+mapkit_size_t smap_id_next(smap_id * spm, mapkit_size_t iindex);
+
+static inline smap_id_storage *smap_id_find(smap_id * spm, int key)
+{
+	uint64_t h = smap_hash(key);
+	signed char h2 = SMAP_H2(h);
+	mapkit_size_t mask = spm->size / SMAP_GROUP - 1;
+	mapkit_size_t g = SMAP_H1(h) & mask;
+
+	for (mapkit_size_t step = 1;; step++) {
+		signed char *ctrl = spm->ctrl + g * SMAP_GROUP;
+		for (unsigned int m = smap_match(ctrl, h2); m; m &= m - 1) {
+			smap_id_storage *s = spm->contents + g * SMAP_GROUP + __builtin_ctz(m);
+			if (s->key == key) {
+				return s;
+			}
+		}
+		if (smap_match(ctrl, SMAP_EMPTY)) {
+			return NULL;
+		}
+		g = (g + step) & mask;
+	}
+}
+
+static inline double *smap_id_ptr(smap_id * spm, int key)
+{
+	smap_id_storage *s = smap_id_find(spm, key);
+	return (s ? &(s->value) : NULL);
+}
+
+static inline mapkit_error smap_id_get(smap_id * spm, int key, double *value)
+{
+	smap_id_storage *s = smap_id_find(spm, key);
+	if (!s) {
+		MAPKIT_ERROR(MAPKIT_EKEYNOTFOUND);
+	}
+	*value = s->value;
+	return MAPKIT_OK;
+}
+
+static inline double smap_id_value(smap_id * spm, int key)
+{
+	smap_id_storage *s = smap_id_find(spm, key);
+	return (s ? s->value : spm->defaultvalue);
+}
+
+__END_DECLS
+#endif
@@ -408,7 +408,7 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 
 	int i, j, k, kk, iii, jjj, bw, ldim, n, *inv_remap = NULL, *rremove = NULL, nrremove;
 	double tmp, Lii_inv, value, *Lmatrix, *cov;
-	map_id **Qinv_L = NULL;
+	smap_id **Qinv_L = NULL;
 
 	bw = problem->sub_sm_fact.bandwidth;
 	ldim = bw + 1;
@@ -421,11 +421,12 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 	 * 
 	 * setup the hash-table for storing Qinv_L 
 	 */
-	Qinv_L = Calloc(n, map_id *);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
+	Qinv_L = Calloc(n, smap_id *);
 //#pragma omp parallel for private(i)
 	for (i = 0; i < n; i++) {
-		Qinv_L[i] = Calloc(1, map_id);
-		map_id_init_hint(Qinv_L[i], ldim);
+		Qinv_L[i] = Calloc(1, smap_id);
+		smap_id_init_hint(Qinv_L[i], ldim);
 	}
 
 	/*
@@ -446,7 +447,7 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 				} else {
 					Cov(i, j) = value = -Lii_inv * tmp;
 				}
-				map_id_set(Qinv_L[i], j, value);
+				smap_id_set(Qinv_L[i], j, value);
 			}
 		}
 	} else {
@@ -478,7 +479,7 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 					tmp += cov_offset[kk] * Lmatrix_offset[k];
 				}
 				cov_set_offset[j] = value = -Lii_inv * tmp;
-				map_id_set(Qinv_L[i], j, value);
+				smap_id_set(Qinv_L[i], j, value);
 			}
 
 			/*
@@ -492,7 +493,7 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 					tmp += cov_offset[k] * Lmatrix_offset[k];
 				}
 				cov_set_offset[i] = value = Lii_inv * (Lii_inv - tmp);
-				map_id_set(Qinv_L[i], i, value);
+				smap_id_set(Qinv_L[i], i, value);
 			}
 		}
 	}
@@ -515,7 +516,7 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 
 		for (i = 0; i < n; i++) {
 			iii = inv_remap[i];
-			for (k = -1, nrremove = 0; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+			for (k = -1, nrremove = 0; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 				j = Qinv_L[i]->contents[k].key;
 				if (j != i) {
 					jjj = inv_remap[j];
@@ -525,11 +526,12 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 				}
 			}
 			for (k = 0; k < nrremove; k++) {
-				map_id_remove(Qinv_L[i], rremove[k]);
+				smap_id_remove(Qinv_L[i], rremove[k]);
 			}
-			map_id_adjustcapacity(Qinv_L[i]);
+			smap_id_adjustcapacity(Qinv_L[i]);
 		}
 	}
+	GMRFLib_memacct_scope(memtag);
 
 	/*
 	 * correct for constraints, if any. need `iremap' as the matrix terms, constr_m and qi_at_m, is in the sub_graph
@@ -541,14 +543,14 @@ int GMRFLib_compute_Qinv_BAND(GMRFLib_problem_tp *problem)
 #pragma omp parallel for private(i, iii, k, j, jjj, kk, value)
 		for (i = 0; i < n; i++) {
 			iii = inv_remap[i];
-			for (k = -1; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+			for (k = -1; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 				j = Qinv_L[i]->contents[k].key;
 				jjj = inv_remap[j];
-				map_id_get(Qinv_L[i], j, &value);
+				smap_id_get(Qinv_L[i], j, &value);
 				for (kk = 0; kk < problem->sub_constr->nc; kk++) {
 					value -= problem->constr_m[iii + kk * n] * problem->qi_at_m[jjj + kk * n];
 				}
-				map_id_set(Qinv_L[i], j, value);
+				smap_id_set(Qinv_L[i], j, value);
 			}
 		}
 	}
@@ -1075,30 +1075,32 @@ int GMRFLib_pardiso_Qinv_INLA(GMRFLib_problem_tp *problem)
 
 	GMRFLib_csr_tp *Qi = problem->sub_sm_fact.PARDISO_fact->pstore[GMRFLib_PSTORE_TNUM_REF]->Qinv;
 	int n = Qi->s->n;
-	map_id **Qinv = Calloc(n, map_id *);
+	smap_id **Qinv = Calloc(n, smap_id *);
 
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
 	for (int i = 0, k = 0; i < n; i++) {
 		int nnb = Qi->s->ia[i + 1] - Qi->s->ia[i];
-		Qinv[i] = Calloc(1, map_id);
-		map_id_init_hint(Qinv[i], nnb);
+		Qinv[i] = Calloc(1, smap_id);
+		smap_id_init_hint(Qinv[i], nnb);
 		for (int jj = 0; jj < nnb; jj++) {
 			int j = Qi->s->ja[k];
-			map_id_set(Qinv[i], j, Qi->a[k]);
+			smap_id_set(Qinv[i], j, Qi->a[k]);
 			k++;
 		}
 	}
+	GMRFLib_memacct_scope(memtag);
 
 	if (problem->sub_constr && problem->sub_constr->nc > 0) {
 #define CODE_BLOCK							\
 		for (int i = 0; i < n; i++) {				\
-			for (int k = -1; (k = (int) map_id_next(Qinv[i], k)) != -1;) { \
+			for (int k = -1; (k = (int) smap_id_next(Qinv[i], k)) != -1;) { \
 				double value = 0.0;			\
 				int j = Qinv[i]->contents[k].key;	\
-				map_id_get(Qinv[i], j, &value);		\
+				smap_id_get(Qinv[i], j, &value);		\
 				for (int kk = 0; kk < problem->sub_constr->nc; kk++) { \
 					value -= problem->constr_m[i + kk * n] * problem->qi_at_m[j + kk * n]; \
 				}					\
-				map_id_set(Qinv[i], j, value);		\
+				smap_id_set(Qinv[i], j, value);		\
 			}						\
 		}
 
@@ -1032,6 +1032,24 @@ int GMRFLib_solve_llt_sparse_matrix2_TAUCS(double *rhs, taucs_ccs_matrix *L, GMR
 	return GMRFLib_SUCCESS;
 }
 
+int GMRFLib_solve_lt_sparse_matrix2_TAUCS(double *rhs, taucs_ccs_matrix *L, GMRFLib_graph_tp *graph, int *remap, int nrhs)
+{
+	// same function but for many rnhs.
+
+	int n = graph->n;
+	for (int j = 0; j < nrhs; j++) {
+		GMRFLib_convert_to_mapped(rhs + j * n, NULL, graph, remap);
+	}
+
+	GMRFLib_my_taucs_dccs_solve_lt2(L, rhs, nrhs);
+
+	for (int j = 0; j < nrhs; j++) {
+		GMRFLib_convert_from_mapped(rhs + j * n, NULL, graph, remap);
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
 int GMRFLib_solve_lt_sparse_matrix_special_TAUCS(double *rhs, taucs_ccs_matrix *L, GMRFLib_graph_tp *graph, int *remap, int findx, int toindx,
 						 int remapped)
 {
@@ -1257,7 +1275,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 	int i, j, k, jp, ii, kk, jj, iii, jjj, n, *nnbs = NULL, **nbs = NULL, *nnbsQ = NULL, *rremove = NULL, nrremove, *inv_remap =
 	    NULL, *Zj_set, nset;
 	taucs_ccs_matrix *L = NULL;
-	map_id **Qinv_L = NULL, *q = NULL;
+	smap_id **Qinv_L = NULL, *q = NULL;
 
 	L = (Lmatrix ? Lmatrix : problem->sub_sm_fact.TAUCS_L);	/* chose matrix to use */
 	n = L->n;
@@ -1292,12 +1310,15 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 	/*
 	 * sort and setup the hash-table for storing Qinv_L 
 	 */
-	Qinv_L = Calloc(n, map_id *);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
+	Qinv_L = Calloc(n, smap_id *);
 #pragma omp parallel for private(i)
 	for (i = 0; i < n; i++) {
+		int memtag_i = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
 		QSORT_FUN(nbs[i], (size_t) nnbs[i], sizeof(int), GMRFLib_icmp);	/* needed? */
-		Qinv_L[i] = Calloc(1, map_id);
-		map_id_init_hint(Qinv_L[i], nnbsQ[i]);
+		Qinv_L[i] = Calloc(1, smap_id);
+		smap_id_init_hint(Qinv_L[i], nnbsQ[i]);
+		GMRFLib_memacct_scope(memtag_i);
 	}
 
 	Zj = Calloc(n, double);
@@ -1310,7 +1331,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 		nset = 0;
 		q = Qinv_L[j];				       /* just to store the ptr */
 
-		for (k = -1; (k = (int) map_id_next(q, k)) != -1;) {
+		for (k = -1; (k = (int) smap_id_next(q, k)) != -1;) {
 			jj = q->contents[k].key;
 			Zj_set[nset++] = jj;
 			Zj[jj] = q->contents[k].value;
@@ -1327,7 +1348,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 			Zj[i] = value;
 			Zj_set[nset++] = i;
 
-			map_id_set(Qinv_L[i], j, value);
+			smap_id_set(Qinv_L[i], j, value);
 		}
 		if (j > 0) {
 			Memset(Zj, 0, n * sizeof(double));
@@ -1345,16 +1366,17 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 
 				for (kk = L->colptr[i] + 1; kk < L->colptr[i + 1]; kk++) {
 					k = L->rowind[kk];
-					if ((ptr = map_id_ptr(Qinv_L[IMIN(k, j)], IMAX(k, j)))) {
+					if ((ptr = smap_id_ptr(Qinv_L[IMIN(k, j)], IMAX(k, j)))) {
 						value -= L->values.d[kk] * *ptr;
 					}
 				}
 
 				value /= diag;
-				map_id_set(Qinv_L[IMIN(i, j)], IMAX(i, j), value);
+				smap_id_set(Qinv_L[IMIN(i, j)], IMAX(i, j), value);
 			}
 		}
 	}
+	GMRFLib_memacct_scope(memtag);
 
 	/*
 	 * compute the mapping 
@@ -1372,7 +1394,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 		rremove = Calloc(n, int);
 		for (i = 0; i < n; i++) {
 			iii = inv_remap[i];
-			for (k = -1, nrremove = 0; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+			for (k = -1, nrremove = 0; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 				j = Qinv_L[i]->contents[k].key;
 
 				if (j != i) {
@@ -1383,9 +1405,9 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 				}
 			}
 			for (k = 0; k < nrremove; k++) {
-				map_id_remove(Qinv_L[i], rremove[k]);
+				smap_id_remove(Qinv_L[i], rremove[k]);
 			}
-			// map_id_adjustcapacity(Qinv_L[i]);
+			// smap_id_adjustcapacity(Qinv_L[i]);
 		}
 	}
 
@@ -1399,16 +1421,16 @@ int GMRFLib_compute_Qinv_TAUCS_compute_OLD(GMRFLib_problem_tp *problem, taucs_cc
 #pragma omp parallel for private(i, iii, k, j, jjj, kk)
 		for (i = 0; i < n; i++) {
 			iii = inv_remap[i];
-			for (k = -1; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+			for (k = -1; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 				j = Qinv_L[i]->contents[k].key;
 				jjj = inv_remap[j];
 
 				double vvalue = 0.0;
-				map_id_get(Qinv_L[i], j, &vvalue);
+				smap_id_get(Qinv_L[i], j, &vvalue);
 				for (kk = 0; kk < problem->sub_constr->nc; kk++) {
 					vvalue -= problem->constr_m[iii + kk * n] * problem->qi_at_m[jjj + kk * n];
 				}
-				map_id_set(Qinv_L[i], j, vvalue);
+				smap_id_set(Qinv_L[i], j, vvalue);
 			}
 		}
 	}
@@ -1448,7 +1470,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 {
 	int n, *nnbs = NULL, **nbs = NULL, *nnbsQ = NULL, *inv_remap = NULL;
 	taucs_ccs_matrix *L = NULL;
-	map_id **Qinv_L = NULL;
+	smap_id **Qinv_L = NULL;
 
 	L = (Lmatrix ? Lmatrix : problem->sub_sm_fact.TAUCS_L);	/* chose matrix to use */
 	n = L->n;
@@ -1487,20 +1509,23 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 	/*
 	 * sort and setup the hash-table for storing Qinv_L 
 	 */
-	Qinv_L = Calloc(n, map_id *);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
+	Qinv_L = Calloc(n, smap_id *);
 #pragma omp parallel for
 	for (int i = 0; i < n; i++) {
+		int memtag_i = GMRFLib_memacct_scope(GMRFLib_MEMTAG_QINV);
 		GMRFLib_qsort(nbs[i], (size_t) nnbs[i], sizeof(int), GMRFLib_icmp);
-		Qinv_L[i] = Calloc(1, map_id);
-		map_id_init_hint(Qinv_L[i], nnbsQ[i]);
+		Qinv_L[i] = Calloc(1, smap_id);
+		smap_id_init_hint(Qinv_L[i], nnbsQ[i]);
+		GMRFLib_memacct_scope(memtag_i);
 	}
 
 	double *Zj = Calloc(n, double);
 	double *d = L->values.d;
 	for (int j = n - 1; j >= 0; j--) {
 		// store those indices that are used and set only those to zero 
-		map_id *q = Qinv_L[j];
-		for (int k = -1; (k = (int) map_id_next(q, k)) != -1;) {
+		smap_id *q = Qinv_L[j];
+		for (int k = -1; (k = (int) smap_id_next(q, k)) != -1;) {
 			int jj = q->contents[k].key;
 			Zj[jj] = q->contents[k].value;
 		}
@@ -1516,9 +1541,10 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 
 			value = (value - dot) / diag;
 			Zj[i] = value;
-			map_id_set(Qinv_L[i], j, value);
+			smap_id_set(Qinv_L[i], j, value);
 		}
 	}
+	GMRFLib_memacct_scope(memtag);
 
 	// compute the mapping 
 	inv_remap = Calloc(n, int);
@@ -1532,7 +1558,7 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 	for (int i = 0; i < n; i++) {
 		int iii = inv_remap[i];
 		int nrremove = 0;
-		for (int k = -1; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+		for (int k = -1; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 			int j = Qinv_L[i]->contents[k].key;
 			if (j != i) {
 				int jjj = inv_remap[j];
@@ -1542,10 +1568,10 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 			}
 		}
 		for (int k = 0; k < nrremove; k++) {
-			map_id_remove(Qinv_L[i], rremove[k]);
+			smap_id_remove(Qinv_L[i], rremove[k]);
 		}
 		// this can be costly, so we ignore. this will do 'realloc'
-		// map_id_adjustcapacity(Qinv_L[i]);
+		// smap_id_adjustcapacity(Qinv_L[i]);
 	}
 
 	/*
@@ -1560,16 +1586,16 @@ int GMRFLib_compute_Qinv_TAUCS_compute(GMRFLib_problem_tp *problem, taucs_ccs_ma
 			int inc = n;
 			int iii = inv_remap[i];
 			double *xx = &(problem->constr_m[iii]);
-			for (int k = -1; (k = (int) map_id_next(Qinv_L[i], k)) != -1;) {
+			for (int k = -1; (k = (int) smap_id_next(Qinv_L[i], k)) != -1;) {
 				int j = Qinv_L[i]->contents[k].key;
 				int jjj = inv_remap[j];
 				double value = 0.0;
 				double *yy = &(problem->qi_at_m[jjj]);
 				double sum = 0.0;
 
-				map_id_get(Qinv_L[i], j, &value);
+				smap_id_get(Qinv_L[i], j, &value);
 				sum = ddot_(&(problem->sub_constr->nc), xx, &inc, yy, &inc);
-				map_id_set(Qinv_L[i], j, value - sum);
+				smap_id_set(Qinv_L[i], j, value - sum);
 			}
 		}
 	}
@@ -1609,6 +1635,69 @@ int GMRFLib_my_taucs_dccs_solve_lt(void *vL, double *x, double *b)
 	return 0;
 }
 
+int GMRFLib_my_taucs_dccs_solve_lt2(void *vL, double *x, int nrhs)
+{
+	// solve L^T x = b for 'nrhs' rhs stored column-wise in 'x', which is overwritten with the solution. the rhs are
+	// interleaved while solving, so each column of L is read once for all rhs.
+
+	taucs_ccs_matrix *L = (taucs_ccs_matrix *) vL;
+	int n = L->n;
+
+	if (n == 0) {
+		return 0;
+	}
+
+	static double **wwork = NULL;
+	static int *wwork_len = NULL;
+	if (!wwork) {
+#pragma omp critical (Name_3f0c8d1b4f7a2e65c9d02b8e1a6f4c37d5e9b210)
+		{
+			if (!wwork) {
+				wwork_len = Calloc(GMRFLib_CACHE_LEN(), int);
+				wwork = Calloc(GMRFLib_CACHE_LEN(), double *);
+			}
+		}
+	}
+
+	int cache_idx = 0;
+	GMRFLib_CACHE_SET_ID(cache_idx);
+
+	if (nrhs * n > wwork_len[cache_idx]) {
+		Free(wwork[cache_idx]);
+		wwork_len[cache_idx] = nrhs * n;
+		wwork[cache_idx] = Calloc(wwork_len[cache_idx], double);
+	}
+	double *y = wwork[cache_idx];
+
+	int ione = 1;
+	for (int j = 0; j < nrhs; j++) {
+		// for(int i = 0; i < n; i++) y[i * nrhs + j] = x[j * n + i];
+		dcopy_(&n, x + j * n, &ione, y + j, &nrhs);
+	}
+
+	for (int i = n - 1; i >= 0; i--) {
+		double *yy = y + i * nrhs;
+		for (int jp = L->colptr[i] + 1; jp < L->colptr[i + 1]; jp++) {
+			double Aij = -L->values.d[jp];
+			// for(int k = 0; k < nrhs; k++) yy[k] -= y[L->rowind[jp] * nrhs + k] * Aij;
+			daxpy_(&nrhs, &Aij, y + L->rowind[jp] * nrhs, &ione, yy, &ione);
+		}
+
+		double iAii = 1.0 / L->values.d[L->colptr[i]];
+#pragma omp simd
+		for (int k = 0; k < nrhs; k++) {
+			yy[k] *= iAii;
+		}
+	}
+
+	for (int j = 0; j < nrhs; j++) {
+		// for(int i = 0; i < n; i++) x[j * n + i] = y[i * nrhs + j];
+		dcopy_(&n, y + j, &nrhs, x + j * n, &ione);
+	}
+
+	return 0;
+}
+
 int GMRFLib_my_taucs_dccs_solve_lt_special(void *vL, double *x, double *b, int from_idx, int to_idx)
 {
 	taucs_ccs_matrix *L = (taucs_ccs_matrix *) vL;
@@ -64,6 +64,7 @@ int GMRFLib_factorise_sparse_matrix_TAUCS(taucs_ccs_matrix ** L, supernodal_fact
 					  GMRFLib_fact_info_tp * finfo, double **L_inv_diag);
 int GMRFLib_free_fact_sparse_matrix_TAUCS(taucs_ccs_matrix * L, double *L_inv_diag, supernodal_factor_matrix * symb_fact);
 int GMRFLib_solve_lt_sparse_matrix_TAUCS(double *rhs, taucs_ccs_matrix * L, GMRFLib_graph_tp * graph, int *remap);
+int GMRFLib_solve_lt_sparse_matrix2_TAUCS(double *rhs, taucs_ccs_matrix * L, GMRFLib_graph_tp * graph, int *remap, int nrhs);
 int GMRFLib_solve_llt_sparse_matrix_TAUCS(double *rhs, taucs_ccs_matrix * L, GMRFLib_graph_tp * graph, int *remap);
 int GMRFLib_solve_lt_sparse_matrix_special_TAUCS(double *rhs, taucs_ccs_matrix * L, GMRFLib_graph_tp * graph, int *remap, int findx, int toindx,
 						 int remapped);
@@ -75,6 +76,7 @@ int GMRFLib_log_determinant_TAUCS(double *logdet, taucs_ccs_matrix * L);
 int GMRFLib_compute_Qinv_validate_TAUCS(GMRFLib_problem_tp * problem, FILE * fp);
 int GMRFLib_compute_Qinv_TAUCS(GMRFLib_problem_tp * problem);
 int GMRFLib_my_taucs_dccs_solve_lt(void *vL, double *x, double *b);
+int GMRFLib_my_taucs_dccs_solve_lt2(void *vL, double *x, int nrhs);
 int GMRFLib_my_taucs_check_flags(int flags);
 int GMRFLib_my_taucs_cmsd(double *cmean, double *csd, int idx, taucs_ccs_matrix * L, double *x);
 int GMRFLib_my_taucs_dccs_solve_lt_special(void *vL, double *x, double *b, int from_idx, int to_idx);
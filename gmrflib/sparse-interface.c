@@ -157,7 +157,11 @@ int GMRFLib_compute_reordering(GMRFLib_sm_fact_tp *sm_fact, GMRFLib_graph_tp *gr
 int GMRFLib_free_reordering(GMRFLib_sm_fact_tp *sm_fact)
 {
 	if (sm_fact) {
-		Free(sm_fact->remap);
+		if (GMRFLib_shared_unref(sm_fact->remap)) {
+			Free(sm_fact->remap);
+		} else {
+			sm_fact->remap = NULL;
+		}
 		sm_fact->bandwidth = 0;
 	}
 	return GMRFLib_SUCCESS;
@@ -218,7 +222,10 @@ int GMRFLib_build_sparse_matrix(int thread_id, GMRFLib_sm_fact_tp *sm_fact, GMRF
 int GMRFLib_factorise_sparse_matrix(GMRFLib_sm_fact_tp *sm_fact, GMRFLib_graph_tp *graph)
 {
 	int ret;
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_FACTORISE);
+
+#pragma omp atomic
+	GMRFLib_factorise_count++;
 
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
@@ -275,7 +282,8 @@ int GMRFLib_free_fact_sparse_matrix(GMRFLib_sm_fact_tp *sm_fact)
 
 		case GMRFLib_SMTP_TAUCS:
 		{
-			GMRFLib_free_fact_sparse_matrix_TAUCS(sm_fact->TAUCS_L, sm_fact->TAUCS_L_inv_diag, sm_fact->TAUCS_symb_fact);
+			GMRFLib_free_fact_sparse_matrix_TAUCS(sm_fact->TAUCS_L, sm_fact->TAUCS_L_inv_diag,
+							      (GMRFLib_shared_unref(sm_fact->TAUCS_symb_fact) ? sm_fact->TAUCS_symb_fact : NULL));
 			GMRFLib_taucs_cache_free(sm_fact->TAUCS_cache);
 			sm_fact->TAUCS_L = NULL;
 			sm_fact->TAUCS_symb_fact = NULL;
@@ -310,7 +318,7 @@ int GMRFLib_solve_l_sparse_matrix(double *rhs, int nrhs, GMRFLib_sm_fact_tp *sm_
 	/*
 	 * rhs in real world. solve L x=rhs, rhs is overwritten by the solution 
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
@@ -357,7 +365,7 @@ int GMRFLib_solve_lt_sparse_matrix(double *rhs, int nrhs, GMRFLib_sm_fact_tp *sm
 	/*
 	 * rhs in real world. solve L^Tx=rhs, rhs is overwritten by the solution 
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
@@ -372,10 +380,20 @@ int GMRFLib_solve_lt_sparse_matrix(double *rhs, int nrhs, GMRFLib_sm_fact_tp *sm
 
 	case GMRFLib_SMTP_TAUCS:
 	{
-		omp_set_num_threads(GMRFLib_openmp->max_threads_inner);
-#pragma omp parallel for num_threads(GMRFLib_openmp->max_threads_inner)
-		for (int i = 0; i < nrhs; i++) {
-			GMRFLib_solve_lt_sparse_matrix_TAUCS(&rhs[i * graph->n], sm_fact->TAUCS_L, graph, sm_fact->remap);
+		if (nrhs == 1) {
+			GMRFLib_solve_lt_sparse_matrix_TAUCS(rhs, sm_fact->TAUCS_L, graph, sm_fact->remap);
+		} else {
+			// split the rhs's in one block pr thread and solve each block with the multi-rhs solver
+			int nt = IMIN(nrhs, GMRFLib_openmp->max_threads_inner);
+			int block_nrhs = nrhs / nt + (nrhs % nt != 0);
+			int nblock = nrhs / block_nrhs + (nrhs % block_nrhs != 0);
+
+#pragma omp parallel for num_threads(nt)
+			for (int i = 0; i < nblock; i++) {
+				int offset = i * block_nrhs;
+				int nr = IMIN(block_nrhs, nrhs - offset);
+				GMRFLib_solve_lt_sparse_matrix2_TAUCS(&rhs[offset * graph->n], sm_fact->TAUCS_L, graph, sm_fact->remap, nr);
+			}
 		}
 	}
 		break;
@@ -404,7 +422,7 @@ int GMRFLib_solve_llt_sparse_matrix(double *rhs, int nrhs, GMRFLib_sm_fact_tp *s
 	/*
 	 * rhs in real world. solve Q x=rhs, where Q=L L^T 
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 
 	if (sm_fact->smtp == GMRFLib_SMTP_BAND) {
 		omp_set_num_threads(GMRFLib_openmp->max_threads_inner);
@@ -518,7 +536,7 @@ int GMRFLib_solve_llt_sparse_matrix_special(double *rhs, GMRFLib_sm_fact_tp *sm_
 	/*
 	 * rhs in real world. solve Q x=rhs, where Q=L L^T. BUT, here we know that rhs is 0 execpt for a 1 at index idx.
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
@@ -559,7 +577,7 @@ int GMRFLib_solve_lt_sparse_matrix_special(double *rhs, GMRFLib_sm_fact_tp *sm_f
 	 * rhs in real world, bchol in mapped world. solve L^Tx=b backward only from rhs[findx] up to rhs[toindx]. note that
 	 * findx and toindx is in mapped world. if remapped, do not remap/remap-back the rhs before solving.
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
 	{
@@ -601,7 +619,7 @@ int GMRFLib_solve_l_sparse_matrix_special(double *rhs, GMRFLib_sm_fact_tp *sm_fa
 	 * rhs in real world, bchol in mapped world. solve Lx=b backward only from rhs[findx] up to rhs[toindx]. note that
 	 * findx and toindx is in mapped world. if remapped, do not remap/remap-back the rhs before solving.
 	 */
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_SOLVE);
 	switch (sm_fact->smtp) {
 	case GMRFLib_SMTP_BAND:
 	{
@@ -739,7 +757,7 @@ int GMRFLib_bitmap_factorisation(const char *filename_body, GMRFLib_sm_fact_tp *
 int GMRFLib_compute_Qinv(void *problem)
 {
 	GMRFLib_problem_tp *p = (GMRFLib_problem_tp *) problem;
-	GMRFLib_ENTER_ROUTINE;
+	GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_QINV);
 
 	switch (p->sub_sm_fact.smtp) {
 	case GMRFLib_SMTP_BAND:
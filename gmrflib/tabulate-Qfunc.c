@@ -57,10 +57,10 @@
 			dp = &(args->Q->a[j]);				\
 		} else if (args->Q_idx) {				\
 			int ii = -1;					\
-			map_ii_get(args->Q_idx[imin], imax, &ii);	\
+			smap_ii_get(args->Q_idx[imin], imax, &ii);	\
 			dp = &(args->Q->a[ii]);				\
 		} else {						\
-			dp = map_id_ptr(args->values[imin], imax);	\
+			dp = smap_id_ptr(args->values[imin], imax);	\
 		}							\
 									\
 		if (_prec_scale) {					\
@@ -147,8 +147,9 @@ int GMRFLib_tabulate_Qfunc_core(int thread_id,
 		assert(arg->Q->a[0] >= 0.0);
 		GMRFLib_graph_duplicate(&(arg->graph), graph);
 	} else {
-		arg->values = Calloc(graph->n, map_id *);
-		map_id *work = Calloc(graph->n, map_id);
+		arg->values = Calloc(graph->n, smap_id *);
+		int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_FACTOR);
+		smap_id *work = Calloc(graph->n, smap_id);
 		for (i = 0; i < graph->n; i++) {
 			arg->values[i] = work + i;
 		}
@@ -156,14 +157,15 @@ int GMRFLib_tabulate_Qfunc_core(int thread_id,
 		omp_set_num_threads(GMRFLib_openmp->max_threads_inner);
 //#pragma omp parallel for private(i, j, k) num_threads(GMRFLib_openmp->max_threads_inner)
 		for (i = 0; i < graph->n; i++) {
-			map_id_init_hint(arg->values[i], graph->lnnbs[i] + 1);
-			map_id_set(arg->values[i], i, (*Qfunc) (thread_id, i, i, NULL, Qfunc_arg));	/* diagonal */
+			smap_id_init_hint(arg->values[i], graph->lnnbs[i] + 1);
+			smap_id_set(arg->values[i], i, (*Qfunc) (thread_id, i, i, NULL, Qfunc_arg));	/* diagonal */
 
 			for (j = 0; j < graph->lnnbs[i]; j++) {
 				k = graph->lnbs[i][j];
-				map_id_set(arg->values[i], k, (*Qfunc) (thread_id, i, k, NULL, Qfunc_arg));
+				smap_id_set(arg->values[i], k, (*Qfunc) (thread_id, i, k, NULL, Qfunc_arg));
 			}
 		}
+		GMRFLib_memacct_scope(memtag);
 	}
 
 	return GMRFLib_SUCCESS;
@@ -324,7 +326,7 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 	(*tabulate_Qfunc)->Qfunc_arg = (void *) arg;
 
 	arg->n = (*graph)->n;
-	arg->values = Calloc((*graph)->n, map_id *);
+	arg->values = Calloc((*graph)->n, smap_id *);
 	if (log_prec_omp) {
 		int tmax = GMRFLib_MAX_THREADS();
 		arg->log_prec_omp = Calloc(tmax, double *);
@@ -338,22 +340,23 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 	/*
 	 * allocate hash-table with the *correct* number of elements
 	 */
-	map_id *work = Calloc((*graph)->n, map_id);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_FACTOR);
+	smap_id *work = Calloc((*graph)->n, smap_id);
 	for (i = 0; i < (*graph)->n; i++) {
 		arg->values[i] = work + i;
 	}
 	for (i = 0; i < (*graph)->n; i++) {
-		map_id_init_hint(arg->values[i], (*graph)->lnnbs[i] + 1);
+		smap_id_init_hint(arg->values[i], (*graph)->lnnbs[i] + 1);
 	}
 
 	/*
 	 * fill all entries in the graph with zero 
 	 */
 	for (i = 0; i < (*graph)->n; i++) {
-		map_id_set(arg->values[i], i, 0.0);
+		smap_id_set(arg->values[i], i, 0.0);
 		for (jj = 0; jj < (*graph)->lnnbs[i]; jj++) {
 			j = (*graph)->lnbs[i][jj];
-			map_id_set(arg->values[i], j, 0.0);
+			smap_id_set(arg->values[i], j, 0.0);
 		}
 	}
 
@@ -374,7 +377,7 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 					j = j - off;
 					ii = IMIN(i, j);
 					jj = IMAX(i, j);
-					map_id_set(arg->values[ii], jj, value);
+					smap_id_set(arg->values[ii], jj, value);
 					if (debug) {
 						printf("set (i,j,val) = (%d,%d,%g)\n", i, j, value);
 					}
@@ -391,7 +394,7 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 					j = j - off;
 					ii = IMIN(i, j);
 					jj = IMAX(i, j);
-					map_id_set(arg->values[ii], jj, value);
+					smap_id_set(arg->values[ii], jj, value);
 					if (debug) {
 						printf("set (i,j,val) = (%d,%d,%g)\n", i, j, value);
 					}
@@ -411,7 +414,7 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 				j = j - off;
 				ii = IMIN(i, j);
 				jj = IMAX(i, j);
-				map_id_set(arg->values[ii], jj, value);
+				smap_id_set(arg->values[ii], jj, value);
 				if (debug)
 					printf("set (i,j,val) = (%d,%d,%g)\n", i, j, value);
 			}
@@ -421,6 +424,7 @@ int GMRFLib_tabulate_Qfunc_from_file(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 	}
 
 	GMRFLib_matrix_free(M);
+	GMRFLib_memacct_scope(memtag);
 	return GMRFLib_SUCCESS;
 }
 
@@ -476,7 +480,7 @@ int GMRFLib_tabulate_Qfunc_from_list(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 	(*tabulate_Qfunc)->Qfunc_arg = (void *) arg;
 
 	arg->n = (*graph)->n;
-	arg->values = Calloc((*graph)->n, map_id *);
+	arg->values = Calloc((*graph)->n, smap_id *);
 	if (log_prec_omp) {
 		int tmax = GMRFLib_MAX_THREADS();
 		arg->log_prec_omp = Calloc(tmax, double *);
@@ -490,7 +494,8 @@ int GMRFLib_tabulate_Qfunc_from_list(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 	/*
 	 * allocate hash-table with the *correct* number of elements
 	 */
-	map_id *work = Calloc((*graph)->n, map_id);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_FACTOR);
+	smap_id *work = Calloc((*graph)->n, smap_id);
 	for (i = 0; i < (*graph)->n; i++) {
 		arg->values[i] = work + i;
 	}
@@ -498,11 +503,11 @@ int GMRFLib_tabulate_Qfunc_from_list(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 //#pragma omp parallel for private(i)
 	for (i = 0; i < (*graph)->n; i++) {
 		int j, jj;
-		map_id_init_hint(arg->values[i], (*graph)->lnnbs[i] + 1);
-		map_id_set(arg->values[i], i, 0.0);
+		smap_id_init_hint(arg->values[i], (*graph)->lnnbs[i] + 1);
+		smap_id_set(arg->values[i], i, 0.0);
 		for (jj = 0; jj < (*graph)->lnnbs[i]; jj++) {
 			j = (*graph)->lnbs[i][jj];
-			map_id_set(arg->values[i], j, 0.0);    /* fill them with default = 0.0 */
+			smap_id_set(arg->values[i], j, 0.0);    /* fill them with default = 0.0 */
 		}
 	}
 
@@ -511,10 +516,11 @@ int GMRFLib_tabulate_Qfunc_from_list(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc,
 		if (ilist[i] <= jlist[i]) {
 			ii = ilist[i] - off;
 			jj = jlist[i] - off;
-			map_id_set(arg->values[ii], jj, Qijlist[i]);
+			smap_id_set(arg->values[ii], jj, Qijlist[i]);
 		}
 	}
 
+	GMRFLib_memacct_scope(memtag);
 	return GMRFLib_SUCCESS;
 }
 
@@ -546,7 +552,7 @@ int GMRFLib_tabulate_Qfunc_from_list2(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc
 	(*tabulate_Qfunc)->Qfunc_arg = (void *) arg;
 
 	arg->n = graph->n;
-	arg->values = Calloc(graph->n, map_id *);
+	arg->values = Calloc(graph->n, smap_id *);
 	if (log_prec_omp != NULL) {
 		int tmax = GMRFLib_MAX_THREADS();
 		arg->log_prec_omp = Calloc(tmax, double *);
@@ -560,18 +566,19 @@ int GMRFLib_tabulate_Qfunc_from_list2(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc
 	/*
 	 * allocate hash-table with the *correct* number of elements
 	 */
-	map_id *work = Calloc(graph->n, map_id);
+	int memtag = GMRFLib_memacct_scope(GMRFLib_MEMTAG_FACTOR);
+	smap_id *work = Calloc(graph->n, smap_id);
 	for (i = 0; i < graph->n; i++) {
 		arg->values[i] = work + i;
 	}
 	for (i = 0; i < graph->n; i++) {
 		int j, jj;
 
-		map_id_init_hint(arg->values[i], graph->lnnbs[i] + 1);
-		map_id_set(arg->values[i], i, 0.0);
+		smap_id_init_hint(arg->values[i], graph->lnnbs[i] + 1);
+		smap_id_set(arg->values[i], i, 0.0);
 		for (jj = 0; jj < graph->lnnbs[i]; jj++) {
 			j = graph->lnbs[i][jj];
-			map_id_set(arg->values[i], j, 0.0);    /* fill them with default = 0.0 */
+			smap_id_set(arg->values[i], j, 0.0);    /* fill them with default = 0.0 */
 		}
 	}
 
@@ -580,10 +587,11 @@ int GMRFLib_tabulate_Qfunc_from_list2(GMRFLib_tabulate_Qfunc_tp **tabulate_Qfunc
 		if (ilist[i] <= jlist[i]) {
 			ii = ilist[i] - off;
 			jj = jlist[i] - off;
-			map_id_set(arg->values[ii], jj, Qijlist[i]);
+			smap_id_set(arg->values[ii], jj, Qijlist[i]);
 		}
 	}
 
+	GMRFLib_memacct_scope(memtag);
 	return GMRFLib_SUCCESS;
 }
 
@@ -612,14 +620,14 @@ int GMRFLib_free_tabulate_Qfunc(GMRFLib_tabulate_Qfunc_tp *tabulate_Qfunc)
 		}
 		if (arg->Q_idx) {
 			for (i = 0; i < arg->n; i++) {
-				map_ii_free(arg->Q_idx[i]);
+				smap_ii_free(arg->Q_idx[i]);
 				Free(arg->Q_idx[i]);
 			}
 			Free(arg->Q_idx);
 		}
 		if (arg->values) {
 			for (i = 0; i < arg->n; i++) {
-				map_id_free(arg->values[i]);
+				smap_id_free(arg->values[i]);
 			}
 			Free(arg->values[0]);
 			Free(arg->values);
@@ -41,6 +41,7 @@
 #include <zlib.h>
 
 #include "GMRFLib/hashP.h"
+#include "GMRFLib/smap.h"
 #include "GMRFLib/GMRFLibP.h"
 #include "GMRFLib/GMRFLib.h"
 
@@ -61,13 +62,13 @@ __BEGIN_DECLS
  */
     typedef struct {
 	int n;						       /* the size of the graph */
-	map_id **values;				       /* hash-table for the values */
+	smap_id **values;				       /* hash-table for the values */
 	double **log_prec_omp;				       /* log(prec) thread dependent */
 
 	// new format
 	GMRFLib_graph_tp *graph;
 	GMRFLib_csr_tp *Q;
-	map_ii **Q_idx;
+	smap_ii **Q_idx;
 } GMRFLib_tabulate_Qfunc_arg_tp;
 
 /*!
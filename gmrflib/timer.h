@@ -71,7 +71,10 @@ typedef struct {
 	double ctime_acc2;				       /* accumulated ctime^2 */
 } GMRFLib_timer_hashval_tp;
 
-#define GMRFLib_ENTER_ROUTINE \
+#define GMRFLib_ENTER_ROUTINE GMRFLib_ENTER_ROUTINE_KIND(GMRFLib_PROFILE_FUNCTION)
+
+// as GMRFLib_ENTER_ROUTINE, but the routine is a scope of the given kind for the profiler, see profile.h
+#define GMRFLib_ENTER_ROUTINE_KIND(kind_)				\
 	GMRFLib_DEBUG_INIT();						\
 	GMRFLib_TRACE_INIT();						\
 	static double trace_cpu_acc_ = 0.0;				\
@@ -79,12 +82,14 @@ typedef struct {
 	static double trace_cpu_ = 0.0;					\
 	_Pragma("omp threadprivate(trace_cpu_)")			\
 	trace_cpu_ = GMRFLib_timer();					\
-	GMRFLib_TRACE_i("Enter, total", trace_count_);
+	GMRFLib_TRACE_i("Enter, total", trace_count_);			\
+	GMRFLib_PROFILE_BEGIN(kind_, __GMRFLib_FuncName)
 
 #define GMRFLib_LEAVE_ROUTINE if (1)					\
 	{								\
 		trace_cpu_acc_ += (GMRFLib_timer() - trace_cpu_);		\
 		GMRFLib_TRACE_idd("Leave, count cpu/count*1E6 total", trace_count_, 1.0E6 * trace_cpu_acc_ / (double) trace_count_, trace_cpu_acc_); \
+		GMRFLib_PROFILE_END(__GMRFLib_FuncName);		\
 	}
 
 double GMRFLib_timer_windows(void);
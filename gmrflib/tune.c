@@ -0,0 +1,340 @@
+
+/* tune.c
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ */
+
+/*
+ * Persisted autotuning. At startup we time alternatives to chose the cutoffs in my_sort2_id() and my_sort2_dd() and the kernels for
+ * GMRFLib_ddot_idx() and GMRFLib_dsum_idx(). This adds to the startup time for every run, and the timings are noisy on busy
+ * machines. With 'inla -m tune' a more thorough calibration is done once, and the result is written to a per-host profile which is
+ * then loaded at startup instead of measuring again.
+ *
+ * The profile is a text file with 'key = value' lines. Its location is $INLA_TUNE_FILE, or $HOME/.inla/tune-<host>.txt
+ */
+
+#include "GMRFLib/GMRFLib.h"
+#include "GMRFLib/GMRFLibP.h"
+#include "GMRFLib/tune.h"
+
+#include <strings.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(WINDOWS)
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+static GMRFLib_tune_tp *tune_profile = NULL;
+
+static char *tune_host(void)
+{
+	char host[256] = "localhost";
+
+#if defined(WINDOWS)
+	const char *h = getenv("COMPUTERNAME");
+	if (h) {
+		snprintf(host, sizeof(host), "%s", h);
+	}
+#else
+	if (gethostname(host, sizeof(host) - 1) != 0) {
+		snprintf(host, sizeof(host), "%s", "localhost");
+	}
+	host[sizeof(host) - 1] = '\0';
+#endif
+
+	return Strdup(host);
+}
+
+static const char *tune_dot_kernel(int verbose)
+{
+	/*
+	 * time the ddot_idx and dsum_idx kernels that this CPU supports, over a range of lengths, and chose the fastest one
+	 */
+	const char *kernels[] = { "generic", "avx2", "avx512" };
+	const int nkernels = (int) (sizeof(kernels) / sizeof(kernels[0]));
+	const int nmax = 1024;
+	const int ntimes = 2000;
+	const char *best = kernels[0];
+	double time_best = 0.0;
+	volatile double sink = 0.0;
+
+	double *v = Calloc(nmax, double);
+	double *a = Calloc(4 * nmax, double);
+	int *idx = Calloc(nmax, int);
+
+	for (int i = 0; i < 4 * nmax; i++) {
+		a[i] = GMRFLib_uniform();
+	}
+	for (int i = 0; i < nmax; i++) {
+		v[i] = GMRFLib_uniform();
+		idx[i] = 4 * i + (int) (4.0 * GMRFLib_uniform());
+	}
+
+	for (int k = 0; k < nkernels; k++) {
+		if (GMRFLib_dot_set_kernel(kernels[k]) != GMRFLib_SUCCESS) {
+			continue;
+		}
+
+		double time_used = 0.0;
+		for (int times = -ntimes / 10; times < ntimes; times++) {
+			double tref = GMRFLib_timer();
+			for (int n = 8; n <= nmax; n *= 2) {
+				sink += GMRFLib_ddot_idx(n, v, a, idx) + GMRFLib_dsum_idx(n, a, idx);
+			}
+			if (times >= 0) {
+				time_used += GMRFLib_timer() - tref;
+			}
+		}
+
+		if (verbose) {
+			printf("\tdot-kernel %-8s time %.4f seconds\n", kernels[k], time_used);
+		}
+		// we have a slight preference for the simpler ones
+		if (k == 0 || time_used < 0.95 * time_best) {
+			best = kernels[k];
+			time_best = time_used;
+		}
+	}
+
+	Free(v);
+	Free(a);
+	Free(idx);
+	GMRFLib_dot_set_kernel(best);
+
+	return best;
+}
+
+GMRFLib_tune_tp *GMRFLib_tune_profile(void)
+{
+	return tune_profile;
+}
+
+char *GMRFLib_tune_filename(void)
+{
+	const char *fnm = getenv("INLA_TUNE_FILE");
+	if (fnm && *fnm) {
+		return Strdup(fnm);
+	}
+#if defined(WINDOWS)
+	const char *homedir = getenv("USERPROFILE");
+#else
+	const char *homedir = getenv("HOME");
+#endif
+	if (!homedir || !*homedir) {
+		return NULL;
+	}
+
+	char *host = tune_host();
+	char *filename = NULL;
+	GMRFLib_sprintf(&filename, "%s/.inla/tune-%s.txt", homedir, host);
+	Free(host);
+
+	return filename;
+}
+
+int GMRFLib_tune_free(GMRFLib_tune_tp *tune)
+{
+	if (tune) {
+		Free(tune->host);
+		Free(tune->dot_kernel);
+		Free(tune);
+	}
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_tune_load(const char *filename)
+{
+	/*
+	 * load and apply the tuning profile. returns !GMRFLib_SUCCESS if there is no valid profile for this host, in which case the
+	 * caller has to measure as before.
+	 */
+	char *fnm = (filename ? Strdup(filename) : GMRFLib_tune_filename());
+	if (!fnm) {
+		return !GMRFLib_SUCCESS;
+	}
+
+	FILE *fp = fopen(fnm, "r");
+	Free(fnm);
+	if (!fp) {
+		return !GMRFLib_SUCCESS;
+	}
+
+	GMRFLib_tune_tp *tune = Calloc(1, GMRFLib_tune_tp);
+	tune->version = -1;
+	tune->sort2_id_cut_off = -1;
+	tune->sort2_dd_cut_off = -1;
+	tune->Qx_strategy = -1;
+	tune->preopt_predictor_strategy = -1;
+
+	char line[1024], key[128], value[512];
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, " %127[^=# \t\n] = %511s", key, value) != 2) {
+			continue;
+		}
+		if (!strcasecmp(key, "version")) {
+			tune->version = atoi(value);
+		} else if (!strcasecmp(key, "host")) {
+			Free(tune->host);
+			tune->host = Strdup(value);
+		} else if (!strcasecmp(key, "sort2_id_cut_off")) {
+			tune->sort2_id_cut_off = atoi(value);
+		} else if (!strcasecmp(key, "sort2_dd_cut_off")) {
+			tune->sort2_dd_cut_off = atoi(value);
+		} else if (!strcasecmp(key, "dot_kernel")) {
+			Free(tune->dot_kernel);
+			tune->dot_kernel = Strdup(value);
+		} else if (!strcasecmp(key, "Qx_strategy")) {
+			tune->Qx_strategy = atoi(value);
+		} else if (!strcasecmp(key, "preopt_predictor_strategy")) {
+			tune->preopt_predictor_strategy = atoi(value);
+		}
+	}
+	fclose(fp);
+
+	// a profile from another host or from an older version is ignored
+	char *host = tune_host();
+	int ok = (tune->version == GMRFLib_TUNE_VERSION && tune->host && !strcmp(tune->host, host) &&
+		  tune->sort2_id_cut_off > 0 && tune->sort2_dd_cut_off > 0);
+	Free(host);
+	if (!ok) {
+		GMRFLib_tune_free(tune);
+		return !GMRFLib_SUCCESS;
+	}
+
+	if (tune->Qx_strategy > 1) {
+		tune->Qx_strategy = -1;
+	}
+	if (tune->preopt_predictor_strategy > 1) {
+		tune->preopt_predictor_strategy = -1;
+	}
+
+	GMRFLib_sort2_id_cut_off = tune->sort2_id_cut_off;
+	GMRFLib_sort2_dd_cut_off = tune->sort2_dd_cut_off;
+
+	// INLA_DOT_KERNEL has precedence. if the kernel is not supported, we keep the one chosen by GMRFLib_dot_init()
+	if (!getenv("INLA_DOT_KERNEL") && tune->dot_kernel) {
+		GMRFLib_dot_set_kernel(tune->dot_kernel);
+	}
+
+	GMRFLib_tune_free(tune_profile);
+	tune_profile = tune;
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_tune_write(const char *filename, GMRFLib_tune_tp *tune)
+{
+	char *fnm = (filename ? Strdup(filename) : GMRFLib_tune_filename());
+	if (!fnm) {
+		GMRFLib_ERROR(GMRFLib_EOPENFILE);
+	}
+
+	if (!filename && !getenv("INLA_TUNE_FILE")) {
+		// create $HOME/.inla if needed
+		char *dir = Strdup(fnm);
+		char *p = GMRFLib_rindex(dir, '/');
+		if (p) {
+			*p = '\0';
+#if defined(WINDOWS)
+			_mkdir(dir);
+#else
+			mkdir(dir, 0755);
+#endif
+		}
+		Free(dir);
+	}
+
+	FILE *fp = fopen(fnm, "w");
+	if (!fp) {
+		fprintf(stderr, "\n\n*** Cannot open tuning profile [%s] for writing\n\n", fnm);
+		Free(fnm);
+		GMRFLib_ERROR(GMRFLib_EOPENFILE);
+	}
+
+	fprintf(fp, "# INLA tuning profile, written by 'inla -m tune'\n");
+	fprintf(fp, "# a strategy equal to -1 means that it is measured for each model\n");
+	fprintf(fp, "version = %1d\n", tune->version);
+	fprintf(fp, "host = %s\n", tune->host);
+	fprintf(fp, "sort2_id_cut_off = %1d\n", tune->sort2_id_cut_off);
+	fprintf(fp, "sort2_dd_cut_off = %1d\n", tune->sort2_dd_cut_off);
+	fprintf(fp, "dot_kernel = %s\n", tune->dot_kernel);
+	fprintf(fp, "Qx_strategy = %1d\n", tune->Qx_strategy);
+	fprintf(fp, "preopt_predictor_strategy = %1d\n", tune->preopt_predictor_strategy);
+	fclose(fp);
+	Free(fnm);
+
+	return GMRFLib_SUCCESS;
+}
+
+int GMRFLib_tune_run(const char *filename, int verbose)
+{
+	/*
+	 * run the calibration, write the profile and make it the current one. the cutoffs are the median over repeated runs of the tests
+	 * done at startup, which makes them robust against a busy machine
+	 */
+	const int nrep = 11;
+	int *id = Calloc(2 * nrep, int);
+	int *dd = id + nrep;
+	double time_used = -GMRFLib_timer();
+
+	for (int r = 0; r < nrep; r++) {
+		id[r] = my_sort2_id_test_cutoff(0);
+		dd[r] = my_sort2_dd_test_cutoff(0);
+	}
+	qsort((void *) id, (size_t) nrep, sizeof(int), GMRFLib_icmp);
+	qsort((void *) dd, (size_t) nrep, sizeof(int), GMRFLib_icmp);
+
+	GMRFLib_tune_tp *tune = Calloc(1, GMRFLib_tune_tp);
+	tune->version = GMRFLib_TUNE_VERSION;
+	tune->host = tune_host();
+	tune->sort2_id_cut_off = id[nrep / 2];
+	tune->sort2_dd_cut_off = dd[nrep / 2];
+	tune->dot_kernel = Strdup(tune_dot_kernel(verbose));
+	tune->Qx_strategy = -1;
+	tune->preopt_predictor_strategy = -1;
+	Free(id);
+
+	GMRFLib_sort2_id_cut_off = tune->sort2_id_cut_off;
+	GMRFLib_sort2_dd_cut_off = tune->sort2_dd_cut_off;
+
+	time_used += GMRFLib_timer();
+	if (verbose) {
+		printf("\tsort2_id_cut_off = %1d\n", tune->sort2_id_cut_off);
+		printf("\tsort2_dd_cut_off = %1d\n", tune->sort2_dd_cut_off);
+		printf("\tdot_kernel       = %s\n", tune->dot_kernel);
+		printf("\ttuning took %.2f seconds\n", time_used);
+	}
+
+	int ret = GMRFLib_tune_write(filename, tune);
+
+	GMRFLib_tune_free(tune_profile);
+	tune_profile = tune;
+
+	return ret;
+}
@@ -0,0 +1,81 @@
+
+/* tune.h
+ * 
+ * Copyright (C) 2024 Havard Rue
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The author's contact information:
+ *
+ *        Haavard Rue
+ *        CEMSE Division
+ *        King Abdullah University of Science and Technology
+ *        Thuwal 23955-6900, Saudi Arabia
+ *        Email: haavard.rue@kaust.edu.sa
+ *        Office: +966 (0)12 808 0640
+ *
+ *
+ */
+
+/*!
+  \file tune.h
+  \brief Typedefs for \ref tune.c
+*/
+
+#ifndef __GMRFLib_TUNE_H__
+#define __GMRFLib_TUNE_H__
+
+#include <stdlib.h>
+
+#undef __BEGIN_DECLS
+#undef __END_DECLS
+#ifdef __cplusplus
+#define __BEGIN_DECLS extern "C" {
+#define __END_DECLS }
+#else
+#define __BEGIN_DECLS					       /* empty */
+#define __END_DECLS					       /* empty */
+#endif
+
+__BEGIN_DECLS
+#include "GMRFLib/GMRFLibP.h"
+
+/*
+ * increase this if the meaning of the entries in the profile changes, so old profiles are ignored
+ */
+#define GMRFLib_TUNE_VERSION (1)
+
+/*
+ * the per-host tuning profile, as written by 'inla -m tune'. a strategy equal to -1 means that it is to be measured for each model
+ */
+typedef struct {
+	int version;
+	char *host;
+	int sort2_id_cut_off;
+	int sort2_dd_cut_off;
+	char *dot_kernel;
+	int Qx_strategy;
+	int preopt_predictor_strategy;
+} GMRFLib_tune_tp;
+
+GMRFLib_tune_tp *GMRFLib_tune_profile(void);
+char *GMRFLib_tune_filename(void);
+int GMRFLib_tune_free(GMRFLib_tune_tp * tune);
+int GMRFLib_tune_load(const char *filename);
+int GMRFLib_tune_run(const char *filename, int verbose);
+int GMRFLib_tune_write(const char *filename, GMRFLib_tune_tp * tune);
+
+__END_DECLS
+#endif
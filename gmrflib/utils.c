@@ -231,6 +231,9 @@ void *GMRFLib_calloc(size_t nmemb, size_t size, const char *file, const char *fu
 
 	assert(nmemb * size < PTRDIFF_MAX);
 	ptr = calloc(nmemb, size);
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	GMRFLib_memacct_alloc(ptr, file, funcname);
+#endif
 
 	if (malloc_debug > 0) {
 		printf(" *** MALLOC_DEBUG *** %s: %s: %1d: calloc nmemb = %zu size = %zu, got address %p\n", file, funcname, lineno, nmemb, size,
@@ -254,6 +257,9 @@ void *GMRFLib_malloc(size_t size, const char *file, const char *funcname, int li
 
 	assert(size < PTRDIFF_MAX);
 	ptr = malloc(size);
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	GMRFLib_memacct_alloc(ptr, file, funcname);
+#endif
 
 	if (malloc_debug > 0) {
 		printf(" *** MALLOC_DEBUG *** %s: %s: %1d: malloc size = %zu, got address %p\n", file, funcname, lineno, size, ptr);
@@ -276,7 +282,13 @@ void *GMRFLib_realloc(void *old_ptr, size_t size, const char *file, const char *
 	char *msg = NULL;
 
 	assert(size < PTRDIFF_MAX);
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	GMRFLib_memacct_free(old_ptr);
+#endif
 	ptr = realloc(old_ptr, size);
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+	GMRFLib_memacct_alloc(ptr, file, funcname);
+#endif
 
 
 #pragma GCC diagnostic push
@@ -303,6 +315,9 @@ void GMRFLib_free(void *ptr, const char *file, const char *funcname, int lineno)
 		if (malloc_debug > 0) {
 			printf(" *** MALLOC_DEBUG *** %s: %s: %d: free address %p\n", file, funcname, lineno, ptr);
 		}
+#if defined(GMRFLib_MEMORY_ACCOUNTING)
+		GMRFLib_memacct_free(ptr);
+#endif
 		free(ptr);
 	} else {
 		fprintf(stderr, "%s:%s:%d: Try to free a NULL-ptr\n", file, funcname, lineno);
@@ -890,6 +905,62 @@ mapkit_size_t GMRFLib_nelm_map_id(map_id *hash)
 	return nelm;
 }
 
+/*
+ * Reference counts for read-only objects that are shared, and not copied, between an object and its duplicates. See
+ * GMRFLib_duplicate_problem() and GMRFLib_duplicate_ai_store() with 'copy_ptr'. An object that is not in the table has one owner.
+ */
+static map_vpi shared_store;
+static int shared_store_init = 0;
+
+void *GMRFLib_shared_ref(void *ptr)
+{
+	/*
+	 * add an owner to 'ptr' and return it
+	 */
+	if (!ptr) {
+		return NULL;
+	}
+#pragma omp critical (Name_dd514d1a46a4e2fd25b4792eb45f86e4d09d3a22)
+	{
+		if (!shared_store_init) {
+			map_vpi_init_hint(&shared_store, 128);
+			shared_store_init = 1;
+		}
+		int *nref = map_vpi_ptr(&shared_store, ptr);
+		if (nref) {
+			(*nref)++;
+		} else {
+			map_vpi_set(&shared_store, ptr, 2);
+		}
+	}
+	return ptr;
+}
+
+int GMRFLib_shared_unref(void *ptr)
+{
+	/*
+	 * remove an owner from 'ptr'. return GMRFLib_TRUE if the caller was the last owner, and then the caller has to free the object
+	 */
+	int last = GMRFLib_TRUE;
+
+	if (!ptr) {
+		return last;
+	}
+#pragma omp critical (Name_dd514d1a46a4e2fd25b4792eb45f86e4d09d3a22)
+	{
+		if (shared_store_init) {
+			int *nref = map_vpi_ptr(&shared_store, ptr);
+			if (nref) {
+				last = GMRFLib_FALSE;
+				if (--(*nref) <= 1) {
+					map_vpi_remove(&shared_store, ptr);
+				}
+			}
+		}
+	}
+	return last;
+}
+
 map_ii *GMRFLib_duplicate_map_ii(map_ii *hash)
 {
 	/*
@@ -121,6 +121,7 @@ int GMRFLib_printf_gsl_matrix2(FILE * fp, gsl_matrix * matrix, const char *forma
 int GMRFLib_printf_gsl_vector(FILE * fp, gsl_vector * vector, const char *format);
 int GMRFLib_printf_matrix(FILE * fp, double *A, int m, int n);
 int GMRFLib_scale_vector(double *x, int n);
+int GMRFLib_shared_unref(void *ptr);
 int GMRFLib_sprintf(char **ptr, const char *fmt, ...);
 int GMRFLib_trace_functions(const char *name);
 int GMRFLib_unique_additive(int *n, double *x, double eps);
@@ -141,6 +142,7 @@ void *GMRFLib_calloc(size_t nmemb, size_t size, const char *file, const char *fu
 void *GMRFLib_malloc(size_t size, const char *file, const char *funcname, int lineno);
 void *GMRFLib_memcpy(void *dest, const void *src, size_t n);
 void *GMRFLib_realloc(void *old_ptr, size_t size, const char *file, const char *funcname, int lineno);
+void *GMRFLib_shared_ref(void *ptr);
 void GMRFLib_delay(int msec);
 void GMRFLib_delay_random(int msec_low, int msec_high);
 void GMRFLib_free(void *ptr, const char *file, const char *funcname, int lineno);
@@ -65,6 +65,8 @@ int my_dir_exists(const char *filename);
 int my_setenv(char *str, int prefix);
 int GMRFLib_sprintf(char **ptr, const char *fmt, ...);
 void GMRFLib_delay(int msec);
+int GMRFLib_set_blas_num_threads(int threads);
+int inla_error_general(const char *msg);
 
 __END_DECLS
 #include "R-interface.h"
@@ -78,6 +80,499 @@ double R_rgeneric_cputime = 0.0;
 
 #if defined(INLA_WITH_LIBR)
 
+static int R_pool_child = 0;				       /* set in the R-workers, see below */
+
+static void inla_R_error_exit(int status)
+{
+	/*
+	 * exit after an error. an R-worker is a fork()'ed copy of this process, and exit() would then write out the stdio-buffers inherited
+	 * from the parent a second time, like those for the log- and results-files, so only stderr is flushed
+	 */
+	if (R_pool_child) {
+		fflush(stderr);
+		_Exit(status);
+	}
+	exit(status);
+}
+
+#if !defined(WINDOWS)
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*
+ * The pool of R workers. Each worker is a fork()'ed copy of this process, with the R-session as it is when the pool is started, so the
+ * models are loaded only once. A worker receives the calls over one pipe and returns the results over another one, so the rgeneric and
+ * funcall calls run concurrently in different workers. Calls that change the R-session are done in all workers and in this process. Each
+ * worker remembers its last call and result, and identical calls are answered without asking the worker.
+ */
+typedef struct {
+	pid_t pid;
+	int fd_req;					       /* write the calls to */
+	int fd_res;					       /* read the results from */
+	omp_lock_t lock;
+
+	size_t len_last;				       /* the last call and its result */
+	char *last;
+	int n_last;
+	double *x_last;
+} inla_R_worker_tp;
+
+static inla_R_worker_tp *R_pool = NULL;
+static int R_pool_n = 0;
+
+static int inla_R_pool_write(int fd, void *buf, size_t len)
+{
+	char *p = (char *) buf;
+	while (len > 0) {
+		ssize_t k = write(fd, p, len);
+		if (k < 0 && errno == EINTR) {
+			continue;
+		}
+		if (k <= 0) {
+			return !INLA_OK;
+		}
+		p += k;
+		len -= (size_t) k;
+	}
+	return INLA_OK;
+}
+
+static int inla_R_pool_read(int fd, void *buf, size_t len)
+{
+	char *p = (char *) buf;
+	while (len > 0) {
+		ssize_t k = read(fd, p, len);
+		if (k < 0 && errno == EINTR) {
+			continue;
+		}
+		if (k <= 0) {
+			return !INLA_OK;
+		}
+		p += k;
+		len -= (size_t) k;
+	}
+	return INLA_OK;
+}
+
+static char *inla_R_pool_pack(size_t *len, inla_R_cmd_tp cmd, const char *s1, const char *s2, int n, double *x)
+{
+	/*
+	 * a call is the header {cmd, len(s1), len(s2), n}, then s1, s2 and x. the lengths include the '\0', and are zero for NULL
+	 */
+	int hdr[4] = { (int) cmd, (s1 ? (int) strlen(s1) + 1 : 0), (s2 ? (int) strlen(s2) + 1 : 0), n };
+	*len = sizeof(hdr) + (size_t) hdr[1] + (size_t) hdr[2] + (size_t) n * sizeof(double);
+
+	char *buf = (char *) malloc(*len), *p = buf;
+	memcpy(p, hdr, sizeof(hdr));
+	p += sizeof(hdr);
+	if (hdr[1]) {
+		memcpy(p, s1, (size_t) hdr[1]);
+		p += hdr[1];
+	}
+	if (hdr[2]) {
+		memcpy(p, s2, (size_t) hdr[2]);
+		p += hdr[2];
+	}
+	if (n) {
+		memcpy(p, x, (size_t) n * sizeof(double));
+	}
+
+	return buf;
+}
+
+static void inla_R_pool_worker(int fd_req, int fd_res)
+{
+	/*
+	 * the main loop of a worker, which exit when the pipe is closed. the worker is serial, as the parent runs the workers in parallel,
+	 * and the thread-pool of the parent is not valid after fork()
+	 */
+	size_t len = 0;
+
+	omp_set_num_threads(1);
+	GMRFLib_set_blas_num_threads(1);
+
+	while (inla_R_pool_read(fd_req, &len, sizeof(size_t)) == INLA_OK) {
+		char *buf = (char *) malloc(len);
+		if (inla_R_pool_read(fd_req, buf, len) != INLA_OK) {
+			break;
+		}
+
+		int hdr[4];
+		memcpy(hdr, buf, sizeof(hdr));
+		inla_R_cmd_tp cmd = (inla_R_cmd_tp) hdr[0];
+		const char *s1 = (hdr[1] ? buf + sizeof(hdr) : NULL);
+		const char *s2 = (hdr[2] ? buf + sizeof(hdr) + hdr[1] : NULL);
+		int n = hdr[3];
+		double *x = (double *) calloc((size_t) (n > 0 ? n : 1), sizeof(double));
+		if (n) {
+			memcpy(x, buf + sizeof(hdr) + hdr[1] + hdr[2], (size_t) n * sizeof(double));
+		}
+
+		int ret = INLA_OK, n_out = 0;
+		double *x_out = NULL;
+
+		switch (cmd) {
+		case INLA_R_ASSIGN:
+			ret = inla_R_assign_(s1, &n, x);
+			break;
+		case INLA_R_FUNCALL1:
+			ret = inla_R_funcall1_(&n_out, &x_out, s1, &n, x);
+			break;
+		case INLA_R_FUNCALL2:
+			ret = inla_R_funcall2_(&n_out, &x_out, s1, s2, &n, x);
+			break;
+		case INLA_R_GET:
+			ret = inla_R_get_(&n_out, &x_out, s1);
+			break;
+		case INLA_R_INLALOAD:
+			ret = inla_R_inlaload_(s1);
+			break;
+		case INLA_R_LIBRARY:
+			ret = inla_R_library_(s1);
+			break;
+		case INLA_R_LOAD:
+			ret = inla_R_load_(s1);
+			break;
+		case INLA_R_RGENERIC:
+			ret = inla_R_rgeneric_(&n_out, &x_out, s1, s2, &n, x);
+			break;
+		case INLA_R_SOURCE:
+			ret = inla_R_source_(s1);
+			break;
+		default:
+			assert(0 == 1);
+		}
+
+		if (inla_R_pool_write(fd_res, &ret, sizeof(int)) != INLA_OK ||
+		    inla_R_pool_write(fd_res, &n_out, sizeof(int)) != INLA_OK ||
+		    (n_out > 0 && inla_R_pool_write(fd_res, x_out, (size_t) n_out * sizeof(double)) != INLA_OK)) {
+			break;
+		}
+
+		free(x_out);
+		free(x);
+		free(buf);
+	}
+
+	_exit(0);
+}
+
+static void inla_R_pool_died(inla_R_worker_tp *w)
+{
+	char *msg = NULL;
+	GMRFLib_sprintf(&msg, "R-worker [pid=%1d] has died. See above for its error message.", (int) w->pid);
+	inla_error_general(msg);
+}
+
+static int inla_R_pool_send(inla_R_worker_tp *w, char *buf, size_t len, int *n_out, double **x_out)
+{
+	/*
+	 * send the call to worker 'w' and read its result. the worker must be locked
+	 */
+	int ret = INLA_OK, n = 0;
+	double *x = NULL;
+
+	if (inla_R_pool_write(w->fd_req, &len, sizeof(size_t)) != INLA_OK ||
+	    inla_R_pool_write(w->fd_req, buf, len) != INLA_OK ||
+	    inla_R_pool_read(w->fd_res, &ret, sizeof(int)) != INLA_OK || inla_R_pool_read(w->fd_res, &n, sizeof(int)) != INLA_OK) {
+		inla_R_pool_died(w);
+	}
+	if (n > 0) {
+		x = (double *) calloc((size_t) n, sizeof(double));
+		if (inla_R_pool_read(w->fd_res, x, (size_t) n * sizeof(double)) != INLA_OK) {
+			inla_R_pool_died(w);
+		}
+	}
+
+	if (n_out) {
+		*n_out = n;
+		*x_out = x;
+	} else {
+		free(x);
+	}
+
+	return ret;
+}
+
+static void inla_R_pool_forget(inla_R_worker_tp *w)
+{
+	free(w->last);
+	free(w->x_last);
+	w->last = NULL;
+	w->x_last = NULL;
+	w->len_last = 0;
+	w->n_last = 0;
+}
+
+static int inla_R_pool_call(inla_R_cmd_tp cmd, const char *s1, const char *s2, int n, double *x, int *n_out, double **x_out)
+{
+	/*
+	 * do the call in one of the workers. prefer a free worker which did this call the last time, then any free worker, otherwise wait
+	 * for the one belonging to this thread
+	 */
+	size_t len = 0;
+	char *buf = inla_R_pool_pack(&len, cmd, s1, s2, n, x);
+	int k, k0, ret = INLA_OK;
+	inla_R_worker_tp *w = NULL;
+
+	k0 = omp_get_thread_num();
+	if (omp_get_level() > 1) {
+		k0 += 31 * omp_get_ancestor_thread_num(1);
+	}
+	k0 = k0 % R_pool_n;
+
+	for (int i = 0; i < R_pool_n && !w; i++) {
+		k = (k0 + i) % R_pool_n;
+		if (R_pool[k].len_last == len && omp_test_lock(&(R_pool[k].lock))) {
+			if (R_pool[k].last && R_pool[k].len_last == len && memcmp(R_pool[k].last, buf, len) == 0) {
+				w = R_pool + k;
+			} else {
+				omp_unset_lock(&(R_pool[k].lock));
+			}
+		}
+	}
+	if (w) {
+		*n_out = w->n_last;
+		*x_out = NULL;
+		if (w->n_last > 0) {
+			*x_out = (double *) calloc((size_t) w->n_last, sizeof(double));
+			memcpy(*x_out, w->x_last, (size_t) w->n_last * sizeof(double));
+		}
+		omp_unset_lock(&(w->lock));
+		free(buf);
+		return INLA_OK;
+	}
+
+	for (int i = 0; i < R_pool_n && !w; i++) {
+		k = (k0 + i) % R_pool_n;
+		if (omp_test_lock(&(R_pool[k].lock))) {
+			w = R_pool + k;
+		}
+	}
+	if (!w) {
+		w = R_pool + k0;
+		omp_set_lock(&(w->lock));
+	}
+
+	if (R_debug) {
+		fprintf(stderr, "R-interface[%1d]: call worker [%1d] cmd [%1d] s1 [%s]\n", omp_get_thread_num(), (int) (w - R_pool), (int) cmd,
+			(s1 ? s1 : "NULL"));
+		fflush(stderr);
+	}
+
+	ret = inla_R_pool_send(w, buf, len, n_out, x_out);
+	inla_R_pool_forget(w);
+	if (cmd != INLA_R_GET) {
+		w->last = buf;
+		w->len_last = len;
+		w->n_last = *n_out;
+		if (*n_out > 0) {
+			w->x_last = (double *) calloc((size_t) (*n_out), sizeof(double));
+			memcpy(w->x_last, *x_out, (size_t) (*n_out) * sizeof(double));
+		}
+	} else {
+		free(buf);
+	}
+	omp_unset_lock(&(w->lock));
+
+	return ret;
+}
+
+static int inla_R_pool_broadcast(inla_R_cmd_tp cmd, const char *s1, int n, double *x)
+{
+	/*
+	 * do a call that change the R-session in all workers
+	 */
+	size_t len = 0;
+	char *buf = inla_R_pool_pack(&len, cmd, s1, NULL, n, x);
+
+	for (int k = 0; k < R_pool_n; k++) {
+		omp_set_lock(&(R_pool[k].lock));
+		inla_R_pool_send(R_pool + k, buf, len, NULL, NULL);
+		inla_R_pool_forget(R_pool + k);
+		omp_unset_lock(&(R_pool[k].lock));
+	}
+	free(buf);
+
+	return INLA_OK;
+}
+
+static void inla_R_pool_stop_(void)
+{
+	/*
+	 * at exit, other threads may still use the pool, so we only close the pipes to the workers, which then exit. the locks and the
+	 * memory are left as they are
+	 */
+	if (R_pool_child) {
+		return;
+	}
+	for (int k = 0; k < R_pool_n; k++) {
+		close(R_pool[k].fd_req);
+	}
+}
+
+int inla_R_pool_start(int n)
+{
+	/*
+	 * start 'n' R-workers from the current R-session. this must be called from a serial region, after the models are loaded
+	 */
+	if (n <= 0 || R_pool_n > 0 || R_init) {
+		return INLA_OK;
+	}
+	assert(omp_in_parallel() == 0);
+
+	fflush(stdout);
+	fflush(stderr);
+
+	// a dead worker gives an error from write(), instead of killing us
+	signal(SIGPIPE, SIG_IGN);
+
+	R_pool = (inla_R_worker_tp *) calloc((size_t) n, sizeof(inla_R_worker_tp));
+	for (int k = 0; k < n; k++) {
+		int p_req[2], p_res[2];
+
+		if (pipe(p_req) != 0 || pipe(p_res) != 0) {
+			fprintf(stderr, "\n *** ERROR *** cannot create pipes for R-worker [%1d]: %s\n", k, strerror(errno));
+			exit(1);
+		}
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "\n *** ERROR *** cannot fork R-worker [%1d]: %s\n", k, strerror(errno));
+			exit(1);
+		}
+		if (pid == 0) {
+			R_pool_child = 1;
+			for (int kk = 0; kk < k; kk++) {
+				close(R_pool[kk].fd_req);
+				close(R_pool[kk].fd_res);
+			}
+			close(p_req[1]);
+			close(p_res[0]);
+			inla_R_pool_worker(p_req[0], p_res[1]);
+		}
+
+		close(p_req[0]);
+		close(p_res[1]);
+		R_pool[k].pid = pid;
+		R_pool[k].fd_req = p_req[1];
+		R_pool[k].fd_res = p_res[0];
+		omp_init_lock(&(R_pool[k].lock));
+	}
+	R_pool_n = n;
+	atexit(inla_R_pool_stop_);
+
+	if (R_debug) {
+		fprintf(stderr, "R-interface: started [%1d] R-workers\n", n);
+		fflush(stderr);
+	}
+
+	return INLA_OK;
+}
+
+int inla_R_pool_stop(void)
+{
+	if (R_pool_child || R_pool_n == 0) {
+		return INLA_OK;
+	}
+
+	// the workers exit when their pipe is closed
+	for (int k = 0; k < R_pool_n; k++) {
+		close(R_pool[k].fd_req);
+	}
+	for (int k = 0; k < R_pool_n; k++) {
+		waitpid(R_pool[k].pid, NULL, 0);
+		close(R_pool[k].fd_res);
+		inla_R_pool_forget(R_pool + k);
+		omp_destroy_lock(&(R_pool[k].lock));
+	}
+	free(R_pool);
+	R_pool = NULL;
+	R_pool_n = 0;
+
+	return INLA_OK;
+}
+
+int inla_R_pool_active(void)
+{
+	return (R_pool_n > 0);
+}
+
+static int inla_R_pool_do_(inla_R_cmd_tp cmd, void *a1, void *a2, void *a3, void *a4, void *a5, void *a6)
+{
+	/*
+	 * the pool-version of inla_R_do_(). return -1 if the call is not for the workers
+	 */
+	int ret = -1;
+	double tref = omp_get_wtime();
+
+	switch (cmd) {
+	case INLA_R_FUNCALL1:
+		ret = inla_R_pool_call(cmd, (const char *) a3, NULL, *((int *) a4), (double *) a5, (int *) a1, (double **) a2);
+		break;
+	case INLA_R_FUNCALL2:
+	case INLA_R_RGENERIC:
+		ret = inla_R_pool_call(cmd, (const char *) a3, (const char *) a4, *((int *) a5), (double *) a6, (int *) a1, (double **) a2);
+		break;
+	case INLA_R_GET:
+		ret = inla_R_pool_call(cmd, (const char *) a3, NULL, 0, NULL, (int *) a1, (double **) a2);
+		break;
+	case INLA_R_ASSIGN:
+		// do these also in this process
+		inla_R_pool_broadcast(cmd, (const char *) a1, *((int *) a2), (double *) a3);
+		break;
+	case INLA_R_INLALOAD:
+	case INLA_R_LIBRARY:
+	case INLA_R_LOAD:
+	case INLA_R_SOURCE:
+		if (a1) {
+			inla_R_pool_broadcast(cmd, (const char *) a1, 0, NULL);
+		}
+		break;
+	case INLA_R_EXIT:
+		inla_R_pool_stop();
+		break;
+	default:
+		break;
+	}
+
+	if (ret >= 0) {
+		tref = omp_get_wtime() - tref;
+#pragma omp atomic
+		R_rgeneric_cputime += tref;
+	}
+
+	return ret;
+}
+
+#else							       /* !defined(WINDOWS) */
+
+int inla_R_pool_start(int n)
+{
+	// fork() is not available
+	return INLA_OK;
+}
+
+int inla_R_pool_stop(void)
+{
+	return INLA_OK;
+}
+
+int inla_R_pool_active(void)
+{
+	return 0;
+}
+
+static int inla_R_pool_do_(inla_R_cmd_tp cmd, void *a1, void *a2, void *a3, void *a4, void *a5, void *a6)
+{
+	return -1;
+}
+#endif							       /* !defined(WINDOWS) */
+
 int inla_R_do_(inla_R_cmd_tp cmd, void *a1, void *a2, void *a3, void *a4, void *a5, void *a6)
 {
 	if (R_init) {
@@ -85,6 +580,13 @@ int inla_R_do_(inla_R_cmd_tp cmd, void *a1, void *a2, void *a3, void *a4, void *
 	}
 
 	int ret = 0;
+	if (inla_R_pool_active()) {
+		ret = inla_R_pool_do_(cmd, a1, a2, a3, a4, a5, a6);
+		if (ret >= 0) {
+			return ret;
+		}
+		ret = 0;
+	}
 #pragma omp critical (Name_95227b3fc78ae25be9b977b6385cae68f179f781)
 	{
 		R_rgeneric_cputime -= omp_get_wtime();
@@ -211,7 +713,7 @@ int inla_R_init_(void)
 						fprintf(stderr, "*** R_interface  ERROR: Evaluate this in R:  Sys.getenv(\"R_HOME\")\n");
 						fprintf(stderr, "\n\n");
 						fflush(stderr);
-						exit(1);
+						inla_R_error_exit(1);
 					}
 					fprintf(stderr, "\n\n");
 					fprintf(stderr, "*** R-interface WARNING: Environment variable R_HOME is not set or invalid.\n");
@@ -261,7 +763,7 @@ int inla_R_library_(const char *library)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR ***: load library [%s] failed.\n", library);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	UNPROTECT(3);
 
@@ -293,7 +795,7 @@ int inla_R_source_(const char *filename)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR ***: source R-file [%s] failed.\n", filename);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	UNPROTECT(5);
 
@@ -323,7 +825,7 @@ int inla_R_load_(const char *filename)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR ***: load RData-file [%s] failed.\n", filename);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	UNPROTECT(3);
 
@@ -353,7 +855,7 @@ int inla_R_inlaload_(const char *filename)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR ***: inla.load file [%s] failed.\n", filename);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	UNPROTECT(3);
 
@@ -392,7 +894,7 @@ int inla_R_funcall2_(int *n_out, double **x_out, const char *function, const cha
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR *** Calling R-function [%s] with tag [%s] and [%1d] arguments\n", function, tag, *n);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	*n_out = (int) XLENGTH(result);
 	assert(*n_out >= 0);
@@ -444,7 +946,7 @@ int inla_R_funcall_jp_(int *n_out, double **x_out, const char *function, int *n,
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR *** Calling R-function [%s] with [%1d] arguments\n", function, *n);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	*n_out = (int) XLENGTH(result);
 	assert(*n_out >= 0);
@@ -490,7 +992,7 @@ int inla_R_assign_(const char *variable, int *n, double *x)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR *** assign [%s] with n [%1d] failed\n", variable, *n);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	UNPROTECT(4);
 
@@ -521,7 +1023,7 @@ int inla_R_get_(int *n_out, double **x_out, const char *variable)
 	result = PROTECT(R_tryEval(e, R_GlobalEnv, &error));
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR *** get [%s]\n", variable);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	*n_out = (int) XLENGTH(result);
 	assert(*n_out >= 0);
@@ -570,7 +1072,7 @@ int inla_R_rgeneric_(int *n_out, double **x_out, const char *cmd, const char *mo
 	if (result == NULL || error) {
 		fprintf(stderr, "\n *** ERROR *** rgeneric [%s] with model [%s] failed\n", cmd, model);
 		UNPROTECT(5);
-		exit(1);
+		inla_R_error_exit(1);
 	}
 	*n_out = (int) XLENGTH(result);
 	assert(*n_out >= 0);
@@ -628,6 +1130,21 @@ int inla_R_exit_(void)
 	inla_R_no_lib();
 }
 
+int inla_R_pool_start(int n)
+{
+	return 0;
+}
+
+int inla_R_pool_stop(void)
+{
+	return 0;
+}
+
+int inla_R_pool_active(void)
+{
+	return 0;
+}
+
 int inla_R_init_(void)
 {
 	inla_R_no_lib();
@@ -99,5 +99,9 @@ int inla_R_exit_(void);
 
 void *inla_R_vector_of_strings(int n, char **s);
 
+int inla_R_pool_active(void);
+int inla_R_pool_start(int n);
+int inla_R_pool_stop(void);
+
 __END_DECLS
 #endif
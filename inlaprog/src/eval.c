@@ -53,8 +53,29 @@ typedef struct {
 	double default_value;
 } eval_keep_vars_tp;
 
+typedef struct {
+	char *expression;				       /* the key, the storage is owned by the prior */
+	int ntheta;
+	muParserHandle_t hParser;
+	muFloat_t *theta;				       /* THETAk are bound to these */
+	eval_keep_vars_tp *keep_vars;			       /* other variables, reset to x before each evaluation */
+} eval_compiled_tp;
+
 static const unsigned char debug = 0;
 
+/* 
+   compiled expressions, one list for each thread
+ */
+static eval_compiled_tp **eval_compiled = NULL;
+static int eval_ncompiled = 0;
+#pragma omp threadprivate(eval_compiled, eval_ncompiled)
+
+/* 
+   the splines of the table-priors, see inla_eval_table_keep()
+ */
+static GMRFLib_spline_tp **eval_tables = NULL;
+static int eval_ntables = 0;
+
 /* 
    local functions...
  */
@@ -151,9 +172,13 @@ double inla_eval(char *expression, double *x, double *theta, int ntheta)
 	} else if (strncasecmp(expression, "RPRIOR:", strlen("RPRIOR:")) == 0) {
 		int n_out = 0;
 		double *x_out = NULL, ret;
-#pragma omp critical (Name_4c5c16c31e48a263f6ddcd4bc0d6f4b7e792d0de)
-		{
+		if (inla_R_pool_active()) {
 			inla_R_funcall1(&n_out, &x_out, expression + strlen("RPRIOR:"), &ntheta, theta);
+		} else {
+#pragma omp critical (Name_4c5c16c31e48a263f6ddcd4bc0d6f4b7e792d0de)
+			{
+				inla_R_funcall1(&n_out, &x_out, expression + strlen("RPRIOR:"), &ntheta, theta);
+			}
 		}
 		assert(n_out == 1);
 		ret = *x_out;
@@ -164,70 +189,102 @@ double inla_eval(char *expression, double *x, double *theta, int ntheta)
 	assert(0 == 1);
 	return 0.0;
 }
-double inla_eval_expression(char *expression, double *x, double *theta, int ntheta)
+static eval_compiled_tp *inla_eval_compile(char *expression, double *x, double *theta, int ntheta)
 {
-	double value;
+	/*
+	 * create a parser for this expression, with THETAk bound to the theta-slots and other variables bound to the x-slots, and parse it.
+	 * the parse evaluates the expression, so this is done at the given x and theta, as for example lgamma(0) aborts in GSL
+	 */
+	eval_compiled_tp *c = Calloc(1, eval_compiled_tp);
+
+	c->expression = expression;
+	c->ntheta = ntheta;
+	c->theta = Calloc(IMAX(1, ntheta), muFloat_t);
+	c->keep_vars = Calloc(1, eval_keep_vars_tp);
+	c->keep_vars->default_value = *x;
+	for (int i = 0; i < ntheta; i++) {
+		c->theta[i] = theta[i];
+	}
 
 	/*
-	 * I need this until the muparser-library is thread-safe....
+	 * I do not trust the muparser-library to parse thread-safe, so we do this part serially. Evaluation of the bytecode only touch the
+	 * handle itself.
 	 */
 #pragma omp critical (Name_0fa7f09460b3fe66b3508c1154b27762dbfac4e8)
 	{
-		int i;
-		muParserHandle_t hParser;
-
 		if (debug) {
-			printf("Eval: expression: %s\n", expression);
-			printf("Eval: value: %g\n", *x);
+			printf("Eval: compile expression: %s\n", expression);
 		}
 
-		hParser = mupCreate(muBASETYPE_FLOAT);
-		mupSetErrorHandler(hParser, inla_eval_OnError);
-
-		mupSetArgSep(hParser, ';');
-		mupSetDecSep(hParser, '.');
-		mupSetThousandsSep(hParser, 0);
-		mupDefineConst(hParser, "pi", M_PI);
-		mupDefineInfixOprt(hParser, "!", inla_eval_Not, 0);
-		mupDefineFun1(hParser, "return", inla_eval_Return, 1);
-		mupDefineFun1(hParser, "gamma", inla_eval_Gamma, 1);
-		mupDefineFun1(hParser, "lgamma", inla_eval_LogGamma, 1);
-		mupDefineFun1(hParser, "digamma", inla_eval_digamma, 1);
-		mupDefineFun1(hParser, "trigamma", inla_eval_trigamma, 1);
-		mupDefineFun1(hParser, "log", log, 1);
-		mupDefineFun1(hParser, "log10", log10, 1);
-		mupDefineFun1(hParser, "ln", log, 1);
-		mupDefineFun2(hParser, "pow", pow, 1);
-
-		// add constants like THETA0, THETA1, THETA2, ...
-		for (i = 0; i < ntheta; i++) {
+		c->hParser = mupCreate(muBASETYPE_FLOAT);
+		mupSetErrorHandler(c->hParser, inla_eval_OnError);
+
+		mupSetArgSep(c->hParser, ';');
+		mupSetDecSep(c->hParser, '.');
+		mupSetThousandsSep(c->hParser, 0);
+		mupDefineConst(c->hParser, "pi", M_PI);
+		mupDefineInfixOprt(c->hParser, "!", inla_eval_Not, 0);
+		mupDefineFun1(c->hParser, "return", inla_eval_Return, 1);
+		mupDefineFun1(c->hParser, "gamma", inla_eval_Gamma, 1);
+		mupDefineFun1(c->hParser, "lgamma", inla_eval_LogGamma, 1);
+		mupDefineFun1(c->hParser, "digamma", inla_eval_digamma, 1);
+		mupDefineFun1(c->hParser, "trigamma", inla_eval_trigamma, 1);
+		mupDefineFun1(c->hParser, "log", log, 1);
+		mupDefineFun1(c->hParser, "log10", log10, 1);
+		mupDefineFun1(c->hParser, "ln", log, 1);
+		mupDefineFun2(c->hParser, "pow", pow, 1);
+
+		// add THETA0, THETA1, THETA2, ..., bound to the theta-slots
+		for (int i = 0; i < ntheta; i++) {
 			char *var = NULL;
 			GMRFLib_sprintf(&var, "THETA%1d", i);
-			mupDefineConst(hParser, var, theta[i]);
+			mupDefineVar(c->hParser, var, &(c->theta[i]));
 			Free(var);
 		}
-		eval_keep_vars_tp *keep_vars = NULL;
 
-		keep_vars = Calloc(1, eval_keep_vars_tp);
-		keep_vars->default_value = *x;
-		mupSetVarFactory(hParser, inla_eval_AddVariable, (void *) &keep_vars);
-		mupSetExpr(hParser, (muChar_t *) expression);
-		value = (double) mupEval(hParser);
+		mupSetVarFactory(c->hParser, inla_eval_AddVariable, (void *) &(c->keep_vars));
+		mupSetExpr(c->hParser, (muChar_t *) expression);
+
+		// the first evaluation parse the expression into bytecode and create the variables
+		mupEval(c->hParser);
+	}
 
-		mupRelease(hParser);
+	return c;
+}
 
-		for (i = 0; i < keep_vars->n; i++) {
-			if (debug) {
-				printf("Free %s = %g\n", keep_vars->name[i], (double) keep_vars->value[i][0]);
-			}
-			Free(keep_vars->value[i]);
-			Free(keep_vars->name[i]);
+double inla_eval_expression(char *expression, double *x, double *theta, int ntheta)
+{
+	double value;
+	eval_compiled_tp *c = NULL;
+
+	/*
+	 * each thread has its own compiled copy of each expression, so the evaluation is lock-free
+	 */
+	for (int k = 0; k < eval_ncompiled && !c; k++) {
+		if (eval_compiled[k]->expression == expression && eval_compiled[k]->ntheta == ntheta) {
+			c = eval_compiled[k];
 		}
-		Free(keep_vars->value);
-		Free(keep_vars->name);
-		Free(keep_vars);
+	}
+	if (!c) {
+		c = inla_eval_compile(expression, x, theta, ntheta);
+		eval_compiled = Realloc(eval_compiled, eval_ncompiled + 1, eval_compiled_tp *);
+		eval_compiled[eval_ncompiled++] = c;
 	}
 
+	if (debug) {
+		printf("Eval: expression: %s\n", expression);
+		printf("Eval: value: %g\n", *x);
+	}
+
+	for (int i = 0; i < ntheta; i++) {
+		c->theta[i] = theta[i];
+	}
+	eval_keep_vars_tp *keep_vars = c->keep_vars;
+	for (int i = 0; i < keep_vars->n; i++) {
+		keep_vars->value[i][0] = *x;
+	}
+	value = (double) mupEval(c->hParser);
+
 	if (ISINF(value) || ISNAN(value)) {
 		char *msg;
 
@@ -237,36 +294,42 @@ double inla_eval_expression(char *expression, double *x, double *theta, int nthe
 
 	return value;
 }
-double inla_eval_table(char *expression, double *xval, double *UNUSED(theta), int UNUSED(ntheta))
+GMRFLib_spline_tp *inla_eval_table_create(char *filename)
 {
-	double value;
-	GMRFLib_spline_tp *s;
+	/*
+	 * read the table-prior from file and return its spline
+	 */
+	GMRFLib_spline_tp *s = NULL;
 	GMRFLib_matrix_tp *M = NULL;
 
-	while (*expression == ' ' || *expression == '\t') {
-		expression++;
+	while (*filename == ' ' || *filename == '\t') {
+		filename++;
 	}
 	if (debug) {
-		fprintf(stderr, "OPEN FILE[%s]\n", expression);
+		fprintf(stderr, "OPEN FILE[%s]\n", filename);
 	}
-	M = GMRFLib_read_fmesher_file((const char *) expression, 0, -1);
+	M = GMRFLib_read_fmesher_file((const char *) filename, 0, -1);
 	assert(M->nrow >= 4);
 	assert(M->ncol == 2);
 
 	s = GMRFLib_spline_create(M->A, M->A + M->nrow, M->nrow);
-	value = GMRFLib_spline_eval(*xval, s);
+	GMRFLib_matrix_free(M);
 
 	if (0) {
 		// a check of the interpolation
-#pragma omp critical (Name_e578aec88a26ae580f841592d1651b595dac46e4)
-		{
-			double xx;
-			for (xx = -20; xx < 20; xx += .1)
-				printf("TABLE %g %g\n", xx, GMRFLib_spline_eval(xx, s));
-			exit(1);
-		}
+		double xx;
+		for (xx = -20; xx < 20; xx += .1)
+			printf("TABLE %g %g\n", xx, GMRFLib_spline_eval(xx, s));
+		exit(1);
 	}
 
+	return s;
+}
+
+double inla_eval_table_spline(GMRFLib_spline_tp *s, double *xval)
+{
+	double value = GMRFLib_spline_eval(*xval, s);
+
 	if (ISNAN(value)) {
 		char *msg;
 		GMRFLib_sprintf(&msg, "table-prior returns NAN. Argument is %g but prior is defined on [%g,%g] only.", *xval, s->xmin, s->xmax);
@@ -274,7 +337,49 @@ double inla_eval_table(char *expression, double *xval, double *UNUSED(theta), in
 		exit(1);
 	}
 
-	GMRFLib_matrix_free(M);
+	return value;
+}
+
+GMRFLib_spline_tp *inla_eval_table_keep(char *filename)
+{
+	/*
+	 * as inla_eval_table_create(), but the spline is kept in a list, to be free'd by inla_eval_table_free()
+	 */
+	GMRFLib_spline_tp *s = inla_eval_table_create(filename);
+
+#pragma omp critical (Name_eb23b1ef6c7dd6bab6ed905adafa0e460ceec2e7)
+	{
+		eval_tables = Realloc(eval_tables, eval_ntables + 1, GMRFLib_spline_tp *);
+		eval_tables[eval_ntables++] = s;
+	}
+
+	return s;
+}
+
+int inla_eval_table_free(void)
+{
+	/*
+	 * free the splines of the table-priors. the `table' in the priors are not valid after this
+	 */
+#pragma omp critical (Name_eb23b1ef6c7dd6bab6ed905adafa0e460ceec2e7)
+	{
+		for (int i = 0; i < eval_ntables; i++) {
+			GMRFLib_spline_free(eval_tables[i]);
+		}
+		Free(eval_tables);
+		eval_ntables = 0;
+	}
+
+	return GMRFLib_SUCCESS;
+}
+
+double inla_eval_table(char *expression, double *xval, double *UNUSED(theta), int UNUSED(ntheta))
+{
+	/*
+	 * only used if the table is not cached in the prior, see PRIOR_EVAL
+	 */
+	GMRFLib_spline_tp *s = inla_eval_table_create(expression);
+	double value = inla_eval_table_spline(s, xval);
 	GMRFLib_spline_free(s);
 
 	return value;
@@ -45,6 +45,10 @@ __BEGIN_DECLS
 double inla_eval(char *expression, double *x, double *theta, int ntheta);
 double inla_eval_expression(char *expression, double *x, double *theta, int ntheta);
 double inla_eval_table(char *expression, double *x, double *theta, int ntheta);
+double inla_eval_table_spline(GMRFLib_spline_tp * s, double *x);
+GMRFLib_spline_tp *inla_eval_table_create(char *filename);
+GMRFLib_spline_tp *inla_eval_table_keep(char *filename);
+int inla_eval_table_free(void);
 
 __END_DECLS
 #endif
@@ -361,15 +361,13 @@ double Qfunc_slm(int thread_id, int i, int j, double *UNUSED(values), void *arg)
 	return value;
 }
 
-double Qfunc_rgeneric(int thread_id, int i, int j, double *values, void *arg)
+static void Qfunc_rgeneric_build(inla_rgeneric_tp *a, int id, int thread_id)
 {
-	inla_rgeneric_tp *a = (inla_rgeneric_tp *) arg;
-	int rebuild, ii, id = 0;
+	int rebuild, ii, *ilist = NULL, *jlist = NULL, n, len, k = 0, n_out, jj;
+	double *Qijlist = NULL, *x_out = NULL;
 	const int debug = 0;
 
-	GMRFLib_CACHE_SET_ID(id);
 	rebuild = (a->param[id] == NULL || a->Q[id] == NULL);
-
 	if (!rebuild) {
 		for (ii = 0; ii < a->ntheta && !rebuild; ii++) {
 			rebuild = (a->param[id][ii] != a->theta[ii][thread_id][0]);
@@ -377,77 +375,89 @@ double Qfunc_rgeneric(int thread_id, int i, int j, double *values, void *arg)
 	}
 
 	if (rebuild) {
-		int *ilist = NULL, *jlist = NULL, n, len, k = 0, n_out, jj;
-		double *Qijlist = NULL, *x_out = NULL;
-#pragma omp critical (Name_297cd7aba8c5dafefcb1c93779913d23a945ce9e)
-		{
-			rebuild = (a->param[id] == NULL || a->Q[id] == NULL);
-			if (!rebuild) {
-				for (ii = 0; ii < a->ntheta && !rebuild; ii++) {
-					rebuild = (a->param[id][ii] != a->theta[ii][thread_id][0]);
-				}
+		if (debug) {
+			printf("Qfunc_rgeneric: Rebuild Q-hash for id %d thread_id %d\n", id, thread_id);
+		}
+		if (a->Q[id]) {
+			GMRFLib_free_tabulate_Qfunc(a->Q[id]);
+		}
+		double *a_tmp = Calloc(a->ntheta, double);
+		for (jj = 0; jj < a->ntheta; jj++) {
+			a_tmp[jj] = a->theta[jj][thread_id][0];
+			if (debug) {
+				printf("\ttheta[%1d] %.12f\n", jj, a_tmp[jj]);
 			}
+		}
 
-			if (rebuild) {
-				if (debug) {
-					printf("Qfunc_rgeneric: Rebuild Q-hash for id %d thread_id %d\n", id, thread_id);
-				}
-				if (a->Q[id]) {
-					GMRFLib_free_tabulate_Qfunc(a->Q[id]);
-				}
-				double *a_tmp = Calloc(a->ntheta, double);
-				for (jj = 0; jj < a->ntheta; jj++) {
-					a_tmp[jj] = a->theta[jj][thread_id][0];
-					if (debug) {
-						printf("\ttheta[%1d] %.12f\n", jj, a_tmp[jj]);
-					}
-				}
+		if (debug) {
+			printf("\tCall rgeneric\n");
+		}
+		inla_R_rgeneric(&n_out, &x_out, R_GENERIC_Q, a->model, &(a->ntheta), a_tmp);
+		if (debug) {
+			printf("\tReturn from rgeneric with n_out= %1d\n", n_out);
+		}
+		assert(n_out >= 2);
+
+		assert(a->graph);
+		if ((int) x_out[0] == -1) {
+			// optimized output
+			k = 1;
+			len = (int) x_out[k++];
+			assert(len == a->len_list);
+			n = a->graph->n;
+			GMRFLib_tabulate_Qfunc_from_list2(&(a->Q[id]), a->graph, a->len_list, a->ilist, a->jlist, &(x_out[k]), n, NULL);
+		} else {
+			n = (int) x_out[k++];
+			len = (int) x_out[k++];
+
+			// we can overlay these arrays to avoid allocating new ones, since x_out is double
+			ilist = (int *) &(x_out[k]);
+			jlist = (int *) &(x_out[k + len]);
+			Qijlist = (double *) &(x_out[k + 2 * len]);
+			for (jj = 0; jj < len; jj++) {
+				ilist[jj] = (int) x_out[k + jj];
+				jlist[jj] = (int) x_out[k + len + jj];
+			}
 
-				if (debug) {
-					printf("\tCall rgeneric\n");
-				}
-				inla_R_rgeneric(&n_out, &x_out, R_GENERIC_Q, a->model, &(a->ntheta), a_tmp);
-				if (debug) {
-					printf("\tReturn from rgeneric with n_out= %1d\n", n_out);
-				}
-				assert(n_out >= 2);
-
-				assert(a->graph);
-				if ((int) x_out[0] == -1) {
-					// optimized output
-					k = 1;
-					len = (int) x_out[k++];
-					assert(len == a->len_list);
-					n = a->graph->n;
-					GMRFLib_tabulate_Qfunc_from_list2(&(a->Q[id]), a->graph, a->len_list, a->ilist, a->jlist, &(x_out[k]), n,
-									  NULL);
-				} else {
-					n = (int) x_out[k++];
-					len = (int) x_out[k++];
-
-					// we can overlay these arrays to avoid allocating new ones, since x_out is double
-					ilist = (int *) &(x_out[k]);
-					jlist = (int *) &(x_out[k + len]);
-					Qijlist = (double *) &(x_out[k + 2 * len]);
-					for (jj = 0; jj < len; jj++) {
-						ilist[jj] = (int) x_out[k + jj];
-						jlist[jj] = (int) x_out[k + len + jj];
-					}
+			GMRFLib_tabulate_Qfunc_from_list2(&(a->Q[id]), a->graph, len, ilist, jlist, Qijlist, n, NULL);
+			assert(a->graph->n == a->n);
+		}
+		Free(x_out);
 
-					GMRFLib_tabulate_Qfunc_from_list2(&(a->Q[id]), a->graph, len, ilist, jlist, Qijlist, n, NULL);
-					assert(a->graph->n == a->n);
-				}
-				Free(x_out);
+		if (a->param[id]) {
+			Memcpy(a->param[id], a_tmp, a->ntheta * sizeof(double));
+			Free(a_tmp);
+		} else {
+			a->param[id] = a_tmp;
+		}
+		if (debug) {
+			printf("\tRebuild for id %1d done\n", id);
+		}
+	}
+}
 
-				if (a->param[id]) {
-					Memcpy(a->param[id], a_tmp, a->ntheta * sizeof(double));
-					Free(a_tmp);
-				} else {
-					a->param[id] = a_tmp;
-				}
-				if (debug) {
-					printf("\tRebuild for id %1d done\n", id);
-				}
+double Qfunc_rgeneric(int thread_id, int i, int j, double *values, void *arg)
+{
+	inla_rgeneric_tp *a = (inla_rgeneric_tp *) arg;
+	int rebuild, ii, id = 0;
+
+	GMRFLib_CACHE_SET_ID(id);
+	rebuild = (a->param[id] == NULL || a->Q[id] == NULL);
+
+	if (!rebuild) {
+		for (ii = 0; ii < a->ntheta && !rebuild; ii++) {
+			rebuild = (a->param[id][ii] != a->theta[ii][thread_id][0]);
+		}
+	}
+
+	if (rebuild) {
+		if (inla_R_pool_active()) {
+			// the R-workers run concurrently, and a->Q[id] is only used by this thread
+			Qfunc_rgeneric_build(a, id, thread_id);
+		} else {
+#pragma omp critical (Name_297cd7aba8c5dafefcb1c93779913d23a945ce9e)
+			{
+				Qfunc_rgeneric_build(a, id, thread_id);
 			}
 		}
 	}
@@ -618,11 +628,52 @@ double mfunc_ar1(int thread_id, int UNUSED(i), void *arg)
 	return (a->mean[thread_id][0]);
 }
 
+static void mfunc_rgeneric_build(inla_rgeneric_tp *a, int id, int thread_id)
+{
+	int n, n_out, jj;
+	double *x_out = NULL;
+	const int debug = 0;
+
+	if (debug) {
+		printf("Rebuild mu-hash for id %d\n", id);
+	}
+	if (!(a->mu_param[id])) {
+		a->mu_param[id] = Calloc(a->ntheta, double);
+	}
+	for (jj = 0; jj < a->ntheta; jj++) {
+		a->mu_param[id][jj] = a->theta[jj][thread_id][0];
+		if (debug) {
+			printf("\ttheta[%1d] %.20g\n", jj, a->mu_param[id][jj]);
+		}
+	}
+
+	if (debug) {
+		printf("Call rgeneric\n");
+	}
+	inla_R_rgeneric(&n_out, &x_out, R_GENERIC_MU, a->model, &(a->ntheta), a->mu_param[id]);
+	if (debug) {
+		printf("Return from rgeneric with n_out= %1d\n", n_out);
+	}
+
+	assert(n_out > 0);
+	n = (int) x_out[0];
+	if (n > 0) {
+		assert(n == a->n);
+		if (!(a->mu[id])) {
+			a->mu[id] = Calloc(n, double);
+		}
+		Memcpy(a->mu[id], &(x_out[1]), n * sizeof(double));
+		a->mu_zero = 0;
+	} else {
+		a->mu_zero = 1;
+	}
+	Free(x_out);
+}
+
 double mfunc_rgeneric(int thread_id, int i, void *arg)
 {
 	inla_rgeneric_tp *a = (inla_rgeneric_tp *) arg;
 	int rebuild, ii, id = 0;
-	const int debug = 0;
 
 	// possible fast return ?
 	if (a->mu_zero) {
@@ -636,45 +687,14 @@ double mfunc_rgeneric(int thread_id, int i, void *arg)
 	}
 
 	if (rebuild) {
+		if (inla_R_pool_active()) {
+			// the R-workers run concurrently, and a->mu[id] is only used by this thread
+			mfunc_rgeneric_build(a, id, thread_id);
+		} else {
 #pragma omp critical (Name_a878b76a6db370a6183df8d897b3a03b15039501)
-		{
-			int n, n_out, jj;
-			double *x_out = NULL;
-
-			if (debug) {
-				printf("Rebuild mu-hash for id %d\n", id);
-			}
-			if (!(a->mu_param[id])) {
-				a->mu_param[id] = Calloc(a->ntheta, double);
-			}
-			for (jj = 0; jj < a->ntheta; jj++) {
-				a->mu_param[id][jj] = a->theta[jj][thread_id][0];
-				if (debug) {
-					printf("\ttheta[%1d] %.20g\n", jj, a->mu_param[id][jj]);
-				}
-			}
-
-			if (debug) {
-				printf("Call rgeneric\n");
-			}
-			inla_R_rgeneric(&n_out, &x_out, R_GENERIC_MU, a->model, &(a->ntheta), a->mu_param[id]);
-			if (debug) {
-				printf("Return from rgeneric with n_out= %1d\n", n_out);
-			}
-
-			assert(n_out > 0);
-			n = (int) x_out[0];
-			if (n > 0) {
-				assert(n == a->n);
-				if (!(a->mu[id])) {
-					a->mu[id] = Calloc(n, double);
-				}
-				Memcpy(a->mu[id], &(x_out[1]), n * sizeof(double));
-				a->mu_zero = 0;
-			} else {
-				a->mu_zero = 1;
+			{
+				mfunc_rgeneric_build(a, id, thread_id);
 			}
-			Free(x_out);
 		}
 		// do a fast return here, so we do not need to allocate the a->mu[id] above. 
 		if (a->mu_zero) {
@@ -686,7 +686,17 @@ int inla_INLA_preopt_stage1(inla_tp *mb, GMRFLib_preopt_res_tp *rpreopt)
 	mb->misc_output = Calloc(1, GMRFLib_ai_misc_output_tp);
 	x = Calloc(N, double);
 	if (mb->reuse_mode && mb->x_file) {
-		Memcpy(x, mb->x_file + preopt->mnpred, N * sizeof(double));
+		/*
+		 * the latent part is the last N elements. the linear predictor part in front of it, can be shorter than
+		 * preopt->mnpred if new observations are appended since x_file was computed
+		 */
+		if (mb->nx_file < N) {
+			char *msg = NULL;
+			GMRFLib_sprintf(&msg, "The stored mode for x (section [mode], entry X) has length %1d, but the latent part of this model has length %1d.\n"
+					"Use a mode from a previous fit of this model, or use control.mode=list(restart=TRUE).", mb->nx_file, N);
+			inla_error_general(msg);
+		}
+		Memcpy(x, mb->x_file + (mb->nx_file - N), N * sizeof(double));
 	}
 
 	int nparam_eff = mb->ai_par->compute_nparam_eff;
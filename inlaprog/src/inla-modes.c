@@ -278,13 +278,30 @@ int inla_qsample(const char *filename, const char *outfile, const char *nsamples
 		fprintf(stderr, "inla_qsample: start to sample %1d samples...\n", ns);
 	}
 
-	if ((GMRFLib_smtp == GMRFLib_SMTP_PARDISO)) {
+	if (!S) {
+		/*
+		 * sample in blocks, which is reproducible for a given RNG-state independent of the number of threads
+		 */
+		double *samples = Calloc((size_t) graph->n * ns, double);
+		double *ldens = Calloc(ns, double);
+
+		GMRFLib_sample_block(problem, ns, 0, samples, ldens);
 		for (i = 0; i < ns; i++) {
-			if (!S) {
-				GMRFLib_sample(problem);
+			double *xx = samples + (size_t) i * graph->n;
+			if (!selection) {
+				Memcpy(&(M->A[i * M->nrow]), xx, graph->n * sizeof(double));
 			} else {
-				Memcpy(problem->sample, &(S->A[i * S->nrow]), S->nrow * sizeof(double));
+				for (int ii = 0; ii < selection->nrow; ii++) {
+					M->A[i * M->nrow + ii] = xx[(int) selection->A[ii]];
+				}
 			}
+			M->A[(i + 1) * M->nrow - 1] = ldens[i];
+		}
+		Free(samples);
+		Free(ldens);
+	} else if ((GMRFLib_smtp == GMRFLib_SMTP_PARDISO)) {
+		for (i = 0; i < ns; i++) {
+			Memcpy(problem->sample, &(S->A[i * S->nrow]), S->nrow * sizeof(double));
 			GMRFLib_evaluate(problem);
 
 			if (!selection) {
@@ -309,11 +326,7 @@ int inla_qsample(const char *filename, const char *outfile, const char *nsamples
 			if (problems[thread] == NULL) {
 				problems[thread] = GMRFLib_duplicate_problem(problem, 0, 1, 1);
 			}
-			if (!S) {
-				GMRFLib_sample(problems[thread]);
-			} else {
-				Memcpy(problems[thread]->sample, &(S->A[i * S->nrow]), S->nrow * sizeof(double));
-			}
+			Memcpy(problems[thread]->sample, &(S->A[i * S->nrow]), S->nrow * sizeof(double));
 			GMRFLib_evaluate(problems[thread]);
 
 			if (!selection) {
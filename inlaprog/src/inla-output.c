@@ -775,7 +775,7 @@ int inla_output_misc(const char *dir, GMRFLib_ai_misc_output_tp *mo, int ntheta,
 		return INLA_OK;
 	}
 	GMRFLib_sprintf(&ndir, "%s/%s", dir, "misc");
-	if (inla_mkdir(ndir) != 0) {
+	if (inla_mkdir(ndir) != 0 && !(mo->configs_stream && errno == EEXIST)) {
 		GMRFLib_sprintf(&msg, "fail to create directory [%s]: %s", ndir, strerror(errno));
 		inla_error_general(msg);
 	}
@@ -1044,7 +1044,8 @@ int inla_output_misc(const char *dir, GMRFLib_ai_misc_output_tp *mo, int ntheta,
 
 		FILE *fp;
 		GMRFLib_sprintf(&nndir, "%s/%s", ndir, "config_preopt");
-		if (inla_mkdir(nndir) != 0) {
+		// this directory is already there if the configurations are streamed
+		if (inla_mkdir(nndir) != 0 && !(mo->configs_stream && errno == EEXIST)) {
 			GMRFLib_sprintf(&msg, "fail to create directory [%s]: %s", nndir, strerror(errno));
 			inla_error_general(msg);
 		}
@@ -1122,11 +1123,23 @@ int inla_output_misc(const char *dir, GMRFLib_ai_misc_output_tp *mo, int ntheta,
 					fwrite((void *) off, sizeof(double), (size_t) mo->configs_preopt[id]->mnpred, fp);
 					Free(off);
 
+					// the storage format of the configurations: 0 = in this file, 1 = compressed in 'configs.zdat', 2 = as 1
+					// but with Qinv in single precision. if compressed, the Q's are delta-coded against 'Qref' which follows.
+					int format = (mo->configs_stream ? 1 + mo->configs_stream->use_float : 0);
+					fwrite((void *) &format, sizeof(int), (size_t) 1, fp);
+					if (mo->configs_stream) {
+						fwrite((void *) mo->configs_stream->Qref, sizeof(double), (size_t) mo->configs_preopt[id]->nz, fp);
+					}
+
 					char *A, *pA;
 					GMRFLib_sprintf(&A, "%s/%s", nndir, "A.dat");
 					GMRFLib_write_fmesher_file(mo->configs_preopt[id]->A, A, (long int) 0, -1);
 					GMRFLib_sprintf(&pA, "%s/%s", nndir, "pA.dat");
-					GMRFLib_write_fmesher_file(mo->configs_preopt[id]->pA, pA, (long int) 0, -1);
+					if (mo->configs_preopt[id]->pA) {
+						GMRFLib_write_fmesher_file(mo->configs_preopt[id]->pA, pA, (long int) 0, -1);
+					} else {
+						GMRFLib_matrix_mmap_write(mo->configs_preopt[id]->pA_mmap, pA);
+					}
 				}
 
 				for (i = 0; i < mo->configs_preopt[id]->nconfig; i++) {
@@ -1134,16 +1147,24 @@ int inla_output_misc(const char *dir, GMRFLib_ai_misc_output_tp *mo, int ntheta,
 					fwrite((void *) &(mo->configs_preopt[id]->config[i]->log_posterior_orig), sizeof(double), (size_t) 1, fp);
 					fwrite((void *) mo->configs_preopt[id]->config[i]->theta, sizeof(double),
 					       (size_t) mo->configs_preopt[id]->ntheta, fp);
-					fwrite((void *) mo->configs_preopt[id]->config[i]->mean, sizeof(double), (size_t) mo->configs_preopt[id]->n,
-					       fp);
-					fwrite((void *) mo->configs_preopt[id]->config[i]->improved_mean, sizeof(double),
-					       (size_t) mo->configs_preopt[id]->n, fp);
-					fwrite((void *) mo->configs_preopt[id]->config[i]->Q, sizeof(double), (size_t) mo->configs_preopt[id]->nz,
-					       fp);
-					fwrite((void *) mo->configs_preopt[id]->config[i]->Qinv, sizeof(double),
-					       (size_t) mo->configs_preopt[id]->nz, fp);
-					fwrite((void *) mo->configs_preopt[id]->config[i]->Qprior, sizeof(double),
-					       (size_t) mo->configs_preopt[id]->prior_nz, fp);
+					if (mo->configs_preopt[id]->config[i]->chunk) {
+						double index[2] = {
+							(double) mo->configs_preopt[id]->config[i]->chunk->offset,
+							(double) mo->configs_preopt[id]->config[i]->chunk->zlen
+						};
+						fwrite((void *) index, sizeof(double), (size_t) 2L, fp);
+					} else {
+						fwrite((void *) mo->configs_preopt[id]->config[i]->mean, sizeof(double),
+						       (size_t) mo->configs_preopt[id]->n, fp);
+						fwrite((void *) mo->configs_preopt[id]->config[i]->improved_mean, sizeof(double),
+						       (size_t) mo->configs_preopt[id]->n, fp);
+						fwrite((void *) mo->configs_preopt[id]->config[i]->Q, sizeof(double),
+						       (size_t) mo->configs_preopt[id]->nz, fp);
+						fwrite((void *) mo->configs_preopt[id]->config[i]->Qinv, sizeof(double),
+						       (size_t) mo->configs_preopt[id]->nz, fp);
+						fwrite((void *) mo->configs_preopt[id]->config[i]->Qprior, sizeof(double),
+						       (size_t) mo->configs_preopt[id]->prior_nz, fp);
+					}
 
 					double output[2] = {
 						(mo->configs_preopt[id]->config[i]->cpodens_moments ? 1.0 : 0.0),
@@ -1199,6 +1220,21 @@ int inla_output_misc(const char *dir, GMRFLib_ai_misc_output_tp *mo, int ntheta,
 			}
 		}
 		fclose(fp);
+
+		if (mo->configs_stream) {
+			GMRFLib_sprintf(&nnndir, "%s/%s", nndir, "configs.zdat");
+			GMRFLib_cstream_close(mo->configs_stream);
+			if (rename(mo->configs_stream->filename, nnndir) != 0) {
+				GMRFLib_sprintf(&msg, "fail to move [%s] to [%s]: %s", mo->configs_stream->filename, nnndir, strerror(errno));
+				inla_error_general(msg);
+			}
+			if (verbose) {
+				printf("\t\tstored %1d configurations in [%s], compressed %.1fMb to %.1fMb\n", nconfig, nnndir,
+				       mo->configs_stream->bytes_raw / SQR(1024.0), mo->configs_stream->offset / SQR(1024.0));
+			}
+			GMRFLib_cstream_free(mo->configs_stream);
+			mo->configs_stream = NULL;
+		}
 	}
 
 	GMRFLib_sprintf(&nnndir, "%s/%s", ndir, "warnings.txt");
@@ -1556,6 +1592,69 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 		}
 	}
 
+	/*
+	 * compute the kld, quantiles and cdf for all nodes in one parallel pass, and write them out below
+	 */
+	int nq = output->nquantiles, ncdf = output->ncdf;
+	double *d_kld = NULL, *d_quantiles = NULL, *d_cdf = NULL;
+
+	if ((output->kld || nq || ncdf) && inla_computed(density, n)) {
+		if (output->kld) {
+			d_kld = Calloc(n, double);
+		}
+		if (nq) {
+			d_quantiles = Calloc((size_t) n * nq, double);
+		}
+		if (ncdf) {
+			d_cdf = Calloc((size_t) n * ncdf, double);
+		}
+#define CODE_BLOCK							\
+		for (int i = 0; i < n; i++) {				\
+			if (!density[i]) {				\
+				continue;				\
+			}						\
+			if (d_kld) {					\
+				/* this is ok for _FUNC as well, since the the KL is invariant for parameter transformations. */ \
+				GMRFLib_density_tp *gd = NULL;		\
+				GMRFLib_density_create_normal(&gd, 0.0, 1.0, density[i]->std_mean, density[i]->std_stdev, GMRFLib_FALSE); \
+				if (G.fast_mode) {			\
+					GMRFLib_mkld_sym(&d_kld[i], gd, density[i]); \
+				} else {				\
+					GMRFLib_kld_sym(&d_kld[i], gd, density[i]); \
+				}					\
+				GMRFLib_free_density(gd);		\
+			}						\
+			if (d_quantiles) {				\
+				double *xp = d_quantiles + (size_t) i * nq; \
+				double *pp = CODE_BLOCK_WORK_PTR(0);	\
+				int incr = _MAP_INCREASING(i);		\
+				for (int j = 0; j < nq; j++) {		\
+					pp[j] = (incr ? output->quantiles[j] : 1.0 - output->quantiles[j]); \
+				}					\
+				GMRFLib_density_Pinv_n(xp, pp, nq, density[i]); \
+				for (int j = 0; j < nq; j++) {		\
+					xp[j] = _MAP_X(GMRFLib_density_std2user(xp[j], density[i]), i); \
+				}					\
+			}						\
+			if (d_cdf) {					\
+				double *px = d_cdf + (size_t) i * ncdf;	\
+				double *xx = CODE_BLOCK_WORK_PTR(0);	\
+				for (int j = 0; j < ncdf; j++) {	\
+					xx[j] = GMRFLib_density_user2std(output->cdf[j], density[i]); \
+				}					\
+				GMRFLib_density_P_n(px, xx, ncdf, density[i]); \
+				if (_MAP_DECREASING(i)) {		\
+					for (int j = 0; j < ncdf; j++) { \
+						px[j] = 1.0 - px[j];	\
+					}				\
+				}					\
+			}						\
+		}
+
+		RUN_CODE_BLOCK(GMRFLib_MAX_THREADS_LOCAL(), 1, IMAX(nq, ncdf));
+#undef CODE_BLOCK
+	}
+
 	if (return_marginals || strncmp("hyperparameter", sdir, 13) == 0) {
 		if (inla_computed(density, n)) {
 			char *nndir = NULL;
@@ -1626,30 +1725,18 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 	}
 
 	if (output->kld) {
-		/*
-		 * this is ok for _FUNC as well, since the the KL is invariant for parameter transformations. 
-		 */
 		if (inla_computed(density, n)) {
 			char *nndir = NULL;
 			GMRFLib_sprintf(&nndir, "%s/%s", ndir, "symmetric-kld.dat");
 			Dinit(nndir);
 			for (int i = 0; i < n; i++) {
-				GMRFLib_density_tp *gd = NULL;
 				if (density[i]) {
-					double kld;
-					GMRFLib_density_create_normal(&gd, 0.0, 1.0, density[i]->std_mean, density[i]->std_stdev, GMRFLib_FALSE);
-
-					if (G.fast_mode) {
-						GMRFLib_mkld_sym(&kld, gd, density[i]);
-					} else {
-						GMRFLib_kld_sym(&kld, gd, density[i]);
-					}
 					if (locations) {
 						D1W(locations[i % ndiv]);
 					} else {
 						D1W(i);
 					}
-					D1W(kld);
+					D1W(d_kld[i]);
 				} else {
 					if (add_empty) {
 						if (locations) {
@@ -1660,7 +1747,6 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 						D1W(NAN);
 					}
 				}
-				GMRFLib_free_density(gd);
 			}
 			Dclose();
 			Free(nndir);
@@ -1669,12 +1755,10 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 
 	if (output->nquantiles) {
 		if (inla_computed(density, n)) {
-			double x_user;
 			char *nndir = NULL;
 			GMRFLib_sprintf(&nndir, "%s/%s", ndir, "quantiles.dat");
 			Dinit(nndir);
 			for (int i = 0; i < n; i++) {
-				double xp, p;
 				if (density[i]) {
 					if (locations) {
 						D1W(locations[i % ndiv]);
@@ -1683,14 +1767,7 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 					}
 					D1W(output->nquantiles);
 					for (int j = 0; j < output->nquantiles; j++) {
-						p = output->quantiles[j];
-						if (_MAP_INCREASING(i)) {
-							GMRFLib_density_Pinv(&xp, p, density[i]);
-						} else {
-							GMRFLib_density_Pinv(&xp, 1.0 - p, density[i]);
-						}
-						x_user = GMRFLib_density_std2user(xp, density[i]);
-						D2W(p, _MAP_X(x_user, i));
+						D2W(output->quantiles[j], d_quantiles[(size_t) i * nq + j]);
 					}
 				} else {
 					if (add_empty) {
@@ -1746,7 +1823,6 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 			GMRFLib_sprintf(&nndir, "%s/%s", ndir, "cdf.dat");
 			Dinit(nndir);
 			for (int i = 0; i < n; i++) {
-				double xp, x, p;
 				if (density[i]) {
 					if (locations) {
 						D1W(locations[i % ndiv]);
@@ -1755,13 +1831,7 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 					}
 					D1W(output->ncdf);
 					for (int j = 0; j < output->ncdf; j++) {
-						xp = output->cdf[j];
-						x = GMRFLib_density_user2std(xp, density[i]);
-						GMRFLib_density_P(&p, x, density[i]);
-						if (_MAP_DECREASING(i)) {
-							p = 1.0 - p;
-						}
-						D2W(_MAP_X(xp, i), p);
+						D2W(_MAP_X(output->cdf[j], i), d_cdf[(size_t) i * ncdf + j]);
 					}
 				} else {
 					if (add_empty) {
@@ -1783,6 +1853,9 @@ int inla_output_detail(const char *dir, GMRFLib_density_tp **density, double *lo
 	}
 
 	Free(d_mode);
+	Free(d_kld);
+	Free(d_quantiles);
+	Free(d_cdf);
 
 #undef _MAP_DENS
 #undef _MAP_X
@@ -1828,6 +1901,8 @@ int inla_parse_output(inla_tp *mb, dictionary *ini, int sec, Output_tp **out)
 		(*out)->graph = 0;
 		(*out)->config = 0;
 		(*out)->config_lite = 0;
+		(*out)->config_compress = 0;
+		(*out)->config_float = 0;
 		(*out)->likelihood_info = 0;
 		(*out)->internal_opt = 1;
 		(*out)->save_memory = 0;
@@ -1850,6 +1925,8 @@ int inla_parse_output(inla_tp *mb, dictionary *ini, int sec, Output_tp **out)
 		(*out)->graph = mb->output->graph;
 		(*out)->config = mb->output->config;
 		(*out)->config_lite = mb->output->config_lite;
+		(*out)->config_compress = mb->output->config_compress;
+		(*out)->config_float = mb->output->config_float;
 		(*out)->likelihood_info = mb->output->likelihood_info;
 		(*out)->internal_opt = mb->output->internal_opt;
 		(*out)->save_memory = mb->output->save_memory;
@@ -2080,6 +2157,8 @@ int inla_parse_output(inla_tp *mb, dictionary *ini, int sec, Output_tp **out)
 	(*out)->graph = iniparser_getboolean(ini, inla_string_join(secname, "GRAPH"), (*out)->graph);
 	(*out)->config = iniparser_getboolean(ini, inla_string_join(secname, "CONFIG"), (*out)->config);
 	(*out)->config_lite = iniparser_getboolean(ini, inla_string_join(secname, "CONFIG.LITE"), (*out)->config_lite);
+	(*out)->config_compress = iniparser_getboolean(ini, inla_string_join(secname, "CONFIG.COMPRESS"), (*out)->config_compress);
+	(*out)->config_float = iniparser_getboolean(ini, inla_string_join(secname, "CONFIG.FLOAT"), (*out)->config_float);
 	(*out)->likelihood_info = iniparser_getboolean(ini, inla_string_join(secname, "LIKELIHOOD.INFO"), (*out)->likelihood_info);
 	(*out)->internal_opt = GMRFLib_internal_opt = iniparser_getboolean(ini, inla_string_join(secname, "INTERNAL.OPT"), (*out)->internal_opt);
 	(*out)->save_memory = GMRFLib_save_memory = iniparser_getboolean(ini, inla_string_join(secname, "SAVE.MEMORY"), (*out)->save_memory);
@@ -2087,6 +2166,9 @@ int inla_parse_output(inla_tp *mb, dictionary *ini, int sec, Output_tp **out)
 	if ((*out)->likelihood_info) {
 		(*out)->config = 1;
 	}
+	if ((*out)->config_float) {
+		(*out)->config_compress = 1;
+	}
 
 	tmp = Strdup(iniparser_getstring(ini, inla_string_join(secname, "QUANTILES"), NULL));
 
@@ -2183,6 +2265,8 @@ int inla_parse_output(inla_tp *mb, dictionary *ini, int sec, Output_tp **out)
 			printf("\t\t\thyperparameters=[%1d]\n", (*out)->hyperparameters);
 			printf("\t\t\tconfig=[%1d]\n", (*out)->config);
 			printf("\t\t\tconfig.lite=[%1d]\n", (*out)->config_lite);
+			printf("\t\t\tconfig.compress=[%1d]\n", (*out)->config_compress);
+			printf("\t\t\tconfig.float=[%1d]\n", (*out)->config_float);
 			printf("\t\t\tlikelihood.info=[%1d]\n", (*out)->likelihood_info);
 			printf("\t\t\tinternal.opt=[%1d]\n", (*out)->internal_opt);
 			printf("\t\t\tsave.memory=[%1d]\n", (*out)->save_memory);
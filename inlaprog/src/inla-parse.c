@@ -287,6 +287,35 @@ int inla_parse_mode(inla_tp *mb, dictionary *ini, int sec)
 		printf("\t\tFixed mode= %1d\n", mb->fixed_mode);
 	}
 
+	tmp = Strdup(iniparser_getstring(ini, inla_string_join(secname, "COV"), NULL));
+	if (tmp) {
+		// format: NCOV cov[0] cov[1] .... cov[ NCOV-1 ], with NCOV = NTHETA^2
+		fp = fopen(tmp, "rb");
+		if (!fp) {
+			inla_error_open_file(tmp);
+		}
+		nread = fread(&(mb->ncov_file), sizeof(int), 1, fp);
+		assert(nread == 1);
+		mb->cov_file = Calloc(mb->ncov_file, double);
+		nread = fread(mb->cov_file, sizeof(double), mb->ncov_file, fp);
+		assert(nread == (size_t) mb->ncov_file);
+		fclose(fp);
+	}
+
+	mb->incremental = iniparser_getboolean(ini, inla_string_join(secname, "INCREMENTAL"), 0);
+	mb->incremental_tol = iniparser_getdouble(ini, inla_string_join(secname, "INCREMENTAL.TOL"), 0.1);
+	if (mb->incremental && mb->reuse_mode && !mb->fixed_mode) {
+		/*
+		 * an incremental refit is a local re-optimisation starting at the old mode
+		 */
+		mb->reuse_mode_but_restart = 1;
+	}
+	if (mb->verbose) {
+		printf("\t\tIncremental = %1d\n", mb->incremental);
+		printf("\t\tIncremental tol = %.4g\n", mb->incremental_tol);
+		printf("\t\tCov (from file) = %s\n", (mb->cov_file ? "Yes" : "No"));
+	}
+
 	return INLA_OK;
 }
 
@@ -343,6 +372,13 @@ int inla_parse_problem(inla_tp *mb, dictionary *ini, int sec, int make_dir)
 		mb->strategy = GMRFLib_OPENMP_STRATEGY_LARGE;
 	} else if (!strcasecmp(openmp_strategy, "HUGE")) {
 		mb->strategy = GMRFLib_OPENMP_STRATEGY_HUGE;
+	} else if (!strcasecmp(openmp_strategy, "AUTO")) {
+		/*
+		 * start with the default and measure the alternatives where it matters
+		 */
+		mb->strategy = GMRFLib_OPENMP_STRATEGY_DEFAULT;
+		GMRFLib_openmp->autotune = 1;
+		GMRFLib_openmp->autotune_verbose = mb->verbose;
 	} else if (!strcasecmp(openmp_strategy, "PARDISO.SERIAL")) {
 		mb->strategy = GMRFLib_OPENMP_STRATEGY_PARDISO;
 	} else if (!strcasecmp(openmp_strategy, "PARDISO.PARALLEL")) {
@@ -226,6 +226,7 @@ int inla_read_prior_generic(inla_tp *mb, dictionary *ini, int sec, Prior_tp *pri
 
 	prior->priorfunc = NULL;
 	prior->expression = NULL;
+	prior->table = NULL;
 
 	if (mb->verbose) {
 		/*
@@ -1370,6 +1371,7 @@ int inla_read_prior_generic(inla_tp *mb, dictionary *ini, int sec, Prior_tp *pri
 		prior->expression = Strdup(prior->name);       /* yes, use the same storage */
 		prior->name[strlen("TABLE")] = '\0';
 		prior->parameters = NULL;
+		prior->table = inla_eval_table_keep(prior->expression + strlen("TABLE:"));
 
 		if (mb->verbose) {
 			printf("\t\t%s->%s=[%s]\n", prior_tag, prior->name, prior->expression);
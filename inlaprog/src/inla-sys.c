@@ -86,6 +86,14 @@ void inla_signal(int sig)
 		fprintf(stdout, "\n\n*** set GMRFLib_write_state = 1\n\n");
 		break;
 	case SIGUSR2:
+		if (GMRFLib_memacct_enabled()) {
+			GMRFLib_memacct_dump = 1;
+		} else {
+			const char *msg = "\n*** Memory accounting is disabled; rebuild with -DGMRFLib_MEMORY_ACCOUNTING to enable it\n\n";
+			if (write(STDERR_FILENO, msg, strlen(msg)) < 0) {
+				;
+			}
+		}
 		break;
 	default:
 		_exit(sig);
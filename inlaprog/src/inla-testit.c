@@ -4168,6 +4168,75 @@ int testit(int argc, char **argv)
 	}
 		break;
 
+	case 141:
+	{
+		// compare map_id and smap_id on a Qinv-like pattern: n maps with m keys each, and lookups of all keys
+		int n = (nargs > 0 ? atoi(args[0]) : 10000);
+		int m = (nargs > 1 ? atoi(args[1]) : 16);
+		int ntimes = (nargs > 2 ? atoi(args[2]) : 10);
+		assert(n > 0 && m > 0 && ntimes > 0);
+
+		int *keys = Calloc(n * m, int);
+		for (int i = 0; i < n; i++) {
+			for (int k = 0; k < m; k++) {
+				keys[i * m + k] = i + (int) (GMRFLib_uniform() * 10 * m);
+			}
+		}
+
+		map_id *mk = Calloc(n, map_id);
+		smap_id *sm = Calloc(n, smap_id);
+		double tref[] = { 0, 0, 0, 0 }, sum[] = { 0, 0 };
+
+		tref[0] -= GMRFLib_timer();
+		for (int i = 0; i < n; i++) {
+			map_id_init_hint(mk + i, m);
+			for (int k = 0; k < m; k++) {
+				map_id_set(mk + i, keys[i * m + k], (double) k);
+			}
+		}
+		tref[0] += GMRFLib_timer();
+
+		tref[1] -= GMRFLib_timer();
+		for (int i = 0; i < n; i++) {
+			smap_id_init_hint(sm + i, m);
+			for (int k = 0; k < m; k++) {
+				smap_id_set(sm + i, keys[i * m + k], (double) k);
+			}
+		}
+		tref[1] += GMRFLib_timer();
+
+		for (int time = 0; time < ntimes; time++) {
+			tref[2] -= GMRFLib_timer();
+			for (int i = 0; i < n; i++) {
+				for (int k = 0; k < m; k++) {
+					sum[0] += *map_id_ptr(mk + i, keys[i * m + k]);
+				}
+			}
+			tref[2] += GMRFLib_timer();
+
+			tref[3] -= GMRFLib_timer();
+			for (int i = 0; i < n; i++) {
+				for (int k = 0; k < m; k++) {
+					sum[1] += *smap_id_ptr(sm + i, keys[i * m + k]);
+				}
+			}
+			tref[3] += GMRFLib_timer();
+		}
+		assert(ISEQUAL(sum[0], sum[1]));
+
+		printf("insert: map_id %.4fs smap_id %.4fs speedup %.2f\n", tref[0], tref[1], tref[0] / tref[1]);
+		printf("lookup: map_id %.4fs smap_id %.4fs speedup %.2f\n", tref[2], tref[3], tref[2] / tref[3]);
+
+		for (int i = 0; i < n; i++) {
+			map_id_free(mk + i);
+			smap_id_free(sm + i);
+		}
+		Free(mk);
+		Free(sm);
+		Free(keys);
+	}
+		break;
+
 	case 999:
 	{
 		GMRFLib_pardiso_check_install(0, 0);
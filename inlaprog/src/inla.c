@@ -4043,10 +4043,15 @@ double extra(int thread_id, double *theta, int ntheta, void *argument)
 				}
 			}
 
-#pragma omp critical (Name_58ab1229a36b0d20f9c714d7896ab4820282193b)
-			{
+			if (inla_R_pool_active()) {
 				inla_R_rgeneric(&n_out, &x_out, R_GENERIC_LOG_NORM_CONST, def->model, &nt, param);
 				inla_R_rgeneric(&nn_out, &xx_out, R_GENERIC_LOG_PRIOR, def->model, &nt, param);
+			} else {
+#pragma omp critical (Name_58ab1229a36b0d20f9c714d7896ab4820282193b)
+				{
+					inla_R_rgeneric(&n_out, &x_out, R_GENERIC_LOG_NORM_CONST, def->model, &nt, param);
+					inla_R_rgeneric(&nn_out, &xx_out, R_GENERIC_LOG_PRIOR, def->model, &nt, param);
+				}
 			}
 
 			switch (nn_out) {
@@ -4075,9 +4080,13 @@ double extra(int thread_id, double *theta, int ntheta, void *argument)
 				int *ilist = NULL, *jlist = NULL, n, len, k = 0, jj;
 				double *Qijlist = NULL;
 				GMRFLib_tabulate_Qfunc_tp *Qf = NULL;
-#pragma omp critical (Name_94438d8a0faa6fe9957180657829e121c750f1f2)
-				{
+				if (inla_R_pool_active()) {
 					inla_R_rgeneric(&nn_out, &xx_out, R_GENERIC_Q, def->model, &nt, param);
+				} else {
+#pragma omp critical (Name_94438d8a0faa6fe9957180657829e121c750f1f2)
+					{
+						inla_R_rgeneric(&nn_out, &xx_out, R_GENERIC_Q, def->model, &nt, param);
+					}
 				}
 				assert(nn_out >= 2);
 
@@ -5604,7 +5613,12 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 	double time_used_Qx[2] = { 0.0, 0.0 };
 	double time_used_pred[2] = { 0.0, 0.0 };
 
-	if (GMRFLib_internal_opt) {
+	GMRFLib_tune_tp *tune = GMRFLib_tune_profile();
+	if (GMRFLib_internal_opt && tune && tune->Qx_strategy >= 0 && tune->preopt_predictor_strategy >= 0) {
+		// use the strategies from the tuning profile
+		GMRFLib_Qx_strategy = tune->Qx_strategy;
+		GMRFLib_preopt_predictor_strategy = tune->preopt_predictor_strategy;
+	} else if (GMRFLib_internal_opt) {
 		// cannot run this in parallel as we're changing global variables
 		GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_TIMING, NULL, NULL);
 		int thread_id = 0;
@@ -5799,6 +5813,19 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 	if (mb->output->config) {
 		mb->misc_output->configs_preopt = Calloc(GMRFLib_MAX_THREADS(), GMRFLib_store_configs_preopt_tp *);
 		mb->misc_output->config_lite = mb->output->config_lite;
+		if (mb->output->config_compress) {
+			// the stream is written in the directory where it ends up, so it can be renamed in place when done
+			char *fnm = NULL;
+			GMRFLib_sprintf(&fnm, "%s/%s", mb->dir, "misc");
+			inla_mkdir(fnm);
+			Free(fnm);
+			GMRFLib_sprintf(&fnm, "%s/%s", mb->dir, "misc/config_preopt");
+			inla_mkdir(fnm);
+			Free(fnm);
+			GMRFLib_sprintf(&fnm, "%s/%s", mb->dir, "misc/config_preopt/configs.zdat.tmp");
+			mb->misc_output->configs_stream = GMRFLib_cstream_open(fnm, mb->output->config_float);
+			Free(fnm);
+		}
 	} else {
 		mb->misc_output->configs_preopt = NULL;
 		mb->misc_output->config_lite = 0;
@@ -5814,7 +5841,17 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 
 	x = Calloc_get(N);
 	if (mb->reuse_mode && mb->x_file) {
-		Memcpy(x, mb->x_file + preopt->mnpred, N * sizeof(double));
+		/*
+		 * the latent part is the last N elements. the linear predictor part in front of it, can be shorter than
+		 * preopt->mnpred if new observations are appended since x_file was computed
+		 */
+		if (mb->nx_file < N) {
+			char *msg = NULL;
+			GMRFLib_sprintf(&msg, "The stored mode for x (section [mode], entry X) has length %1d, but the latent part of this model has length %1d.\n"
+					"Use a mode from a previous fit of this model, or use control.mode=list(restart=TRUE).", mb->nx_file, N);
+			inla_error_general(msg);
+		}
+		Memcpy(x, mb->x_file + (mb->nx_file - N), N * sizeof(double));
 	}
 
 	mb->ai_par->compute_nparam_eff = 1;
@@ -5942,8 +5979,9 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 #pragma omp parallel for private(i) num_threads(GMRFLib_openmp->max_threads_outer)
 			for (i = 0; i < preopt->n; i++) {
 				double s = 0.0;
-				for (int k = 0; k < preopt->AtA_idxval[i][0]->n; k++) {
-					s += preopt->AtA_idxval[i][0]->val[k];
+				int r = preopt->AtA_offset[i];
+				for (int k = preopt->AtA_csr->ia[r]; k < preopt->AtA_csr->ia[r + 1]; k++) {
+					s += preopt->AtA_csr->a[k];
 				}
 				scale[i] = 1.0 / (s0 + DMAX(0.0, s));
 			}
@@ -6002,6 +6040,20 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 		Free(scale);
 	}
 
+	double *hessian_known = NULL;
+	if (mb->incremental && mb->cov_file && mb->ntheta > 0) {
+		if (mb->ncov_file == ISQR(mb->ntheta)) {
+			hessian_known = Calloc(ISQR(mb->ntheta), double);
+			Memcpy(hessian_known, mb->cov_file, ISQR(mb->ntheta) * sizeof(double));
+			GMRFLib_comp_posdef_inverse(hessian_known, mb->ntheta);
+			mb->ai_par->hessian_known = hessian_known;
+			mb->ai_par->hessian_known_tol = mb->incremental_tol;
+		} else if (mb->verbose) {
+			printf("\tIgnore the covariance matrix for theta given in control.mode: dimension is %1d, expected %1d\n",
+			       mb->ncov_file, ISQR(mb->ntheta));
+		}
+	}
+
 	GMRFLib_ai_INLA_experimental(&(mb->density),
 				     NULL, NULL,
 				     (mb->output->hyperparameters ? &(mb->density_hyper) : NULL),
@@ -6017,6 +6069,9 @@ int inla_INLA_preopt_experimental(inla_tp *mb)
 				     preopt->preopt_graph, preopt->preopt_Qfunc, preopt->preopt_Qfunc_arg, preopt->latent_constr,
 				     mb->ai_par, ai_store, mb->nlc, mb->lc_lc, &(mb->density_lin), mb->misc_output, preopt);
 
+	mb->ai_par->hessian_known = NULL;
+	Free(hessian_known);
+
 
 	/*
 	 * add the offsets to the linear predictor. Add the offsets to the 'configs' (if any), at a later stage. 
@@ -6577,11 +6632,14 @@ int main(int argc, char **argv)
 	printf("\t\t-t A:B\t: the number of threads (A=outer,B=inner), 0 means auto\n"); \
 	printf("\t\t-m MODE\t: Enable special mode:\n");		\
 	printf("\t\t\tHYPER :  Enable HYPERPARAMETER mode\n");		\
+	printf("\t\t\tTUNE  :  Calibrate this host and write the tuning profile [FILE]\n"); \
+	printf("\t\t\tBENCH :  Run the kernel benchmarks and write the results [FILE]\n"); \
+	printf("\t\t\tBENCHMODEL :  Fit the model, report the time of each phase and compare with $INLA_BENCH_BASELINE\n"); \
 	printf("\t\t-h\t: Print (this) help.\n")
 
 #define _BUGS_intern(fp) fprintf(fp, "Report bugs to <help@r-inla.org>\n")
 #define _BUGS _BUGS_intern(stdout)
-	int i, verbose = 0, silent = 0, opt, arg, ntt[2] = { 0, 0 }, err;
+	int i, verbose = 0, silent = 0, opt, arg, ntt[2] = { 0, 0 }, err, bench_regression = 0;
 #if !defined(WINDOWS)
 	int enable_core_file = 0;			       /* allow for core files */
 #endif
@@ -6620,10 +6678,15 @@ int main(int argc, char **argv)
 	GMRFLib_csr_init_store();
 	GMRFLib_trace_functions(NULL);
 	GMRFLib_debug_functions(NULL);
+	GMRFLib_profile_init();
 	GMRFLib_reorder = G.reorder;
 	GMRFLib_inla_mode = GMRFLib_MODE_COMPACT;
-	my_sort2_id_test_cutoff(0);
-	my_sort2_dd_test_cutoff(0);
+	GMRFLib_dot_init();
+	if (GMRFLib_tune_load(NULL) != GMRFLib_SUCCESS) {
+		// no profile from 'inla -m tune' for this host, so we have to measure
+		my_sort2_id_test_cutoff(0);
+		my_sort2_dd_test_cutoff(0);
+	}
 
 	/*
 	 * special option: if one of the arguments is `--ping', then just return INLA[<VERSION>] IS ALIVE 
@@ -6716,6 +6779,12 @@ int main(int argc, char **argv)
 				G.mode = INLA_MODE_OPENMP;
 			} else if (!strncasecmp(optarg, "DRYRUN", 6)) {
 				G.mode = INLA_MODE_DRYRUN;
+			} else if (!strncasecmp(optarg, "TUNE", 4)) {
+				G.mode = INLA_MODE_TUNE;
+			} else if (!strncasecmp(optarg, "BENCHMODEL", 10)) {
+				G.mode = INLA_MODE_BENCH_MODEL;
+			} else if (!strncasecmp(optarg, "BENCH", 5)) {
+				G.mode = INLA_MODE_BENCH;
 			} else if (!strncasecmp(optarg, "TESTIT", 6)) {
 				G.mode = INLA_MODE_TESTIT;
 			} else {
@@ -6963,6 +7032,30 @@ int main(int argc, char **argv)
 	}
 		break;
 
+	case INLA_MODE_TUNE:
+	{
+		GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_TIMING, NULL, NULL);
+		char *fnm = (optind < argc ? argv[optind] : NULL);
+		char *profile = (fnm ? Strdup(fnm) : GMRFLib_tune_filename());
+		if (!silent) {
+			printf("Tune host, write profile to [%s]\n", (profile ? profile : "(none)"));
+		}
+		Free(profile);
+		exit(GMRFLib_tune_run(fnm, !silent) == GMRFLib_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+		break;
+
+	case INLA_MODE_BENCH:
+	{
+		GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_TIMING, NULL, NULL);
+		char *fnm = (optind < argc ? argv[optind] : NULL);
+		if (!silent) {
+			printf("Run kernel benchmarks, write results to [%s]\n", (fnm ? fnm : "stdout"));
+		}
+		exit(GMRFLib_bench_run(fnm, !silent) == GMRFLib_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+		break;
+
 	case INLA_MODE_QINV:
 	{
 		inla_qinv(argv[optind], argv[optind + 1], argv[optind + 2]);
@@ -7036,6 +7129,7 @@ int main(int argc, char **argv)
 
 	case INLA_MODE_HYPER:
 	case INLA_MODE_DEFAULT:
+	case INLA_MODE_BENCH_MODEL:
 		break;
 
 	default:
@@ -7096,7 +7190,7 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (G.mode == INLA_MODE_DEFAULT || G.mode == INLA_MODE_HYPER) {
+	if (G.mode == INLA_MODE_DEFAULT || G.mode == INLA_MODE_HYPER || G.mode == INLA_MODE_BENCH_MODEL) {
 		for (arg = optind; arg < argc; arg++) {
 			if (verbose) {
 				printf("Process file[%s] threads[%1d] max.threads[%1d] blas_threads[%1d]",
@@ -7113,9 +7207,19 @@ int main(int argc, char **argv)
 			time_used[0] = GMRFLib_timer();
 			atime_used[0] = clock();
 
+			if (G.mode == INLA_MODE_BENCH_MODEL) {
+				GMRFLib_bench_model_reset();
+			}
 			GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_PARSE_MODEL, NULL, NULL);
 			mb = inla_build(argv[arg], verbose, 1);
 			GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_BUILD_MODEL, NULL, NULL);
+			if (getenv("INLA_R_WORKERS")) {
+				// rgeneric and rprior in a pool of R-workers, now the models are loaded
+				inla_R_pool_start(atoi(getenv("INLA_R_WORKERS")));
+				if (verbose && inla_R_pool_active()) {
+					printf("\tR-workers                : %1d\n", atoi(getenv("INLA_R_WORKERS")));
+				}
+			}
 			time_used[0] = GMRFLib_timer() - time_used[0];
 			atime_used[0] = clock() - atime_used[0];
 			if (!silent) {
@@ -7213,7 +7317,9 @@ int main(int argc, char **argv)
 			time_used[2] = GMRFLib_timer();
 			atime_used[2] = clock();
 			GMRFLib_openmp_implement_strategy(GMRFLib_OPENMP_PLACES_DEFAULT, NULL, NULL);
+			GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_OUTPUT);
 			inla_output(mb);
+			GMRFLib_bench_phase(GMRFLib_BENCH_PHASE_NONE);
 			time_used[2] = GMRFLib_timer() - time_used[2];
 			atime_used[2] = clock() - atime_used[2];
 
@@ -7299,6 +7405,12 @@ int main(int argc, char **argv)
 					printf("\nDot-product gain: %.3f seconds, %.6f seconds/fn-call\n\n", GMRFLib_dot_product_gain,
 					       GMRFLib_dot_product_gain / nfunc[0]);
 				}
+				if (GMRFLib_arena_enable) {
+					GMRFLib_arena_report(stdout);
+				}
+				if (GMRFLib_memacct_enabled() || getenv("INLA_MEMACCT")) {
+					GMRFLib_memacct_report(stdout);
+				}
 #if !defined(WINDOWS)
 				if (GMRFLib_inla_mode != GMRFLib_MODE_CLASSIC) {
 					PEFF_PREOPT_OUTPUT(stdout);
@@ -7308,6 +7420,10 @@ int main(int argc, char **argv)
 				printf("\n");
 			}
 
+			if (mb->dir && GMRFLib_profile_level) {
+				GMRFLib_profile_write(mb->dir);
+			}
+
 			if (mb->dir) {
 				// just a copy of what is above
 				char *nfile = NULL;
@@ -7363,6 +7479,13 @@ int main(int argc, char **argv)
 				fclose(fp);
 				Free(nfile);
 			}
+
+			if (G.mode == INLA_MODE_BENCH_MODEL) {
+				int nreg = 0;
+				GMRFLib_bench_model_report(argv[arg], mb->dir, !silent, &nreg);
+				bench_regression += nreg;
+			}
+			inla_eval_table_free();
 		}
 	}
 
@@ -7370,7 +7493,7 @@ int main(int argc, char **argv)
 		inla_output_ok(mb->dir);
 	}
 
-	return EXIT_SUCCESS;
+	return (bench_regression ? EXIT_FAILURE : EXIT_SUCCESS);
 #undef _USAGE_intern
 #undef _USAGE
 #undef _HELP
@@ -127,6 +127,9 @@ typedef enum {
 	INLA_MODE_PARDISO,
 	INLA_MODE_OPENMP,
 	INLA_MODE_DRYRUN,
+	INLA_MODE_TUNE,
+	INLA_MODE_BENCH,
+	INLA_MODE_BENCH_MODEL,
 	INLA_MODE_TESTIT = 999
 } inla_mode_tp;
 
@@ -439,6 +442,7 @@ typedef struct {
 	char *from_theta;				       /* R-code */
 	inla_priorfunc_tp *priorfunc;			       /* Either a priorfunction, or */
 	char *expression;				       /* an alternative expression/table */
+	GMRFLib_spline_tp *table;			       /* the table-prior, read and splined once */
 } Prior_tp;
 
 typedef struct {
@@ -837,12 +841,15 @@ typedef struct {
 } inla_loga_table_tp;
 
 /* 
-   This is the macro to evaluate the prior. One and only one of `priorfunc' and `expression' is non-NULL, so we use that one
+   This is the macro to evaluate the prior. One and only one of `priorfunc' and `expression' is non-NULL, so we use that one. A table-prior
+   also has `table' set, which we use instead of `expression'.
  */
 #define PRIOR_EVAL(p_, arg_) (evaluate_hyper_prior ?		       \
 			      ((p_).priorfunc ?			       \
 			       (p_).priorfunc(arg_, (p_).parameters) :	\
-			       inla_eval((p_).expression, arg_, theta, ntheta)) \
+			       ((p_).table ?				\
+				inla_eval_table_spline((p_).table, arg_) : \
+				inla_eval((p_).expression, arg_, theta, ntheta))) \
 			       : 0.0)
 
 typedef struct {
@@ -884,6 +891,8 @@ typedef struct {
 	int graph;					       /* output the graph */
 	int config;					       /* output the configurations */
 	int config_lite;				       /* output-lite the configurations */
+	int config_compress;				       /* stream the configurations compressed to file */
+	int config_float;				       /* ...and with Qinv in single precision */
 	int likelihood_info;				       /* output likelihood_info (requires config=TRUE) */
 	int internal_opt;				       /* do internal optimisation? default TRUE */
 	int save_memory;				       /* save memory? default FALSE */
@@ -1076,6 +1085,15 @@ struct inla_tp_struct {
 	double *x_file;
 	int nx_file;
 
+	/*
+	 * incremental refit: restart from the mode and reuse the covariance matrix of theta (from a previous fit) if theta has
+	 * not moved much
+	 */
+	int incremental;
+	double incremental_tol;
+	int ncov_file;
+	double *cov_file;
+
 	/*
 	 * libR options
 	 */